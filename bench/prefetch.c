@@ -0,0 +1,152 @@
+/******************************************************************************
+ *                            PREFETCH BENCHMARK                              *
+ *                                                                            *
+ *   Measures how busy the workers are kept on a backlog of short tasks, with *
+ * several prefetch depths. An operator is started for each depth, the whole  *
+ * backlog is submitted through its ring, as the server does, and the time    *
+ * until every task is in the history file is compared with the time the      *
+ * tasks themselves take.                                                     *
+ *                                                                            *
+ *   Usage: bench_prefetch [num_tasks] [task_ms] [num_workers]                *
+ ******************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "common/io/io.h"
+#include "common/io/fifo.h"
+#include "common/datagram/execute.h"
+#include "server/operator.h"
+
+/**
+ * @brief The prefetch depths measured.
+ */
+static const int BENCH_PREFETCH_DEPTHS[] = { 0, 1, 2, 4 };
+
+static double elapsed_seconds(struct timespec* start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Returns the number of lines in a file, or 0 if it can not be read.
+ */
+static int count_lines(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return 0;
+
+    char buf[4096];
+    int lines = 0;
+    ssize_t rd;
+    while ((rd = read(fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < rd; i++) lines += (buf[i] == '\n');
+    }
+
+    close(fd);
+    return lines;
+}
+
+/**
+ * @brief Forwards a datagram to the operator, as the server does, waiting for room in the ring.
+ */
+static void forward_to_operator(Ring ring, void* datagram, size_t size, int* id) {
+    struct iovec forward[] = {
+        { .iov_base = datagram, .iov_len = size },
+        { .iov_base = id, .iov_len = sizeof(int) }
+    };
+    while (ring_write(ring, RING_MESSAGE_SERVER, forward, (id != NULL) ? 2 : 1) != 0) usleep(1000);
+}
+
+static int bench_prefetch(int prefetch, int num_tasks, int task_ms, int num_workers) {
+    char dir[] = "/tmp/orchestrator-bench-XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("Unable to create output folder");
+        return 1;
+    }
+    char* history_path = join_paths(2, dir, "history");
+
+    // The operator and its workers log every task. Keep that out of the results.
+    fflush(stdout);
+    int stdout_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    close(null_fd);
+
+    OPERATOR operator = start_operator(num_workers, dir, history_path, NULL, "fifo", 0, 0, prefetch, num_workers, 0, num_workers, 0, 0, NULL);
+
+    fflush(stdout);
+    dup2(stdout_fd, STDOUT_FILENO);
+    close(stdout_fd);
+    if (operator.pid == 0) {
+        printf("Unable to start operator.\n");
+        return 1;
+    }
+
+    char* command = isnprintf("sleep %d.%03d", task_ms / 1000, task_ms % 1000);
+    ExecuteRequestDatagram request = create_execute_request_datagram(command, strlen(command));
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int id = 1; id <= num_tasks; id++) {
+        forward_to_operator(operator.ring, request, EXECUTE_REQUEST_DATAGRAM_SIZE(request), &id);
+    }
+    while (count_lines(history_path) < num_tasks) usleep(2000);
+
+    double elapsed = elapsed_seconds(&start);
+    double ideal = (double)num_tasks * task_ms / 1000 / num_workers;
+    printf(
+        "prefetch %d | %5d tasks of %4dms on %2d workers | %7.3fs (ideal %7.3fs) | utilization %5.1f%%\n",
+        prefetch,
+        num_tasks,
+        task_ms,
+        num_workers,
+        elapsed,
+        ideal,
+        100 * ideal / elapsed
+    );
+
+    DATAGRAM_HEADER shutdown_request = create_datagram_header();
+    shutdown_request.mode = DATAGRAM_MODE_CLOSE_REQUEST;
+    forward_to_operator(operator.ring, &shutdown_request, sizeof(DATAGRAM_HEADER), NULL);
+    waitpid(operator.pid, NULL, 0);
+
+    // Clean up the task outputs.
+    for (int id = 1; id <= num_tasks; id++) {
+        char* task_name = isnprintf(TASK "%d", id);
+        char* task_path = join_paths(2, dir, task_name);
+        unlink(task_path);
+        free(task_path);
+        free(task_name);
+    }
+    unlink(history_path);
+    rmdir(dir);
+
+    destroy_ring(operator.ring);
+    destroy_snapshot(operator.snapshot);
+    free(request);
+    free(command);
+    free(history_path);
+
+    return 0;
+}
+
+int main(int argc, char const *argv[]) {
+    int num_tasks = (argc > 1) ? atoi(argv[1]) : 400;
+    int task_ms = (argc > 2) ? atoi(argv[2]) : 20;
+    int num_workers = (argc > 3) ? atoi(argv[3]) : 4;
+
+    for (size_t i = 0; i < sizeof(BENCH_PREFETCH_DEPTHS) / sizeof(BENCH_PREFETCH_DEPTHS[0]); i++) {
+        if (bench_prefetch(BENCH_PREFETCH_DEPTHS[i], num_tasks, task_ms, num_workers) != 0) return 1;
+    }
+
+    return 0;
+}
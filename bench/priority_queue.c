@@ -0,0 +1,117 @@
+/******************************************************************************
+ *                         PRIORITY QUEUE BENCHMARK                           *
+ *                                                                            *
+ *   Measures the enqueue and dispatch throughput of the operator backlog at  *
+ * several sizes, ordered like the sjb escalation policy, against the sorted  *
+ * list it replaced. The sorted list is only measured on the smaller sizes,   *
+ * as it takes quadratic time to fill.                                        *
+ *                                                                            *
+ *   Usage: bench_priority_queue [max_tasks]                                  *
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "common/debug.h"
+#include "server/priority_queue.h"
+
+/**
+ * @brief The largest backlog the sorted list is measured with.
+ */
+#define BENCH_SORTED_LIST_MAX_TASKS 10000
+
+typedef struct bench_task {
+    int id_task;
+    short int speculate_time;
+} BENCH_TASK, *BenchTask;
+
+static gint compare_bench_tasks(gconstpointer a, gconstpointer b, gpointer user_data) {
+    UNUSED(user_data);
+
+    BenchTask task_a = (BenchTask)a;
+    BenchTask task_b = (BenchTask)b;
+
+    if(task_a->speculate_time < task_b->speculate_time) return -1;
+    if(task_a->speculate_time > task_b->speculate_time) return  1;
+
+    return 0;
+}
+
+static double elapsed_seconds(struct timespec* start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void print_result(const char* name, int num_tasks, double enqueue, double dispatch) {
+    printf(
+        "%-12s %9d tasks | enqueue %8.3fs %12.0f tasks/s | dispatch %8.3fs %12.0f tasks/s\n", 
+        name, 
+        num_tasks, 
+        enqueue, 
+        num_tasks / enqueue, 
+        dispatch, 
+        num_tasks / dispatch
+    );
+}
+
+static void bench_priority_queue(BenchTask tasks, int num_tasks) {
+    struct timespec start;
+    PriorityQueue queue = create_priority_queue(compare_bench_tasks, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < num_tasks; i++) priority_queue_push(queue, &tasks[i]);
+    double enqueue = elapsed_seconds(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (priority_queue_pop(queue) != NULL);
+    double dispatch = elapsed_seconds(&start);
+
+    print_result("heap", num_tasks, enqueue, dispatch);
+    destroy_priority_queue(queue);
+}
+
+static void bench_sorted_list(BenchTask tasks, int num_tasks) {
+    struct timespec start;
+    GQueue* queue = g_queue_new();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < num_tasks; i++) g_queue_insert_sorted(queue, &tasks[i], compare_bench_tasks, NULL);
+    double enqueue = elapsed_seconds(&start);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (g_queue_pop_head(queue) != NULL);
+    double dispatch = elapsed_seconds(&start);
+
+    print_result("sorted list", num_tasks, enqueue, dispatch);
+    g_queue_free(queue);
+}
+
+int main(int argc, char const *argv[]) {
+    int max_tasks = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+    for (int num_tasks = 10000; num_tasks <= max_tasks; num_tasks *= 10) {
+        BenchTask tasks = malloc(num_tasks * sizeof(BENCH_TASK));
+        if (tasks == NULL) {
+            perror("Unable to allocate tasks");
+            return 1;
+        }
+
+        // Task times as clients send them, in milliseconds.
+        srand(num_tasks);
+        for (int i = 0; i < num_tasks; i++) {
+            tasks[i].id_task = i + 1;
+            tasks[i].speculate_time = rand() % 5000;
+        }
+
+        bench_priority_queue(tasks, num_tasks);
+        if (num_tasks <= BENCH_SORTED_LIST_MAX_TASKS) bench_sorted_list(tasks, num_tasks);
+
+        free(tasks);
+    }
+
+    return 0;
+}
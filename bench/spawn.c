@@ -0,0 +1,156 @@
+/******************************************************************************
+ *                              SPAWN BENCHMARK                               *
+ *                                                                            *
+ *   Measures how long a worker takes to run a task that does nothing, for a  *
+ * single command and for a pipeline, against the way tasks used to be run:   *
+ * a copy of the worker for each stage, which parsed the command and forked   *
+ * again before executing it. The worker is grown by a ballast first, since   *
+ * the cost of copying it grows with its memory.                              *
+ *                                                                            *
+ *   Usage: bench_spawn [num_tasks] [ballast_mb]                              *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "common/util/parser.h"
+#include "common/util/mysystem.h"
+#include "server/worker.h"
+
+/**
+ * @brief The tasks measured.
+ */
+static const char* BENCH_SPAWN_TASKS[] = { "true", "true | true | true" };
+
+static double elapsed_seconds(struct timespec* start) {
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Runs a single command the way stages used to be run, in a copy of the process that parses it and forks again
+ * to execute it.
+ */
+static void run_command_forked(char** args) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execvp(args[0], args);
+        _exit(127);
+    }
+
+    waitpid(pid, NULL, 0);
+}
+
+/**
+ * @brief Runs a task the way tasks used to be run, with a copy of the process for each stage.
+ */
+static void run_task_double_fork(char* input, char* output_file) {
+    Tokens cmds = tokenize_char_delim(input, strlen(input), "|");
+    pid_t pids[cmds->len];
+
+    int task_fd = open(output_file, O_WRONLY | O_CREAT, 0644);
+    int stage_in = -1;
+    for (int i = 0; i < cmds->len; i++) {
+        int pfd[2] = { -1, -1 };
+        if (i != cmds->len - 1) pipe(pfd);
+
+        pids[i] = fork();
+        if (pids[i] == 0) {
+            setpgid(0, (i == 0) ? 0 : pids[0]);
+            dup2((pfd[1] != -1) ? pfd[1] : task_fd, STDOUT_FILENO);
+            dup2(task_fd, STDERR_FILENO);
+            if (stage_in != -1) dup2(stage_in, STDIN_FILENO);
+            if (pfd[0] != -1) close(pfd[0]);
+
+            char** args = parse_command_args(cmds->data[i]);
+            run_command_forked(args);
+            _exit(0);
+        }
+
+        if (stage_in != -1) close(stage_in);
+        if (pfd[1] != -1) close(pfd[1]);
+        stage_in = pfd[0];
+    }
+
+    for (int i = 0; i < cmds->len; i++) waitpid(pids[i], NULL, 0);
+
+    close(task_fd);
+    destroy_tokens(cmds);
+}
+
+/**
+ * @brief Runs a task as many times as asked, one after the other, and returns the average time each took, in
+ * microseconds.
+ */
+static double bench_task(const char* task, int num_tasks, int spawned, const char* output_file) {
+    char* input = strdup(task);
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (int i = 0; i < num_tasks; i++) {
+        if (spawned) {
+            uint32_t cpu_time = 0;
+            uint8_t timed_out = 0;
+            run_task(input, (char*)output_file, 0, &cpu_time, &timed_out, NULL);
+        } else {
+            run_task_double_fork(input, (char*)output_file);
+        }
+    }
+
+    double elapsed = elapsed_seconds(&start);
+    free(input);
+
+    return elapsed * 1e6 / num_tasks;
+}
+
+int main(int argc, char const *argv[]) {
+    int num_tasks = (argc > 1) ? atoi(argv[1]) : 500;
+    int ballast_mb = (argc > 2) ? atoi(argv[2]) : 256;
+
+    // Every page of the ballast is touched, so that it is actually mapped, as the memory of a busy worker would be.
+    size_t ballast_size = (size_t)ballast_mb * 1024 * 1024;
+    char* ballast = malloc(ballast_size);
+    if (ballast == NULL && ballast_size != 0) {
+        printf("Unable to allocate ballast.\n");
+        return 1;
+    }
+    memset(ballast, 1, ballast_size);
+
+    char output_file[] = "/tmp/orchestrator-bench-spawn-XXXXXX";
+    int output_fd = mkstemp(output_file);
+    if (output_fd == -1) {
+        perror("Unable to create output file");
+        return 1;
+    }
+    close(output_fd);
+
+    for (size_t i = 0; i < sizeof(BENCH_SPAWN_TASKS) / sizeof(BENCH_SPAWN_TASKS[0]); i++) {
+        const char* task = BENCH_SPAWN_TASKS[i];
+        double forked = bench_task(task, num_tasks, 0, output_file);
+        double spawned = bench_task(task, num_tasks, 1, output_file);
+
+        printf(
+            "%-20s | %5d tasks, %4dMB worker | double fork %8.1fus | spawn %8.1fus | %5.2fx\n",
+            task,
+            num_tasks,
+            ballast_mb,
+            forked,
+            spawned,
+            forked / spawned
+        );
+    }
+
+    unlink(output_file);
+    free(ballast);
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+/******************************************************************************
+ *                            CLIENT CONNECTION                               *
+ *                                                                            *
+ *   The Client Connection module hides the transport used to reach the      *
+ * server from the client modes.                                              *
+ *   The transport is chosen through the ORCHESTRATOR_TRANSPORT environment   *
+ * variable. If it is unset, the socket is attempted first, falling back to   *
+ * the server FIFO if no server is listening on it.                           *
+ ******************************************************************************/
+
+#ifndef CLIENT_CONNECTION_H
+#define CLIENT_CONNECTION_H
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+typedef struct client_connection {
+    int request_fd;         // The file descriptor requests are written to.
+    int response_fd;        // The file descriptor responses are read from.
+    uint8_t is_socket;      // Whether the connection is a socket, where both file descriptors are the same.
+    char* client_fifo_path; // The path of the client FIFO, or NULL if the connection is a socket.
+} CLIENT_CONNECTION, *ClientConnection;
+
+/**
+ * @brief Opens a connection to the server, or returns NULL if it fails.
+ */
+ClientConnection open_client_connection();
+
+/**
+ * @brief Sends a single request datagram to the server.
+ * 
+ * @return 0 on success, 1 if it fails.
+ */
+int send_request(ClientConnection connection, void* request, size_t size);
+
+/**
+ * @brief Sends a single request datagram to the server, gathered from multiple buffers, with a single vectored write.
+ * 
+ * @param connection The connection to send the request through.
+ * @param iov        The buffers that make up the datagram, in order.
+ * @param iovcnt     The number of buffers.
+ * 
+ * @return 0 on success, 1 if it fails.
+ */
+int send_request_vector(ClientConnection connection, const struct iovec* iov, int iovcnt);
+
+/**
+ * @brief Returns the maximum length of the command of an Execute Request Datagram sent through a connection.
+ */
+size_t get_max_execute_payload_len(ClientConnection connection);
+
+/**
+ * @brief Receives a whole datagram from a socket connection, or returns NULL if it fails.
+ */
+void* receive_message(ClientConnection connection);
+
+/**
+ * @brief Receives a response from the server, using the given read function if the connection is FIFO based.
+ */
+#define RECEIVE_RESPONSE(connection, read_fifo) (\
+    (connection)->is_socket ? receive_message(connection) : (void*)read_fifo((connection)->response_fd)\
+)
+
+/**
+ * @brief Closes the connection, removing the client FIFO if there is one.
+ */
+void close_client_connection(ClientConnection connection);
+
+#endif
@@ -0,0 +1,102 @@
+/******************************************************************************
+ *                              CLIENT SESSION                                *
+ *                                                                            *
+ *   The Client Session is a long-lived client mode, that keeps a single      *
+ * connection to the server open and reads commands from a file descriptor,   *
+ * usually the standard input, one per line.                                 *
+ *   Requests are pipelined: each request is tagged with a request id and    *
+ * sent without waiting for the response of the previous ones, up to a       *
+ * window of outstanding requests. Responses are matched to their requests   *
+ * by the request id echoed back by the server, as they arrive.              *
+ *   A task the server is too busy for keeps its place in the window, and no  *
+ * command is sent until a pause, growing with every refusal in a row,        *
+ * expires and the task was resent.                                           *
+ *                                                                            *
+ *   The accepted commands are:                                               *
+ *     execute <time> <-u|-p> <task>                                          *
+ *     status [queued|running|completed [N]|wait|workers]                     *
+ *     close                                                                  *
+ *   Blank lines and lines starting with '#' are ignored.                     *
+ ******************************************************************************/
+
+#ifndef CLIENT_SESSION_H
+#define CLIENT_SESSION_H
+
+#include <stdint.h>
+#include "client/connection.h"
+#include "common/io/buffer.h"
+
+/**
+ * @brief The maximum number of requests awaiting a response at any given time.
+ */
+#define SESSION_WINDOW 256
+
+/**
+ * @brief The time to wait for the outstanding responses once the input ends, in milliseconds.
+ */
+#define SESSION_DRAIN_TIMEOUT 5000
+
+/**
+ * @brief The size of the buffer commands are read into. Longer lines are rejected.
+ */
+#define SESSION_INPUT_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @brief The size of the buffer responses are read into, for FIFO based connections.
+ */
+#define SESSION_RESPONSE_BUFFER_SIZE (256 * 1024)
+
+/**
+ * @brief The shortest pause in sending after the server was too busy for a task, in milliseconds. Doubled for every
+ * busy response in a row, unless the server asked for longer.
+ */
+#define SESSION_BUSY_PAUSE 50
+
+/**
+ * @brief The longest pause in sending after the server was too busy for a task, in milliseconds.
+ */
+#define SESSION_MAX_BUSY_PAUSE 5000
+
+/**
+ * @brief The most times a task the server was too busy for is resent before giving up on it.
+ */
+#define SESSION_MAX_RETRIES 10
+
+typedef struct session_slot {
+    uint32_t request_id; // The request occupying this slot.
+    uint8_t mode;        // The mode of the request, or DATAGRAM_MODE_NONE if the slot is free.
+    int line_num;        // The input line the request was read from.
+    uint8_t streaming;   // Whether part of a chunked response was already displayed.
+    uint8_t* request;    // A copy of the request, kept to resend it, or NULL for requests that are never resent.
+    size_t request_len;  // The size of the request.
+    int attempts;        // The number of times the server was too busy for the request.
+    uint8_t retry;       // Whether the request waits to be resent once the session is no longer paused.
+} SESSION_SLOT, *SessionSlot;
+
+typedef struct session {
+    ClientConnection connection;       // The connection every request is sent through.
+    SESSION_SLOT slots[SESSION_WINDOW]; // The outstanding requests, indexed by their request id.
+    uint32_t next_request_id;          // The request id of the next request.
+    int outstanding;                   // The number of requests awaiting a response.
+    ReadBuffer input;                  // The buffered commands not yet sent.
+    ReadBuffer responses;              // The buffered responses not yet handled, or NULL for socket connections.
+    uint8_t input_ended;               // Whether the end of the input was reached.
+    uint8_t server_gone;               // Whether the server closed the connection.
+    int line_num;                      // The number of input lines read so far.
+    int errors;                        // The number of commands that failed.
+    uint64_t paused_until;             // The time until which no command is sent, after the server was busy.
+    int busy_streak;                   // The number of busy responses in a row.
+} SESSION, *Session;
+
+/**
+ * @brief Runs a session over an already open connection, until the input ends and every response is received, or the
+ * server goes away.
+ *
+ * @param connection The connection to the server.
+ * @param input_fd   The file descriptor to read commands from.
+ *
+ * @return 0 if every command succeeded and was answered, 1 otherwise.
+ */
+int run_session(ClientConnection connection, int input_fd);
+
+#endif
@@ -12,7 +12,7 @@
 #include <stdint.h>
 #include <sys/types.h>
 
-#define DATAGRAM_VERSION 2
+#define DATAGRAM_VERSION 7
 
 typedef enum datagram_mode {
     DATAGRAM_MODE_NONE,
@@ -21,7 +21,9 @@ typedef enum datagram_mode {
     DATAGRAM_MODE_STATUS_RESPONSE,
     DATAGRAM_MODE_EXECUTE_RESPONSE,
     DATAGRAM_MODE_CLOSE_REQUEST,
-    DATAGRAM_MODE_CLOSE_RESPONSE
+    DATAGRAM_MODE_CLOSE_RESPONSE,
+    DATAGRAM_MODE_EXECUTE_BATCH_REQUEST,
+    DATAGRAM_MODE_EXECUTE_BATCH_RESPONSE
 } DatagramMode;
 
 typedef enum datagram_type {
@@ -35,6 +37,7 @@ typedef struct datagram_header {
     uint8_t mode;
     uint8_t type;
     pid_t pid;
+    uint32_t request_id; // Chosen by the client, and echoed back on the response, to match them when pipelining.
 } DATAGRAM_HEADER, *DatagramHeader;
 
 /**
@@ -60,6 +63,24 @@ DATAGRAM_HEADER create_datagram_header();
  */
 DATAGRAM_HEADER read_datagram_header(int fd);
 
+/**
+ * @brief Returns the total size of the request datagram at the head of a buffer, 0 if not enough bytes are buffered to
+ * determine it yet, or -1 if the datagram is not supported.
+ * 
+ * @param buf A buffer whose first bytes are a DATAGRAM_HEADER.
+ * @param len The number of bytes available in the buffer.
+ */
+ssize_t get_request_datagram_size(const void* buf, size_t len);
+
+/**
+ * @brief Returns the total size of the response datagram at the head of a buffer, 0 if not enough bytes are buffered to
+ * determine it yet, or -1 if the datagram is not supported.
+ * 
+ * @param buf A buffer whose first bytes are a DATAGRAM_HEADER.
+ * @param len The number of bytes available in the buffer.
+ */
+ssize_t get_response_datagram_size(const void* buf, size_t len);
+
 /**
  * @brief Returns a string representation for a Datagram Header.
  * 
@@ -5,6 +5,12 @@
  * Response Datagrams for the Execute Mode of the application architecture.   *
  *   The Execute Mode is the mode used to queue a new task on a server        *
  * instance, and get the id of the queued task.                               *
+ *   The Execute Batch variants queue several tasks with a single datagram,   *
+ * and get back the contiguous range of ids assigned to them. A task of a     *
+ * batch may depend on earlier tasks, either by id or by its position in the  *
+ * batch, so that a whole dependency graph is queued at once.                 *
+ *   A server over its admission limits answers with a busy status, and how   *
+ * long to wait before retrying, instead of queueing the tasks.               *
  *                                                                            *
  *   The create_execute_<kind>_datagram functions create a new empty datagram *
  * of the specified kind, initially valid for transmission, that allows, but  *
@@ -23,20 +29,60 @@
 #ifndef COMMON_DATAGRAM_EXECUTE_H
 #define COMMON_DATAGRAM_EXECUTE_H
 
+#include <linux/limits.h>
 #include "common/datagram/datagram.h"
 
 #pragma region ======= REQUEST =======
-#define EXECUTE_REQUEST_DATAGRAM_PAYLOAD_LEN 300
+/**
+ * @brief The maximum length of the command of an Execute Request Datagram.
+ */
+#define EXECUTE_REQUEST_DATAGRAM_MAX_PAYLOAD_LEN (32 * 1024)
+
+/**
+ * @brief The maximum length of the command of an Execute Request Datagram sent through the server FIFO. Every request
+ * written to the FIFO must fit in PIPE_BUF, so that writes from concurrent clients are never interleaved.
+ */
+#define EXECUTE_REQUEST_DATAGRAM_FIFO_MAX_PAYLOAD_LEN (PIPE_BUF - sizeof(EXECUTE_REQUEST_DATAGRAM))
+
+/**
+ * @brief The priority classes of a task. A task is only dispatched once no task of a higher class is queued, and may
+ * suspend a running task of a lower class to run right away.
+ */
+typedef enum task_priority {
+    TASK_PRIORITY_LOW,
+    TASK_PRIORITY_NORMAL,
+    TASK_PRIORITY_HIGH
+} TaskPriority;
+
+/**
+ * @brief The number of priority classes.
+ */
+#define TASK_PRIORITY_CLASSES 3
+
 typedef struct execute_request_datagram {
     DATAGRAM_HEADER header;
-    short int time; 
-    char data[EXECUTE_REQUEST_DATAGRAM_PAYLOAD_LEN];
+    short int time;      // The estimated time for the task.
+    uint16_t data_len;   // The length of the task command. The command is not null-terminated.
+    uint8_t priority;    // The priority class of the task. See TaskPriority.
+    uint8_t reserved[3]; // Unused. Keeps the command right after the fixed part of the datagram.
+    char data[];         // The task command.
 } EXECUTE_REQUEST_DATAGRAM, *ExecuteRequestDatagram;
 
 /**
- * @brief Creates a new empty Execute Request Datagram.
+ * @brief Returns the total size of an Execute Request Datagram, command included.
+ * @param dg A pointer to an EXECUTE_REQUEST_DATAGRAM.
  */
-ExecuteRequestDatagram create_execute_request_datagram();
+#define EXECUTE_REQUEST_DATAGRAM_SIZE(dg) (sizeof(EXECUTE_REQUEST_DATAGRAM) + (dg)->data_len)
+
+/**
+ * @brief Creates a new Execute Request Datagram for a task command. The command is copied, and null-terminated in memory
+ * only.
+ * 
+ * @param data     The task command, or NULL to only allocate the fixed part of the datagram, in which case the command
+ *                 is meant to be sent right after it, in the same vectored write.
+ * @param data_len The length of the task command.
+ */
+ExecuteRequestDatagram create_execute_request_datagram(char* data, uint16_t data_len);
 
 /**
  * @brief Reads an Execute Request Datagram from a file descriptor, or NULL if it fails.
@@ -62,12 +108,29 @@ ExecuteRequestDatagram read_partial_execute_request_datagram(int fd, DATAGRAM_HE
  * @param stringPayload Whether the payload should be displayed as a string instead of a byte sequence.
  */
 char* execute_request_datagram_to_string(ExecuteRequestDatagram dg, int expandEnums, int stringPayload);
+
+/**
+ * @brief Returns the priority class with a given name, or -1 if there is none.
+ * @param name The name of the class: "low", "normal" or "high".
+ */
+int parse_task_priority(const char* name);
 #pragma endregion
 
 #pragma region ======= RESPONSE =======
+/**
+ * @brief Whether the tasks of an execute request were queued.
+ */
+typedef enum execute_status {
+    EXECUTE_STATUS_QUEUED,  // The tasks were queued, and got their ids.
+    EXECUTE_STATUS_BUSY,    // The server is over its admission limits. Nothing was queued, and the request may be retried.
+    EXECUTE_STATUS_INVALID  // The request is malformed. Nothing was queued, and retrying it is pointless.
+} ExecuteStatus;
+
 typedef struct execute_response_datagram {
     DATAGRAM_HEADER header;
     uint32_t taskid;
+    uint32_t retry_after; // How long to wait before retrying a busy request, in milliseconds.
+    uint8_t status;       // Whether the task was queued. See ExecuteStatus. The task id is 0 if it was not.
 } EXECUTE_RESPONSE_DATAGRAM, *ExecuteResponseDatagram;
 
 /**
@@ -100,4 +163,163 @@ ExecuteResponseDatagram read_partial_execute_response_datagram(int fd, DATAGRAM_
 char* execute_response_datagram_to_string(ExecuteResponseDatagram dg, int expandEnums);
 #pragma endregion
 
+#pragma region ======= BATCH REQUEST =======
+/**
+ * @brief The maximum size of an Execute Batch Request Datagram. Batches are kept below PIPE_BUF, with some room to spare
+ * for the framing added when forwarding them, so that every write of a batch to a pipe or FIFO is atomic.
+ */
+#define EXECUTE_BATCH_REQUEST_DATAGRAM_MAX_SIZE (PIPE_BUF - 64)
+
+typedef struct execute_batch_entry {
+    short int time;            // The estimated time for the task.
+    uint8_t type;              // The type of the task. See DatagramType.
+    uint8_t priority;          // The priority class of the task. See TaskPriority.
+    uint16_t data_len;         // The length of the task command. The command is not null-terminated.
+    uint16_t num_dependencies; // The number of tasks the task depends on. See get_execute_batch_entry_dependency.
+    char data[];               // The task command, followed by the tasks it depends on, as unaligned int32_t.
+} EXECUTE_BATCH_ENTRY, *ExecuteBatchEntry;
+
+typedef struct execute_batch_request_datagram {
+    DATAGRAM_HEADER header;
+    uint16_t num_tasks;   // The number of entries in the payload.
+    uint16_t payload_len; // The size of the payload, in bytes.
+    uint8_t payload[];    // A sequence of num_tasks EXECUTE_BATCH_ENTRY, each padded to the alignment of the struct.
+} EXECUTE_BATCH_REQUEST_DATAGRAM, *ExecuteBatchRequestDatagram;
+
+/**
+ * @brief Returns the size of an Execute Batch Entry with a command of a given length, padding included.
+ * @param data_len         The length of the task command.
+ * @param num_dependencies The number of tasks the task depends on.
+ */
+#define EXECUTE_BATCH_ENTRY_SIZE(data_len, num_dependencies) \
+    ((sizeof(EXECUTE_BATCH_ENTRY) + (data_len) + (num_dependencies) * sizeof(int32_t) + _Alignof(EXECUTE_BATCH_ENTRY) - 1) \
+        & ~(_Alignof(EXECUTE_BATCH_ENTRY) - 1))
+
+/**
+ * @brief Returns the total size of an Execute Batch Request Datagram, payload included.
+ * @param dg A pointer to an EXECUTE_BATCH_REQUEST_DATAGRAM.
+ */
+#define EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(dg) (sizeof(EXECUTE_BATCH_REQUEST_DATAGRAM) + (dg)->payload_len)
+
+/**
+ * @brief Creates a new empty Execute Batch Request Datagram, with room for EXECUTE_BATCH_REQUEST_DATAGRAM_MAX_SIZE bytes.
+ */
+ExecuteBatchRequestDatagram create_execute_batch_request_datagram();
+
+/**
+ * @brief Appends a task to an Execute Batch Request Datagram.
+ * 
+ * @param dg               The datagram to append the task to.
+ * @param time             The estimated time for the task.
+ * @param type             The type of the task. See DatagramType.
+ * @param priority         The priority class of the task. See TaskPriority.
+ * @param data             The null-terminated task command.
+ * @param dependencies     The tasks the task depends on, or NULL if it depends on none. A positive value is the id of
+ *                         a task queued before, and a negative one the task that many entries earlier in the batch.
+ * @param num_dependencies The number of tasks the task depends on.
+ * 
+ * @return 0 if the task was appended, or 1 if it does not fit in the datagram.
+ */
+int append_execute_batch_request_datagram(
+    ExecuteBatchRequestDatagram dg, 
+    short int time, 
+    uint8_t type, 
+    uint8_t priority, 
+    char* data, 
+    const int32_t* dependencies, 
+    uint16_t num_dependencies
+);
+
+/**
+ * @brief Returns a task an Execute Batch Entry depends on: the id of a task queued before if positive, or, if
+ * negative, the task that many entries earlier in the batch.
+ * 
+ * @param entry The entry.
+ * @param index The index of the dependency, below the number of dependencies of the entry.
+ */
+int32_t get_execute_batch_entry_dependency(ExecuteBatchEntry entry, int index);
+
+/**
+ * @brief Iterates over the tasks of an Execute Batch Request Datagram.
+ * 
+ * @param dg    The datagram to iterate.
+ * @param entry The previous entry, or NULL to get the first one.
+ * 
+ * @return The entry after the given one, or NULL if there are no more entries.
+ */
+ExecuteBatchEntry next_execute_batch_entry(ExecuteBatchRequestDatagram dg, ExecuteBatchEntry entry);
+
+/**
+ * @brief Counts the entries in the payload of an Execute Batch Request Datagram. The payload does not need to be
+ * aligned, so that it can be checked straight from a receive buffer.
+ *
+ * @param payload     The payload.
+ * @param payload_len The size of the payload, in bytes.
+ *
+ * @return The number of entries, or -1 if they do not fill the payload exactly.
+ */
+int count_execute_batch_entries(const uint8_t* payload, uint16_t payload_len);
+
+/**
+ * @brief Reads an Execute Batch Request Datagram from a file descriptor, or NULL if it fails.
+ * @param fd The file descriptor to read.
+ */
+ExecuteBatchRequestDatagram read_execute_batch_request_datagram(int fd);
+
+/**
+ * @brief Reads an Execute Batch Request Datagram from a file descriptor, or NULL if it fails. This version should be
+ * called after reading the header of a datagram, for distinguishing the datagram type.
+ * 
+ * @param fd     The file descriptor to read.
+ * @param header The already read header.
+ */
+ExecuteBatchRequestDatagram read_partial_execute_batch_request_datagram(int fd, DATAGRAM_HEADER header);
+
+/**
+ * @brief Returns a string representation for an Execute Batch Request Datagram.
+ * 
+ * @param dg A pointer to an EXECUTE_BATCH_REQUEST_DATAGRAM structure containing an execute batch datagram.
+ * @param expandEnums Whether the enums should be displayed as their numerical value or string value.
+ */
+char* execute_batch_request_datagram_to_string(ExecuteBatchRequestDatagram dg, int expandEnums);
+#pragma endregion
+
+#pragma region ======= BATCH RESPONSE =======
+typedef struct execute_batch_response_datagram {
+    DATAGRAM_HEADER header;
+    uint32_t first_taskid; // The id of the first task of the batch. The remaining ids follow it contiguously.
+    uint16_t num_tasks;    // The number of tasks queued.
+    uint8_t status;        // Whether the tasks were queued. See ExecuteStatus. A batch is queued whole, or not at all.
+    uint32_t retry_after;  // How long to wait before retrying a busy request, in milliseconds.
+} EXECUTE_BATCH_RESPONSE_DATAGRAM, *ExecuteBatchResponseDatagram;
+
+/**
+ * @brief Creates a new empty Execute Batch Response Datagram.
+ */
+ExecuteBatchResponseDatagram create_execute_batch_response_datagram();
+
+/**
+ * @brief Reads an Execute Batch Response Datagram from a file descriptor, or NULL if it fails.
+ * @param fd The file descriptor to read.
+ */
+ExecuteBatchResponseDatagram read_execute_batch_response_datagram(int fd);
+
+/**
+ * @brief Reads an Execute Batch Response Datagram from a file descriptor, or NULL if it fails. This version should be
+ * called after reading the header of a datagram, for distinguishing the datagram type.
+ * 
+ * @param fd     The file descriptor to read.
+ * @param header The already read header.
+ */
+ExecuteBatchResponseDatagram read_partial_execute_batch_response_datagram(int fd, DATAGRAM_HEADER header);
+
+/**
+ * @brief Returns a string representation for an Execute Batch Response Datagram.
+ * 
+ * @param dg A pointer to an EXECUTE_BATCH_RESPONSE_DATAGRAM structure containing an execute batch datagram.
+ * @param expandEnums Whether the enums should be displayed as their numerical value or string value.
+ */
+char* execute_batch_response_datagram_to_string(ExecuteBatchResponseDatagram dg, int expandEnums);
+#pragma endregion
+
 #endif
\ No newline at end of file
@@ -5,6 +5,9 @@
  * Response Datagrams for the Status Mode of the application architecture.    *
  *   The Status Mode is the mode used to query the current state of a server  *
  * instance, returning the queues, running and completed tasks.               *
+ *   A request may ask for only some sections of the report, and only the     *
+ * last completed tasks. The report is streamed back as a sequence of         *
+ * bounded chunks, the last of which is marked as such.                       *
  *                                                                            *
  *   The create_status_<kind>_datagram functions create a new empty datagram  *
  * of the specified kind, initially valid for transmission, that allows, but  *
@@ -23,20 +26,45 @@
 #ifndef COMMON_DATAGRAM_STATUS_H
 #define COMMON_DATAGRAM_STATUS_H
 
+#include <linux/limits.h>
 #include "common/datagram/datagram.h"
 
 #pragma region ======= REQUEST =======
 #define STATUS_REQUEST_DATAGRAM_PAYLOAD_LEN 8
 
+typedef enum status_section {
+    STATUS_SECTION_QUEUED     = 1 << 0,
+    STATUS_SECTION_RUNNING    = 1 << 1,
+    STATUS_SECTION_COMPLETED  = 1 << 2,
+    STATUS_SECTION_WAIT_TIMES = 1 << 3,
+    STATUS_SECTION_WORKERS    = 1 << 4,
+    STATUS_SECTION_ALL        = STATUS_SECTION_QUEUED | STATUS_SECTION_RUNNING | STATUS_SECTION_COMPLETED 
+        | STATUS_SECTION_WAIT_TIMES | STATUS_SECTION_WORKERS
+} StatusSection;
+
 typedef struct status_request_datagram {
     DATAGRAM_HEADER header;
+    uint8_t sections;         // The sections of the report to include, as StatusSection flags. 0 includes every section.
+    uint32_t completed_limit; // The maximum number of completed tasks to include, keeping the most recent. 0 includes all.
 } STATUS_REQUEST_DATAGRAM, *StatusRequestDatagram;
 
 /**
- * @brief Creates a new empty Status Request Datagram.
+ * @brief Creates a new empty Status Request Datagram, asking for the whole report.
  */
 StatusRequestDatagram create_status_request_datagram();
 
+/**
+ * @brief Sets the filter of a Status Request Datagram from command arguments, of the form
+ * [queued|running|completed [N]|wait|workers].
+ * 
+ * @param dg   The datagram.
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ * 
+ * @return 0 on success, 1 if the arguments are invalid.
+ */
+int set_status_request_filter(StatusRequestDatagram dg, int argc, char* const argv[]);
+
 /**
  * @brief Reads a Status Request Datagram from a file descriptor, or NULL if it fails.
  * @param fd The file descriptor to read.
@@ -66,11 +94,18 @@ char* status_request_datagram_to_string(StatusRequestDatagram dg, int expandEnum
 typedef struct status_response_datagram {
     DATAGRAM_HEADER header;
     uint32_t payload_len;
+    uint8_t last;         // Whether this is the last chunk of the report.
     uint8_t payload[];
 } STATUS_RESPONSE_DATAGRAM, *StatusResponseDatagram;
 
 /**
- * @brief Creates a new empty Status Response Datagram.
+ * @brief The maximum length of the payload of a single Status Response Datagram. Every chunk fits in PIPE_BUF, so that
+ * it is written atomically to a client FIFO.
+ */
+#define STATUS_RESPONSE_DATAGRAM_MAX_PAYLOAD_LEN (PIPE_BUF - sizeof(STATUS_RESPONSE_DATAGRAM))
+
+/**
+ * @brief Creates a new Status Response Datagram, marked as the last chunk of the report.
  */
 StatusResponseDatagram create_status_response_datagram(uint8_t payload[], int payload_len);
 
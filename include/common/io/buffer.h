@@ -0,0 +1,88 @@
+/******************************************************************************
+ *                              IO BUFFER UTILITY                             *
+ *                                                                            *
+ *   The IO Buffer Utility provides a fixed-capacity read buffer used to      *
+ * drain a non-blocking file descriptor in as few read calls as possible,     *
+ * and then consume the buffered bytes one datagram at a time. The buffer     *
+ * never grows, so its capacity, set when it is created, must hold the        *
+ * largest datagram read through it.                                          *
+ *                                                                            *
+ *   Bytes are always appended at the tail of the buffer and consumed from    *
+ * its head. Consumed bytes are only discarded when more space is needed, so  *
+ * consuming many small datagrams from a single fill does not move memory.    *
+ ******************************************************************************/
+
+#ifndef COMMON_IO_BUFFER_H
+#define COMMON_IO_BUFFER_H
+
+#include <stdint.h>
+#include <unistd.h>
+
+typedef struct read_buffer {
+    uint8_t* data; // The backing memory for this buffer.
+    size_t start;  // The offset of the first unconsumed byte.
+    size_t end;    // The offset past the last buffered byte.
+    size_t cap;    // The capacity of the backing memory.
+} READ_BUFFER, *ReadBuffer;
+
+/**
+ * @brief Returns a pointer to the first unconsumed byte of a Read Buffer.
+ * @param rb A Read Buffer.
+ */
+#define READ_BUFFER_HEAD(rb) ((rb)->data + (rb)->start)
+
+/**
+ * @brief Returns the number of unconsumed bytes in a Read Buffer.
+ * @param rb A Read Buffer.
+ */
+#define READ_BUFFER_LEN(rb) ((rb)->end - (rb)->start)
+
+/**
+ * @brief Creates a new empty Read Buffer, or NULL if it fails.
+ * @param cap The capacity of the buffer. Must be larger than the biggest datagram to be read through it.
+ */
+ReadBuffer create_read_buffer(size_t cap);
+
+/**
+ * @brief Reads every byte currently available on a non-blocking file descriptor into a Read Buffer, until the file
+ * descriptor would block or the buffer is full.
+ *
+ * @param rb A Read Buffer.
+ * @param fd The non-blocking file descriptor to read.
+ *
+ * @return The number of bytes read, 0 on EOF or -1 if an error occurred.
+ */
+ssize_t fill_read_buffer(ReadBuffer rb, int fd);
+
+/**
+ * @brief Reads once from a file descriptor into a Read Buffer. Meant for file descriptors that can not be made
+ * non-blocking, such as the standard input, once they are known to be readable.
+ *
+ * @param rb A Read Buffer.
+ * @param fd The file descriptor to read.
+ *
+ * @return The number of bytes read, 0 on EOF or if the buffer is full, or -1 if an error occurred.
+ */
+ssize_t read_once_read_buffer(ReadBuffer rb, int fd);
+
+/**
+ * @brief Consumes bytes from the head of a Read Buffer.
+ *
+ * @param rb A Read Buffer.
+ * @param n  The number of bytes to consume.
+ */
+void consume_read_buffer(ReadBuffer rb, size_t n);
+
+/**
+ * @brief Discards every unconsumed byte of a Read Buffer.
+ * @param rb A Read Buffer.
+ */
+void clear_read_buffer(ReadBuffer rb);
+
+/**
+ * @brief Frees a Read Buffer.
+ * @param rb A Read Buffer.
+ */
+void destroy_read_buffer(ReadBuffer rb);
+
+#endif
@@ -186,5 +186,12 @@ char* get_cwd();
  */
 void drain_fifo(int fd);
 
+/**
+ * @brief Reads exactly nbytes from a file descriptor, across as many reads as needed, retrying on interruptions.
+ * 
+ * @return The number of bytes read, which is less than nbytes only if the end of file is reached, or -1 on error.
+ */
+ssize_t read_full(int fd, void* buf, size_t nbytes);
+
 
 #endif
\ No newline at end of file
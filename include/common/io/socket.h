@@ -0,0 +1,51 @@
+/******************************************************************************
+ *                            IO SOCKET UTILITY                               *
+ *                                                                            *
+ *   The IO Socket Utility module contains the names and helpers for the      *
+ * Unix domain socket transport, an alternative to the named FIFOs.           *
+ *                                                                            *
+ *   The server listens on a SOCK_SEQPACKET socket bound to the abstract      *
+ * namespace, so no file is ever created or removed. Each accepted connection *
+ * is a session of its own: replies are sent back through the connection the *
+ * request came from, and every datagram is delivered as a single message.    *
+ ******************************************************************************/
+
+#ifndef COMMON_IO_SOCKET_H
+#define COMMON_IO_SOCKET_H
+
+#include <unistd.h>
+
+/**
+ * @brief The name for the server socket, in the abstract namespace. The CWD is appended to it, in the same way the
+ * server FIFO lives in the build folder of the CWD, so that independent instances do not collide.
+ */
+#define SERVER_SOCKET "orchestrator:sv_socket:"
+
+/**
+ * @brief The environment variable used by the client to select the transport. Either "fifo" or "socket".
+ * If unset, the client attempts the socket first and falls back to the FIFO.
+ */
+#define TRANSPORT_ENV "ORCHESTRATOR_TRANSPORT"
+
+/**
+ * @brief Creates the non-blocking server socket, bound and listening, or -1 if it fails.
+ */
+int create_server_socket();
+
+/**
+ * @brief Connects to the server socket, returning the connected socket, or -1 if it fails.
+ */
+int connect_server_socket();
+
+/**
+ * @brief Receives a whole message from a SOCK_SEQPACKET socket, regardless of its size.
+ *
+ * @param fd    The socket to receive from.
+ * @param buf   Where to store a pointer to the newly allocated message.
+ * @param flags Additional flags for recv, such as MSG_DONTWAIT.
+ *
+ * @return The size of the message, 0 if the peer closed the connection, or -1 if it fails.
+ */
+ssize_t recv_message(int fd, void** buf, int flags);
+
+#endif
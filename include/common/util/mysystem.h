@@ -1,6 +1,37 @@
 #ifndef COMMON_UTIL_MYSYSTEM_H
 #define COMMON_UTIL_MYSYSTEM_H
 
+/**
+ * @brief The exit status of a command that could not be started, as given by shells.
+ */
+#define MYSYSTEM_EXIT_NOT_RUN 127
+
+/**
+ * @brief Splits a command into its arguments, ready to be executed. Arguments are separated by spaces, and quotes, which
+ * are dropped, group several words into a single argument.
+ *
+ * @param command The command.
+ *
+ * @return The NULL terminated arguments, or NULL if it fails. The first is the program, or NULL for an empty command.
+ */
+char** parse_command_args(const char* command);
+
+/**
+ * @brief Frees the arguments of a command.
+ */
+void destroy_command_args(char** args);
+
+/**
+ * @brief Returns the exit status of a process from the status reported by wait, or 128 plus the signal that killed it,
+ * as given by shells.
+ */
+int get_exit_status(int status);
+
+/**
+ * @brief Executes a command in a process of its own, without a shell, and waits for it.
+ *
+ * @return The exit status of the command, MYSYSTEM_EXIT_NOT_RUN if it could not be started, or -1 if it fails.
+ */
 int mysystem(const char *command);
 
-#endif
\ No newline at end of file
+#endif
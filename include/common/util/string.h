@@ -8,6 +8,8 @@
 #ifndef COMMON_UTIL_STRING_H
 #define COMMON_UTIL_STRING_H
 
+#include <stddef.h>
+
 #define ESCAPE_STR(x) #x
 #define STR(x) ESCAPE_STR(x)
 
@@ -56,4 +58,37 @@ char* bytes_to_hex_string(char* bytes, int len, char separator);
  */
 char* trim(char* orig);
 
+typedef struct string_builder {
+    char* str;  // The null-terminated string built so far.
+    size_t len; // The length of the string, without the null terminator.
+    size_t cap; // The allocated size of the string.
+} STRING_BUILDER, *StringBuilder;
+
+/**
+ * @brief Creates a new empty string builder, or NULL if it fails.
+ * 
+ * @param cap The initial capacity. The builder grows as needed.
+ */
+StringBuilder create_string_builder(size_t cap);
+
+/**
+ * @brief Formats the parameters to the end of a string builder. The capacity grows geometrically, so building a string
+ * takes linear time on its final length.
+ * 
+ * @param sb     The string builder.
+ * @param format String format.
+ * @param ...    Values to use.
+ * 
+ * @return 0 on success, 1 if it fails.
+ */
+int string_builder_append(StringBuilder sb, const char* format, ...);
+
+/**
+ * @brief Destroys a string builder, returning the string it built, which must be freed by the caller.
+ * 
+ * @param sb  The string builder.
+ * @param len Where to store the length of the string, without the null terminator. May be NULL.
+ */
+char* finish_string_builder(StringBuilder sb, size_t* len);
+
 #endif
\ No newline at end of file
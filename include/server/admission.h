@@ -0,0 +1,105 @@
+/******************************************************************************
+ *                             ADMISSION CONTROL                              *
+ *                                                                            *
+ *   The Admission Control bounds how many tasks may be outstanding at once,  *
+ * across every client and for each client, so that a runaway submitter can   *
+ * not grow the backlog of the operator until it runs out of memory. Requests *
+ * over either limit are answered as busy, with a hint of how long to wait    *
+ * before retrying, and nothing is queued.                                    *
+ *   A task is outstanding from the moment the server admits it until the     *
+ * operator is done with it, whether it completed or was cancelled. The       *
+ * server counts the tasks it admits and the operator the tasks it finishes,  *
+ * each in counters only it writes, so that neither ever waits on the other.  *
+ * The finished counters live in memory shared by both.                       *
+ *   Clients are told apart by their pid, hashed into a fixed number of       *
+ * slots. Clients sharing a slot share their limit.                           *
+ ******************************************************************************/
+
+#ifndef SERVER_ADMISSION_H
+#define SERVER_ADMISSION_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+
+/**
+ * @brief The number of slots clients are hashed into.
+ */
+#define ADMISSION_CLIENT_SLOTS 1024
+
+/**
+ * @brief The time a busy client is told to wait before retrying when just over a limit, in milliseconds. The hint
+ * grows with how far over the limit the request would go.
+ */
+#define ADMISSION_RETRY_AFTER 100
+
+/**
+ * @brief The longest a busy client is ever told to wait before retrying, in milliseconds.
+ */
+#define ADMISSION_MAX_RETRY_AFTER 5000
+
+/**
+ * @brief The counters written by the operator, shared with the server.
+ */
+typedef struct admission_shared {
+    _Atomic uint32_t finished;                                // The number of tasks finished.
+    _Atomic uint32_t client_finished[ADMISSION_CLIENT_SLOTS]; // The number of tasks finished, for each client slot.
+} ADMISSION_SHARED, *AdmissionShared;
+
+typedef struct admission {
+    AdmissionShared shared;                           // The counters written by the operator.
+    uint32_t max_tasks;                               // The most tasks outstanding across every client, or 0.
+    uint32_t max_client_tasks;                        // The most tasks outstanding for each client, or 0.
+    uint32_t admitted;                                // The number of tasks admitted. Written by the server only.
+    uint32_t client_admitted[ADMISSION_CLIENT_SLOTS]; // The number of tasks admitted, for each client slot.
+    uint32_t rejected;                                // The number of requests answered as busy.
+} ADMISSION, *Admission;
+
+/**
+ * @brief Creates a new admission control, which is shared with every process forked afterwards, or NULL if it fails.
+ *
+ * @param max_tasks        The most tasks outstanding across every client, or 0 for no limit.
+ * @param max_client_tasks The most tasks outstanding for each client, or 0 for no limit.
+ */
+Admission create_admission(uint32_t max_tasks, uint32_t max_client_tasks);
+
+/**
+ * @brief Admits the tasks of a request, if that keeps every limit. A request over a limit on its own is admitted once
+ * nothing else is outstanding under that limit, so that it is never refused forever.
+ *
+ * @param admission The admission control, or NULL to admit every request.
+ * @param client    The client that sent the request.
+ * @param num_tasks The number of tasks of the request.
+ *
+ * @return 0 if the tasks were admitted, or how long the client should wait before retrying, in milliseconds.
+ */
+uint32_t admission_admit(Admission admission, pid_t client, uint32_t num_tasks);
+
+/**
+ * @brief Takes back admitted tasks that never reached the operator.
+ *
+ * @param admission The admission control, or NULL if there is none.
+ * @param client    The client that sent the request.
+ * @param num_tasks The number of tasks.
+ */
+void admission_revoke(Admission admission, pid_t client, uint32_t num_tasks);
+
+/**
+ * @brief Records that the operator is done with a task, completed or cancelled. Only called by the operator.
+ *
+ * @param admission The admission control, or NULL if there is none.
+ * @param client    The client that queued the task.
+ */
+void admission_release(Admission admission, pid_t client);
+
+/**
+ * @brief Returns the number of tasks outstanding, across every client.
+ */
+uint32_t get_admission_outstanding(Admission admission);
+
+/**
+ * @brief Frees an admission control.
+ */
+void destroy_admission(Admission admission);
+
+#endif
@@ -0,0 +1,60 @@
+/******************************************************************************
+ *                                  BACKLOG                                   *
+ *                                                                            *
+ *   The Backlog holds the tasks waiting for a worker, split by their         *
+ * priority class. Every class gets its own Fair Queue, and a task is only    *
+ * dispatched once every class above its own is empty, so that urgent tasks   *
+ * never wait behind tasks of a lower class, however many of them are queued. *
+ ******************************************************************************/
+
+#ifndef SERVER_BACKLOG_H
+#define SERVER_BACKLOG_H
+
+#include <stdint.h>
+#include <glib-2.0/glib.h>
+#include "common/datagram/execute.h"
+#include "server/fair_queue.h"
+
+typedef struct backlog {
+    FairQueue classes[TASK_PRIORITY_CLASSES]; // The queued tasks of each priority class.
+    guint length;                             // The number of queued tasks, across every class.
+} BACKLOG, *Backlog;
+
+/**
+ * @brief Creates a new empty backlog, or NULL if it fails. Every class shares the settings of its Fair Queue.
+ *
+ * @param quantum   The credit given to a submitter on each of its turns, or 0 to disable fair-share.
+ * @param cost      Returns the cost of a task, in the same unit as the quantum.
+ * @param compare   The comparator that orders the tasks of each submitter, within a class.
+ * @param user_data The data passed to the comparator.
+ */
+Backlog create_backlog(uint32_t quantum, FairQueueCostFunc cost, GCompareDataFunc compare, gpointer user_data);
+
+/**
+ * @brief Inserts a task into a backlog.
+ *
+ * @param backlog   The backlog.
+ * @param priority  The priority class of the task. See TaskPriority.
+ * @param tenant_id The submitter of the task.
+ * @param data      The task.
+ *
+ * @return 0 on success, 1 if the backlog can not grow.
+ */
+int backlog_push(Backlog backlog, uint8_t priority, int tenant_id, gpointer data);
+
+/**
+ * @brief Removes and returns the next task of the highest class with queued tasks, or NULL if the backlog is empty.
+ */
+gpointer backlog_pop(Backlog backlog);
+
+/**
+ * @brief Returns the highest priority class with queued tasks, or -1 if the backlog is empty.
+ */
+int get_backlog_priority(Backlog backlog);
+
+/**
+ * @brief Frees a backlog. The tasks still in it are not freed.
+ */
+void destroy_backlog(Backlog backlog);
+
+#endif
@@ -0,0 +1,88 @@
+/******************************************************************************
+ *                               WORKER CLAIMS                                *
+ *                                                                            *
+ *   The Worker Claims let the operator write tasks to a worker ahead of      *
+ * time, and still take them back while the worker has not started them.     *
+ *   Every task written to a worker gets a claim in shared memory. The worker *
+ * takes the claim before running the task, and the operator steals it to    *
+ * hand the task to another worker. Both use a single compare-and-swap, so    *
+ * exactly one of them wins, and a worker skips every task it finds stolen.   *
+ *   A claim is only released by the operator, once the worker reported the  *
+ * task as completed or skipped, so a worker never holds more claims than it  *
+ * was given cells for.                                                       *
+ ******************************************************************************/
+
+#ifndef SERVER_CLAIMS_H
+#define SERVER_CLAIMS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+typedef enum worker_claim_state {
+    WORKER_CLAIM_FREE,    // The cell holds no task.
+    WORKER_CLAIM_QUEUED,  // The task was written to the worker, which has not started it.
+    WORKER_CLAIM_RUNNING, // The worker took the task.
+    WORKER_CLAIM_STOLEN   // The operator took the task back. The worker will skip it.
+} WorkerClaimState;
+
+/**
+ * @brief Packs a task id and the state of its claim into a single cell value.
+ */
+#define WORKER_CLAIM(task_id, state) (((uint64_t)(uint32_t)(task_id) << 2) | (uint64_t)(state))
+
+typedef struct worker_claims {
+    _Atomic uint64_t* cells; // The claims of every worker, cells_per_worker after each other, in shared memory.
+    int num_workers;         // The number of workers.
+    int cells_per_worker;    // The number of tasks that may be written to a worker at the same time.
+} WORKER_CLAIMS, *WorkerClaims;
+
+/**
+ * @brief Creates the claims of every worker, which are shared with every process forked afterwards, or NULL if it fails.
+ *
+ * @param num_workers      The number of workers.
+ * @param cells_per_worker The number of tasks that may be written to a worker at the same time.
+ */
+WorkerClaims create_worker_claims(int num_workers, int cells_per_worker);
+
+/**
+ * @brief Gives a worker the claim of a task about to be written to it. Only called by the operator.
+ *
+ * @return The cell of the claim, or -1 if the worker has no free cell.
+ */
+int offer_worker_claim(WorkerClaims claims, int worker_id, int task_id);
+
+/**
+ * @brief Takes the claim of a task before running it. Only called by the worker.
+ *
+ * @return 1 if the worker may run the task, 0 if it was stolen and must be skipped.
+ */
+int take_worker_claim(WorkerClaims claims, int worker_id, int task_id);
+
+/**
+ * @brief Steals the claim of a task the worker has not started. Only called by the operator.
+ *
+ * @param claims    The claims.
+ * @param worker_id The worker the task was written to.
+ * @param cell      The cell of the claim, as returned when it was offered.
+ * @param task_id   The id of the task.
+ *
+ * @return 1 if the task was stolen, 0 if the worker already started it.
+ */
+int steal_worker_claim(WorkerClaims claims, int worker_id, int cell, int task_id);
+
+/**
+ * @brief Returns the cell holding the claim of a task in a given state, or -1 if there is none.
+ */
+int find_worker_claim(WorkerClaims claims, int worker_id, int task_id, WorkerClaimState state);
+
+/**
+ * @brief Frees a cell, once the worker is done with its task. Only called by the operator.
+ */
+void release_worker_claim(WorkerClaims claims, int worker_id, int cell);
+
+/**
+ * @brief Unmaps the claims, for the calling process.
+ */
+void destroy_worker_claims(WorkerClaims claims);
+
+#endif
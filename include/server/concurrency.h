@@ -0,0 +1,125 @@
+/******************************************************************************
+ *                             CONCURRENCY LIMIT                              *
+ *                                                                            *
+ *   The Concurrency Limit adapts the number of tasks the operator runs at    *
+ * the same time to how much CPU they actually use, so that IO-bound tasks do *
+ * not leave the CPUs idle and CPU-bound tasks do not fight over them.        *
+ *   The limit follows additive increase, multiplicative decrease, like TCP   *
+ * congestion control. Once per interval, the pressure on the CPUs is         *
+ * measured from /proc/pressure/cpu, or from how busy /proc/stat reports them *
+ * if pressure stall information is not available. If they are congested,     *
+ * the limit is cut. If not, and tasks waited on the limit, it grows by about *
+ * one CPU worth of tasks, as measured from the CPU time completed tasks used *
+ * against the time they ran.                                                 *
+ *   The limit never leaves its configured bounds, and starts at the number   *
+ * of CPUs.                                                                   *
+ ******************************************************************************/
+
+#ifndef SERVER_CONCURRENCY_H
+#define SERVER_CONCURRENCY_H
+
+#include <stdint.h>
+
+/**
+ * @brief The time between two adjustments of the limit, in milliseconds.
+ */
+#define CONCURRENCY_INTERVAL 1000
+
+/**
+ * @brief The share of time some task waited for a CPU past which the CPUs are congested.
+ */
+#define CONCURRENCY_MAX_PRESSURE 0.1
+
+/**
+ * @brief The share of time the CPUs were busy past which they are congested, without pressure stall information.
+ */
+#define CONCURRENCY_MAX_BUSY 0.95
+
+/**
+ * @brief The factor the limit is cut by when the CPUs are congested.
+ */
+#define CONCURRENCY_DECREASE 0.5
+
+/**
+ * @brief The most tasks the limit grows by in a single interval, however little CPU they use.
+ */
+#define CONCURRENCY_MAX_INCREASE 8
+
+/**
+ * @brief The weight of the latest task in the moving average of the CPU share of tasks.
+ */
+#define CONCURRENCY_TASK_CPU_ALPHA 0.25
+
+/**
+ * @brief The counters of the CPUs at some point in time, as read from /proc.
+ */
+typedef struct concurrency_sample {
+    int64_t time_ms;  // The time the counters were read at, in milliseconds, or 0 if they were never read.
+    uint64_t busy;    // The time every CPU was busy for, in clock ticks.
+    uint64_t total;   // The time every CPU was busy or idle for, in clock ticks.
+    uint64_t stalled; // The time some task waited for a CPU, in microseconds, or 0 without pressure stall information.
+} CONCURRENCY_SAMPLE, *ConcurrencySample;
+
+typedef struct concurrency_limit {
+    double limit;              // The number of tasks that may run at the same time. Only whole tasks are dispatched.
+    int min_limit;             // The lowest the limit may be cut to.
+    int max_limit;             // The highest the limit may grow to.
+    double task_cpu;           // The moving average of the CPU time a task used against the time it ran, or -1.
+    uint8_t limited;           // Whether tasks waited on the limit since the last adjustment.
+    CONCURRENCY_SAMPLE sample; // The counters at the last adjustment.
+    double cpu_busy;           // The share of time the CPUs were busy, over the last interval.
+    double cpu_pressure;       // The share of time some task waited for a CPU over the last interval, or -1 if unknown.
+} CONCURRENCY_LIMIT, *ConcurrencyLimit;
+
+/**
+ * @brief Creates a new concurrency limit, or NULL if it fails.
+ *
+ * @param min_limit The lowest the limit may be cut to.
+ * @param max_limit The highest the limit may grow to.
+ */
+ConcurrencyLimit create_concurrency_limit(int min_limit, int max_limit);
+
+/**
+ * @brief Returns the number of tasks that may run at the same time.
+ */
+int get_concurrency_limit(ConcurrencyLimit limit);
+
+/**
+ * @brief Records the CPU time a completed task used.
+ *
+ * @param limit    The concurrency limit.
+ * @param cpu_time The CPU time the task used, user and system, in milliseconds.
+ * @param run_time The time the task ran for, in milliseconds.
+ */
+void concurrency_observe_task(ConcurrencyLimit limit, uint32_t cpu_time, uint32_t run_time);
+
+/**
+ * @brief Records that queued tasks are waiting only because of the limit.
+ */
+void concurrency_mark_limited(ConcurrencyLimit limit);
+
+/**
+ * @brief Takes a single step of the limit, from how congested the CPUs were over the last interval.
+ *
+ * @param limit        The concurrency limit.
+ * @param cpu_busy     The share of time the CPUs were busy.
+ * @param cpu_pressure The share of time some task waited for a CPU, or -1 if unknown.
+ */
+void concurrency_update(ConcurrencyLimit limit, double cpu_busy, double cpu_pressure);
+
+/**
+ * @brief Reads the CPU counters, and adjusts the limit once every interval.
+ *
+ * @param limit  The concurrency limit.
+ * @param now_ms The current time, in milliseconds.
+ *
+ * @return The time until the next adjustment, in milliseconds.
+ */
+int concurrency_adjust(ConcurrencyLimit limit, int64_t now_ms);
+
+/**
+ * @brief Frees a concurrency limit.
+ */
+void destroy_concurrency_limit(ConcurrencyLimit limit);
+
+#endif
@@ -0,0 +1,83 @@
+/******************************************************************************
+ *                              SERVER CONFIG                                 *
+ *                                                                            *
+ *   The Server Config module parses the command line of the server process.  *
+ *   The positional arguments are, in order, the output folder, the number    *
+ * of parallel tasks, which is the most workers the pool grows to, and,       *
+ * optionally, the escalation policy. Every other setting is an optional      *
+ * "--name=value" argument, that may appear anywhere on the command line.     *
+ ******************************************************************************/
+
+#ifndef SERVER_CONFIG_H
+#define SERVER_CONFIG_H
+
+#include <stdint.h>
+
+#define SERVER_USAGE "Usage: $ server <output_folder> <number_of_parallel_tasks> [escalation_policy] [options]\n"\
+    "Options:\n"\
+    "  --transport=<fifo|socket|both>  The transports to listen on. Defaults to both.\n"\
+    "  --reply-timeout=<ms>            How long a reply waits for a client before being dropped. Defaults to 2000.\n"\
+    "  --aging=<ms>                    How much a task's estimated time is favoured per second it waits, under the\n"\
+    "                                  sjb, ljb and certain policies. 0 disables aging. Defaults to 100.\n"\
+    "  --fair-share=<ms>               Take turns between submitting clients, each dispatching up to this much\n"\
+    "                                  estimated time per turn. 0 disables fair-share. Defaults to 0.\n"\
+    "  --prefetch=<n>                  How many tasks each busy worker is given ahead of time, up to 16.\n"\
+    "                                  0 disables prefetching. Defaults to 1.\n"\
+    "  --min-workers=<n>               The fewest workers kept running while idle. The pool grows up to the number\n"\
+    "                                  of parallel tasks while tasks are queued. Defaults to that number.\n"\
+    "  --idle-timeout=<ms>             How long a worker above the minimum may stay idle before it is retired.\n"\
+    "                                  Defaults to 30000.\n"\
+    "  --min-concurrency=<n>           Adapt how many tasks run at the same time to the CPU load, between this and\n"\
+    "                                  the number of parallel tasks. Defaults to that number, which disables it.\n"\
+    "  --affinity=<none|cores>         Pin every worker and its tasks to cores of their own, sharing caches, and the\n"\
+    "                                  operator to a housekeeping core. Defaults to none.\n"\
+    "  --timeout=<n>                   Kill tasks that run for more than n times the time estimated by their client.\n"\
+    "                                  0 disables it. Defaults to 0.\n"\
+    "  --max-backlog=<n>               The most tasks queued or running at once, across every client. Clients over\n"\
+    "                                  it are told to retry later. 0 disables it. Defaults to 0.\n"\
+    "  --max-client-tasks=<n>          The most tasks queued or running at once for each client. 0 disables it.\n"\
+    "                                  Defaults to 0.\n"
+
+#define DEFAULT_ESCALATION_POLICY "fifo"
+#define DEFAULT_AGING_RATE 100
+#define DEFAULT_FAIR_SHARE_QUANTUM 0
+#define DEFAULT_PREFETCH 1
+#define MAX_PREFETCH 16
+#define DEFAULT_IDLE_TIMEOUT 30000
+#define DEFAULT_TIMEOUT_FACTOR 0
+#define DEFAULT_MAX_BACKLOG 0
+#define DEFAULT_MAX_CLIENT_TASKS 0
+
+typedef enum server_transport {
+    SERVER_TRANSPORT_FIFO   = 1 << 0,
+    SERVER_TRANSPORT_SOCKET = 1 << 1,
+    SERVER_TRANSPORT_BOTH   = SERVER_TRANSPORT_FIFO | SERVER_TRANSPORT_SOCKET
+} ServerTransport;
+
+typedef struct server_config {
+    char* output_folder;     // The folder where the task outputs, history, estimates and id files are stored.
+    int parallel_tasks;      // The number of tasks that may be executed at the same time, and so the most workers.
+    char* escalation_policy; // The name of the escalation policy used to order queued tasks.
+    uint8_t transport;       // The transports the server listens on. See ServerTransport.
+    int reply_timeout;       // How long a reply waits for a client before being dropped, in milliseconds.
+    int aging_rate;          // How much a task's estimated time is favoured per second it waits, in milliseconds.
+    int fair_share_quantum;  // The estimated time each submitter may dispatch per turn, in milliseconds, or 0.
+    int prefetch;            // The number of tasks each busy worker is given ahead of time.
+    int min_workers;         // The fewest workers kept running, or -1 to keep every worker running.
+    int idle_timeout;        // How long a worker above the minimum may stay idle, in milliseconds.
+    int min_concurrency;     // The lowest the adaptive concurrency limit may be cut to, or -1 to keep it fixed.
+    uint8_t pin_cpus;        // Whether the operator and the workers are pinned to cores, by the CPU topology.
+    int timeout_factor;      // How many times its estimated time a task may run for before it is killed, or 0.
+    int max_backlog;         // The most tasks queued or running at once, across every client, or 0.
+    int max_client_tasks;    // The most tasks queued or running at once for each client, or 0.
+} SERVER_CONFIG, *ServerConfig;
+
+/**
+ * @brief Parses the server command line, or returns NULL and prints the reason if it is invalid.
+ *
+ * @param argc The number of arguments.
+ * @param argv The arguments, including the program name.
+ */
+ServerConfig parse_server_config(int argc, char const* argv[]);
+
+#endif
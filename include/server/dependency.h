@@ -0,0 +1,82 @@
+/******************************************************************************
+ *                              DEPENDENCY GRAPH                              *
+ *                                                                            *
+ *   The Dependency Graph holds back the tasks that depend on other tasks     *
+ * until every one of them completed successfully, so that multi-step jobs    *
+ * can be queued at once instead of being driven by a script polling status.  *
+ *   Every task that has not completed yet is a node, whether it is held,     *
+ * queued or running. A node counts the parents it still waits for, and lists *
+ * its children, so that completing a task releases its children in time      *
+ * proportional to the number of edges, without ever scanning the graph.      *
+ *   A task that depends on a failed, cancelled or unknown task is cancelled, *
+ * and so is every task depending on it in turn. The ids of failed tasks are  *
+ * kept for the whole life of the graph, so that later tasks can still be     *
+ * told apart from tasks depending on one that succeeded.                     *
+ ******************************************************************************/
+
+#ifndef SERVER_DEPENDENCY_H
+#define SERVER_DEPENDENCY_H
+
+#include <glib-2.0/glib.h>
+
+/**
+ * @brief What happens to a task once it is added to the graph.
+ */
+typedef enum dependency_state {
+    DEPENDENCY_READY,    // Every parent completed successfully. The task may be queued right away.
+    DEPENDENCY_HELD,     // Some parent has not completed yet. The graph holds the task until it does.
+    DEPENDENCY_CANCELLED // Some parent failed, was cancelled or is unknown. The task must not run.
+} DependencyState;
+
+typedef struct dependency_node {
+    int id;             // The id of the task.
+    gpointer data;      // The task, while the graph holds it, or NULL once it was released.
+    guint pending;      // The number of parents that have not completed yet.
+    GArray* children;   // The ids of the tasks depending on this one, or NULL if there are none.
+} DEPENDENCY_NODE, *DependencyNode;
+
+typedef struct dependency_graph {
+    GHashTable* nodes;  // Every task that has not completed yet, indexed by its id.
+    GHashTable* failed; // The ids of every task that failed or was cancelled.
+    int last_id;        // The highest id ever added. Lower ids not in the graph completed.
+    guint held;         // The number of tasks held.
+} DEPENDENCY_GRAPH, *DependencyGraph;
+
+/**
+ * @brief Creates a new empty dependency graph, or NULL if it fails.
+ */
+DependencyGraph create_dependency_graph();
+
+/**
+ * @brief Adds a task to a dependency graph. Cancelled tasks are not added, and only recorded as failed.
+ *
+ * @param graph       The dependency graph.
+ * @param id          The id of the task. Ids must be added in increasing order.
+ * @param parents     The ids of the tasks it depends on. Only ids lower than its own may be depended on.
+ * @param num_parents The number of parents.
+ * @param data        The task, held by the graph if it can not be queued yet.
+ *
+ * @return What happens to the task.
+ */
+DependencyState dependency_graph_add(DependencyGraph graph, int id, const int* parents, int num_parents, gpointer data);
+
+/**
+ * @brief Removes a completed task from a dependency graph, and releases or cancels its children.
+ *
+ * @param graph     The dependency graph.
+ * @param id        The id of the task.
+ * @param succeeded Whether the task completed successfully. Children of a failed task are cancelled.
+ * @param released  The array of tasks the children left without pending parents are appended to.
+ * @param cancelled The array of tasks the held tasks cancelled along the way are appended to.
+ */
+void dependency_graph_complete(DependencyGraph graph, int id, int succeeded, GArray* released, GArray* cancelled);
+
+/**
+ * @brief Frees a dependency graph.
+ *
+ * @param graph   The dependency graph.
+ * @param destroy Frees each task still held, or NULL to leave them be.
+ */
+void destroy_dependency_graph(DependencyGraph graph, GDestroyNotify destroy);
+
+#endif
@@ -0,0 +1,115 @@
+/******************************************************************************
+ *                             RUNTIME ESTIMATOR                              *
+ *                                                                            *
+ *   The Runtime Estimator learns how long tasks take from the tasks the      *
+ * operator already ran, so that the escalation policies do not have to trust *
+ * the time estimated by the client.                                          *
+ *   Tasks are grouped by the shape of their command: the name of every       *
+ * program, its options, and the kind of every other argument. Each group     *
+ * keeps an exponentially weighted moving average and variance of the time    *
+ * its tasks took, and is only trusted once it has seen enough tasks and the  *
+ * time they took is consistent.                                              *
+ *   The estimates are kept in a file in the output folder, so that they      *
+ * survive restarts of the server.                                            *
+ ******************************************************************************/
+
+#ifndef SERVER_ESTIMATOR_H
+#define SERVER_ESTIMATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <glib-2.0/glib.h>
+
+/**
+ * @brief The weight of the latest observation in the moving average and variance.
+ */
+#define ESTIMATOR_ALPHA 0.25
+
+/**
+ * @brief The number of observations a group needs before its estimate is trusted.
+ */
+#define ESTIMATOR_MIN_SAMPLES 3
+
+/**
+ * @brief The largest standard deviation of a trusted estimate, relative to the estimate.
+ */
+#define ESTIMATOR_MAX_DEVIATION 0.25
+
+/**
+ * @brief The standard deviation, in milliseconds, that is always trusted, as very short tasks are dominated by noise.
+ */
+#define ESTIMATOR_DEVIATION_SLACK 10
+
+/**
+ * @brief The maximum number of groups learned. Tasks of new groups are not learned once this is reached.
+ */
+#define ESTIMATOR_MAX_ENTRIES 4096
+
+/**
+ * @brief The number of observations between two saves of the estimates file.
+ */
+#define ESTIMATOR_SAVE_INTERVAL 64
+
+typedef struct estimator_entry {
+    double mean;      // The moving average of the time the tasks took, in milliseconds.
+    double variance;  // The moving variance of the time the tasks took.
+    uint32_t samples; // The number of tasks observed.
+} ESTIMATOR_ENTRY, *EstimatorEntry;
+
+typedef struct estimator {
+    GHashTable* entries; // The learned groups, indexed by their key.
+    char* path;          // The file the estimates are loaded from and saved to, or NULL if they are not persisted.
+    uint32_t unsaved;    // The number of observations since the estimates were last saved.
+} ESTIMATOR, *Estimator;
+
+/**
+ * @brief Creates a new estimator, with the estimates previously saved to a file, or NULL if it fails.
+ *
+ * @param path The file the estimates are loaded from and saved to, or NULL to not persist them. A missing or
+ *             malformed file is not an error: whatever can not be read is simply learned again.
+ */
+Estimator create_estimator(const char* path);
+
+/**
+ * @brief Returns the key of the group a task belongs to, or NULL if it fails. The key must be freed.
+ *
+ * @param command     The task command. Does not need to be null-terminated.
+ * @param command_len The length of the task command.
+ */
+char* get_estimator_key(const char* command, size_t command_len);
+
+/**
+ * @brief Records the time a task took.
+ *
+ * @param estimator   The estimator.
+ * @param command     The task command. Does not need to be null-terminated.
+ * @param command_len The length of the task command.
+ * @param time        The time the task took, in milliseconds.
+ */
+void estimator_observe(Estimator estimator, const char* command, size_t command_len, uint32_t time);
+
+/**
+ * @brief Estimates the time a task will take.
+ *
+ * @param estimator   The estimator.
+ * @param command     The task command. Does not need to be null-terminated.
+ * @param command_len The length of the task command.
+ * @param estimate    Where to store the estimate, in milliseconds.
+ *
+ * @return 1 if the estimate is trusted, 0 if the group of the task was not seen enough or is too inconsistent.
+ */
+int estimator_predict(Estimator estimator, const char* command, size_t command_len, uint32_t* estimate);
+
+/**
+ * @brief Saves the estimates to the estimator file, replacing it atomically.
+ *
+ * @return 0 on success, 1 if the estimates could not be saved.
+ */
+int save_estimator(Estimator estimator);
+
+/**
+ * @brief Frees an estimator, without saving it.
+ */
+void destroy_estimator(Estimator estimator);
+
+#endif
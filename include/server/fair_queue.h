@@ -0,0 +1,82 @@
+/******************************************************************************
+ *                                FAIR QUEUE                                  *
+ *                                                                            *
+ *   The Fair Queue shares the workers between the clients that submit        *
+ * tasks, so that a client that submits many tasks at once can not keep every *
+ * other client waiting until they are all done.                              *
+ *   Every tenant gets its own Priority Queue, ordered by the escalation      *
+ * policy, and tenants take turns through deficit round-robin: on its turn, a *
+ * tenant is credited a quantum of time, and its tasks are dispatched while   *
+ * their estimated time fits in its credit. Tenants with no queued tasks are  *
+ * forgotten, along with their credit.                                        *
+ *   With a quantum of 0, every task is queued for the same tenant, and the   *
+ * queue behaves exactly like a single Priority Queue.                        *
+ ******************************************************************************/
+
+#ifndef SERVER_FAIR_QUEUE_H
+#define SERVER_FAIR_QUEUE_H
+
+#include <stdint.h>
+#include <glib-2.0/glib.h>
+#include "server/priority_queue.h"
+
+/**
+ * @brief The largest cost of a single element, in quanta. Larger costs are capped, so that a tenant never needs more
+ * than this many turns to afford its next element.
+ */
+#define FAIR_QUEUE_MAX_COST_QUANTA 64
+
+/**
+ * @brief Returns the cost of an element, such as the time a task is expected to take.
+ */
+typedef uint32_t (*FairQueueCostFunc)(gconstpointer data);
+
+typedef struct fair_queue_tenant {
+    int id;              // The id of the tenant.
+    PriorityQueue queue; // The queued elements of the tenant.
+    int64_t deficit;     // The credit left to the tenant on its current turn.
+    uint8_t in_turn;     // Whether the tenant was already credited its quantum for its current turn.
+} FAIR_QUEUE_TENANT, *FairQueueTenant;
+
+typedef struct fair_queue {
+    GHashTable* tenants;      // The tenants with queued elements, indexed by their id.
+    GQueue* active;           // The tenants with queued elements, in the order of their turns.
+    guint length;             // The number of elements in the queue, across every tenant.
+    uint32_t quantum;         // The credit given to a tenant on each of its turns, or 0 to use a single tenant.
+    FairQueueCostFunc cost;   // Returns the cost of an element.
+    GCompareDataFunc compare; // Orders the elements of each tenant.
+    gpointer user_data;       // The data passed to the comparator.
+} FAIR_QUEUE, *FairQueue;
+
+/**
+ * @brief Creates a new empty fair queue, or NULL if it fails.
+ *
+ * @param quantum   The credit given to a tenant on each of its turns, or 0 to queue every element for the same tenant.
+ * @param cost      Returns the cost of an element, in the same unit as the quantum.
+ * @param compare   The comparator that orders the elements of each tenant.
+ * @param user_data The data passed to the comparator.
+ */
+FairQueue create_fair_queue(uint32_t quantum, FairQueueCostFunc cost, GCompareDataFunc compare, gpointer user_data);
+
+/**
+ * @brief Inserts an element into a fair queue.
+ *
+ * @param queue     The fair queue.
+ * @param tenant_id The id of the tenant the element belongs to. Ignored if the quantum is 0.
+ * @param data      The element.
+ *
+ * @return 0 on success, 1 if the queue can not grow.
+ */
+int fair_queue_push(FairQueue queue, int tenant_id, gpointer data);
+
+/**
+ * @brief Removes and returns the next element of a fair queue, or NULL if it is empty.
+ */
+gpointer fair_queue_pop(FairQueue queue);
+
+/**
+ * @brief Frees a fair queue. The elements still in it are not freed.
+ */
+void destroy_fair_queue(FairQueue queue);
+
+#endif
@@ -18,12 +18,16 @@
 #include "common/io/io.h"
 #include "common/datagram/execute.h"
 #include "common/datagram/status.h"
+#include "server/ring.h"
+#include "server/snapshot.h"
+#include "server/admission.h"
 
 #define HISTORY_VERSION 1
 
 typedef struct operator {
     pid_t pid;
-    int pd_write;
+    Ring ring;
+    Snapshot snapshot; // The status snapshot, written by the operator and read by the server.
 } OPERATOR, *Operator;
 
 
@@ -67,7 +71,40 @@ char* task_history_entry_to_string(Task_history_entry history_entry);
 
 /**
  * @brief Starts a new operator process.
+ * 
+ * @param num_parallel_tasks The most workers the pool grows to.
+ * @param output_dir         The folder the task outputs are stored in.
+ * @param history_file_path  The history file completed tasks are appended to.
+ * @param estimates_path     The file the learned task time estimates are kept in, across restarts.
+ * @param escalation_policy  The name of the policy used to order queued tasks.
+ * @param aging_rate         How much a task's estimated time is favoured per second it waits, in milliseconds.
+ * @param fair_share_quantum The estimated time each submitter may dispatch on its turn, in milliseconds, or 0 to
+ *                           dispatch every task by the escalation policy alone.
+ * @param prefetch           The number of tasks written to each busy worker ahead of time, besides the one it runs.
+ * @param min_workers        The fewest workers kept running. Workers above it are started while tasks are queued.
+ * @param idle_timeout       How long a worker above the minimum may stay idle before it is retired, in milliseconds.
+ * @param min_concurrency    The lowest the number of running tasks is limited to under CPU contention, or the number
+ *                           of parallel tasks to never limit it.
+ * @param pin_cpus           Whether to pin the operator to a housekeeping core, and every worker to cores of its own.
+ * @param timeout_factor     How many times the time estimated by its client a task may run for before it is killed,
+ *                           or 0 to let tasks run for as long as they take.
+ * @param admission          The admission control the tasks the operator is done with are released to, or NULL.
  */
-OPERATOR start_operator(int num_parallel_tasks, char* output_dir, char* history_file_path, char* escalation_policy);
+OPERATOR start_operator(
+    int num_parallel_tasks, 
+    char* output_dir, 
+    char* history_file_path, 
+    char* estimates_path, 
+    char* escalation_policy, 
+    int aging_rate, 
+    int fair_share_quantum, 
+    int prefetch, 
+    int min_workers, 
+    int idle_timeout, 
+    int min_concurrency, 
+    int pin_cpus, 
+    int timeout_factor, 
+    Admission admission
+);
 
 #endif
\ No newline at end of file
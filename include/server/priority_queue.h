@@ -0,0 +1,66 @@
+/******************************************************************************
+ *                              PRIORITY QUEUE                                *
+ *                                                                            *
+ *   The Priority Queue holds the backlog of the operator process. It is an   *
+ * array-backed binary heap, ordered by the comparator of the escalation      *
+ * policy, with O(log n) insertion and removal of the first task.             *
+ *   Elements that compare as equal leave the queue in the order they were   *
+ * inserted, like they did when the backlog was a sorted list.                *
+ ******************************************************************************/
+
+#ifndef SERVER_PRIORITY_QUEUE_H
+#define SERVER_PRIORITY_QUEUE_H
+
+#include <stdint.h>
+#include <glib-2.0/glib.h>
+
+/**
+ * @brief The initial number of elements a queue has room for. The queue grows as needed.
+ */
+#define PRIORITY_QUEUE_INITIAL_CAPACITY 64
+
+typedef struct priority_queue_entry {
+    gpointer data;  // The element.
+    uint64_t order; // The insertion order of the element, used to break ties.
+} PRIORITY_QUEUE_ENTRY, *PriorityQueueEntry;
+
+typedef struct priority_queue {
+    PriorityQueueEntry entries; // The heap, where every entry comes before both of its children.
+    guint length;               // The number of elements in the queue.
+    guint capacity;             // The number of elements the queue has room for.
+    uint64_t next_order;        // The insertion order of the next element.
+    GCompareDataFunc compare;   // Returns a negative value if the first element should leave the queue first.
+    gpointer user_data;         // The data passed to the comparator.
+} PRIORITY_QUEUE, *PriorityQueue;
+
+/**
+ * @brief Creates a new empty priority queue, or NULL if it fails.
+ *
+ * @param compare   The comparator that orders the elements.
+ * @param user_data The data passed to the comparator.
+ */
+PriorityQueue create_priority_queue(GCompareDataFunc compare, gpointer user_data);
+
+/**
+ * @brief Inserts an element into a priority queue.
+ *
+ * @return 0 on success, 1 if the queue can not grow.
+ */
+int priority_queue_push(PriorityQueue queue, gpointer data);
+
+/**
+ * @brief Returns the first element of a priority queue, without removing it, or NULL if it is empty.
+ */
+gpointer priority_queue_peek(PriorityQueue queue);
+
+/**
+ * @brief Removes and returns the first element of a priority queue, or NULL if it is empty.
+ */
+gpointer priority_queue_pop(PriorityQueue queue);
+
+/**
+ * @brief Frees a priority queue. The elements still in it are not freed.
+ */
+void destroy_priority_queue(PriorityQueue queue);
+
+#endif
@@ -0,0 +1,90 @@
+/******************************************************************************
+ *                                REPLY QUEUE                                 *
+ *                                                                            *
+ *   The Reply Queue delivers the replies of the main server to its clients   *
+ * without ever blocking the event loop.                                      *
+ *   A reply is first attempted right away, through a non-blocking open of    *
+ * the FIFO of the client, or a non-blocking send on its connection. If the   *
+ * client is not ready to receive it, the reply is kept pending and retried   *
+ * on every cycle of the event loop, until it is delivered or its timeout     *
+ * runs out, in which case it is dropped and counted.                         *
+ *   Replies to the same client are always delivered in order. Each client    *
+ * has its own queue of pending replies, and only the first one is retried.   *
+ ******************************************************************************/
+
+#ifndef SERVER_REPLY_H
+#define SERVER_REPLY_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <glib-2.0/glib.h>
+
+/**
+ * @brief The interval between retries of pending replies, in milliseconds.
+ */
+#define REPLY_RETRY_INTERVAL 10
+
+/**
+ * @brief The default time a reply is kept pending before being dropped, in milliseconds.
+ */
+#define DEFAULT_REPLY_TIMEOUT 2000
+
+typedef struct reply_target {
+    pid_t pid; // The client whose FIFO the reply is written to, if fd is -1.
+    int fd;    // The connection the reply is sent through, or -1 to reply through the FIFO of the client.
+} REPLY_TARGET;
+
+typedef struct pending_reply {
+    REPLY_TARGET target; // The client the reply is for.
+    int fifo_fd;         // The FIFO of the client, once opened, or -1.
+    uint64_t deadline;   // The time after which the reply is dropped, in milliseconds of the monotonic clock.
+    size_t size;         // The size of the reply.
+    size_t offset;       // The number of bytes already written, if the reply did not fit the FIFO at once.
+    uint8_t data[];      // The reply.
+} PENDING_REPLY, *PendingReply;
+
+typedef struct reply_queue {
+    GHashTable* clients; // The replies not yet delivered to each client, in the order they were sent, by client.
+    GQueue* waiting;     // The queues of the clients with replies not yet delivered, in no particular order.
+    int timeout;         // The time a reply is kept pending before being dropped, in milliseconds.
+    uint64_t dropped;    // The number of replies dropped, either timed out or to clients that are gone.
+} REPLY_QUEUE, *ReplyQueue;
+
+/**
+ * @brief Creates a new empty Reply Queue, or NULL if it fails.
+ * @param timeout The time a reply is kept pending before being dropped, in milliseconds.
+ */
+ReplyQueue create_reply_queue(int timeout);
+
+/**
+ * @brief Sends a reply to a client, or queues it if the client is not ready to receive it. Never blocks.
+ *
+ * @param queue  The queue of pending replies.
+ * @param target The client the reply is for.
+ * @param data   The reply. It is copied if it needs to be queued.
+ * @param size   The size of the reply.
+ */
+void send_reply(ReplyQueue queue, REPLY_TARGET target, const void* data, size_t size);
+
+/**
+ * @brief Retries the first pending reply of every client, and drops the ones that timed out.
+ *
+ * @return The time until the next retry is due, in milliseconds, or -1 if there are no pending replies. Meant to be used
+ * as the timeout of poll.
+ */
+int retry_replies(ReplyQueue queue);
+
+/**
+ * @brief Drops every pending reply for a connection, before the connection is closed.
+ *
+ * @param queue The queue of pending replies.
+ * @param fd    The connection being closed.
+ */
+void cancel_replies(ReplyQueue queue, int fd);
+
+/**
+ * @brief Drops every pending reply and frees a Reply Queue.
+ */
+void destroy_reply_queue(ReplyQueue queue);
+
+#endif
@@ -0,0 +1,125 @@
+/******************************************************************************
+ *                               MESSAGE RING                                 *
+ *                                                                            *
+ *   The Message Ring is the event channel of the operator process. It is a   *
+ * bounded multi-producer, single-consumer queue living in shared memory,     *
+ * written to by the main server and by every worker, and read only by the   *
+ * operator.                                                                  *
+ *   The ring is split into fixed-size slots. A message takes as many        *
+ * consecutive slots as it needs, and the first slot holds its type and      *
+ * length, which replaces the process marks previously written before every  *
+ * message on the operator pipe.                                              *
+ *   Producers claim slots with a compare-and-swap on the tail of the ring,   *
+ * and publish a message by updating the sequence number of its first slot.  *
+ * The consumer only sleeps when the ring is empty, in which case producers   *
+ * ring an eventfd doorbell to wake it up.                                    *
+ ******************************************************************************/
+
+#ifndef SERVER_RING_H
+#define SERVER_RING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/**
+ * @brief The size of a single slot, in bytes.
+ */
+#define RING_SLOT_SIZE 512
+
+/**
+ * @brief The number of slots in the ring. Must be a power of two.
+ */
+#define RING_NUM_SLOTS 1024
+
+/**
+ * @brief The maximum size of a single message. Larger messages are rejected.
+ */
+#define RING_MAX_MESSAGE_SIZE (RING_SLOT_SIZE * RING_NUM_SLOTS / 4)
+
+/**
+ * @brief The process a message comes from.
+ */
+typedef enum ring_message_type {
+    RING_MESSAGE_NONE,
+    RING_MESSAGE_SERVER, // A client datagram forwarded by the main server.
+    RING_MESSAGE_WORKER  // A worker datagram.
+} RingMessageType;
+
+typedef struct ring_slot {
+    _Atomic uint64_t sequence; // The position this slot is free for, or one past it once a message is published.
+    uint16_t type;             // The type of the message starting at this slot. See RingMessageType.
+    uint32_t length;           // The length of the message starting at this slot.
+} RING_SLOT, *RingSlot;
+
+typedef struct ring_shared {
+    _Alignas(64) _Atomic uint64_t tail; // The next position to be claimed by a producer.
+    _Alignas(64) _Atomic uint8_t waiting; // Whether the consumer is sleeping on the doorbell.
+    _Atomic uint8_t closed;               // Whether the consumer is gone, and producers should give up.
+    _Alignas(64) RING_SLOT slots[RING_NUM_SLOTS];
+    uint8_t data[RING_NUM_SLOTS * RING_SLOT_SIZE];
+} RING_SHARED, *RingShared;
+
+typedef struct ring {
+    RingShared shared; // The shared memory of the ring.
+    int doorbell;      // The eventfd used to wake up the consumer.
+    uint64_t head;     // The next position to be read. Only meaningful for the consumer.
+} RING, *Ring;
+
+/**
+ * @brief Creates a new ring, which is shared with every process forked afterwards, or NULL if it fails.
+ */
+Ring create_ring();
+
+/**
+ * @brief Writes a single message, gathered from multiple buffers, waiting for space if the ring is full.
+ *
+ * @param ring   The ring to write to.
+ * @param type   The type of the message. See RingMessageType.
+ * @param iov    The buffers that make up the message, in order.
+ * @param iovcnt The number of buffers.
+ *
+ * @return 0 on success, 1 if the message is too large or the consumer is gone.
+ */
+int ring_write(Ring ring, uint16_t type, const struct iovec* iov, int iovcnt);
+
+/**
+ * @brief Reads the next message without blocking.
+ *
+ * @param ring The ring to read from.
+ * @param type Where to store the type of the message.
+ * @param buf  A buffer of at least RING_MAX_MESSAGE_SIZE bytes, where the message is copied to.
+ *
+ * @return The length of the message, or -1 if the ring is empty.
+ */
+ssize_t ring_read(Ring ring, uint16_t* type, void* buf);
+
+/**
+ * @brief Waits until there is at least one message to be read.
+ *
+ * @return 0 if there are messages, or -1 if the wait was interrupted by a signal.
+ */
+int ring_wait(Ring ring);
+
+/**
+ * @brief Waits until there is at least one message to be read, or until a timeout expires.
+ *
+ * @param ring    The ring.
+ * @param timeout The longest time to wait, in milliseconds, or -1 to wait forever.
+ *
+ * @return 0 if there are messages, 1 if the timeout expired, or -1 if the wait was interrupted by a signal.
+ */
+int ring_wait_timeout(Ring ring, int timeout);
+
+/**
+ * @brief Marks the consumer as gone, so that producers waiting for space give up.
+ */
+void close_ring(Ring ring);
+
+/**
+ * @brief Unmaps the ring and closes its doorbell, for the calling process.
+ */
+void destroy_ring(Ring ring);
+
+#endif
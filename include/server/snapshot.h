@@ -0,0 +1,226 @@
+/******************************************************************************
+ *                              STATUS SNAPSHOT                               *
+ *                                                                            *
+ *   The Status Snapshot is a compact view of the queued, running and         *
+ * recently completed tasks, living in shared memory. It is written only by   *
+ * the operator process, which updates it incrementally as tasks are queued,  *
+ * dispatched and completed, and read by the main server to answer status     *
+ * requests without a round-trip to the operator or its workers.              *
+ *   Updates are published through a sequence lock: the sequence number is    *
+ * odd while an update is in progress, and readers copy the snapshot and      *
+ * retry if the sequence number changed meanwhile. The operator never waits   *
+ * for readers.                                                               *
+ *   Only a bounded number of tasks is listed in each section. Queued and     *
+ * running tasks beyond that are counted, but not listed.                     *
+ *   The time every dispatched task waited in the backlog is kept in a        *
+ * log-linear histogram, from which the wait time percentiles of the          *
+ * escalation policy are reported.                                            *
+ *   The size of the worker pool, and how often it grew and shrank, is kept   *
+ * along with the tasks, and so is the adaptive concurrency limit, with the   *
+ * CPU load it was last adjusted from.                                        *
+ ******************************************************************************/
+
+#ifndef SERVER_SNAPSHOT_H
+#define SERVER_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "common/datagram/status.h"
+
+/**
+ * @brief The length of the preview of a task command kept in the snapshot. Longer commands are truncated.
+ */
+#define SNAPSHOT_COMMAND_LEN 64
+
+/**
+ * @brief The maximum number of queued tasks listed in the snapshot.
+ */
+#define SNAPSHOT_MAX_QUEUED 256
+
+/**
+ * @brief The maximum number of running tasks listed in the snapshot.
+ */
+#define SNAPSHOT_MAX_RUNNING 64
+
+/**
+ * @brief The number of recently completed tasks listed in the snapshot.
+ */
+#define SNAPSHOT_MAX_COMPLETED 32
+
+/**
+ * @brief The length of the name of the escalation policy kept in the snapshot.
+ */
+#define SNAPSHOT_POLICY_LEN 15
+
+/**
+ * @brief The number of exact buckets at the start of the wait time histogram. Every power of two after them is split
+ * into this many buckets, which bounds the error of a percentile to 1 / SNAPSHOT_WAIT_SUB_BUCKETS of its value.
+ */
+#define SNAPSHOT_WAIT_SUB_BUCKETS 4
+
+/**
+ * @brief The number of buckets of the wait time histogram, enough for any 32 bit wait time.
+ */
+#define SNAPSHOT_WAIT_BUCKETS (SNAPSHOT_WAIT_SUB_BUCKETS * 31)
+
+typedef struct snapshot_task {
+    int task_id;                            // The id of the task, or 0 if this entry is free.
+    uint32_t time;                          // The time the task took, in milliseconds, for completed tasks.
+    char command[SNAPSHOT_COMMAND_LEN + 1]; // The null-terminated preview of the task command.
+} SNAPSHOT_TASK, *SnapshotTask;
+
+typedef struct snapshot_shared {
+    _Atomic uint64_t sequence;  // Odd while the operator is updating the snapshot.
+    uint32_t num_queued;        // The number of queued tasks, listed or not.
+    uint32_t num_running;       // The number of running tasks.
+    uint64_t num_completed;     // The number of tasks completed since the server started.
+    SNAPSHOT_TASK queued[SNAPSHOT_MAX_QUEUED];       // The listed queued tasks, in no particular order.
+    SNAPSHOT_TASK running[SNAPSHOT_MAX_RUNNING];     // The listed running tasks, in no particular order.
+    SNAPSHOT_TASK completed[SNAPSHOT_MAX_COMPLETED]; // The recently completed tasks, oldest overwritten first.
+    char policy[SNAPSHOT_POLICY_LEN + 1];            // The name of the escalation policy.
+    uint64_t num_waits;                              // The number of tasks dispatched since the server started.
+    uint32_t max_wait;                               // The longest time a task waited, in milliseconds.
+    uint64_t wait_buckets[SNAPSHOT_WAIT_BUCKETS];    // The histogram of the time tasks waited, in milliseconds.
+    uint32_t num_workers;                            // The number of running workers.
+    uint32_t min_workers;                            // The number of workers the pool never shrinks below.
+    uint32_t max_workers;                            // The number of workers the pool never grows beyond.
+    uint64_t num_started;                            // The number of workers started since the server started.
+    uint64_t num_retired;                            // The number of idle workers retired since the server started.
+    uint32_t concurrency_limit;                      // The number of tasks that may run at the same time.
+    uint32_t min_concurrency;                        // The lowest the limit may be cut to, or 0 if it is fixed.
+    double cpu_busy;                                 // The share of time the CPUs were busy, at the last adjustment.
+    double cpu_pressure;                             // The share of time some task waited for a CPU, or -1 if unknown.
+    double task_cpu;                                 // The average CPU share of a task, or -1 if unknown.
+} SNAPSHOT_SHARED, *SnapshotShared;
+
+typedef struct snapshot {
+    SnapshotShared shared;                  // The shared memory of the snapshot.
+    int free_queued[SNAPSHOT_MAX_QUEUED];   // The free entries of the queued section. Only meaningful for the operator.
+    int num_free_queued;                    // The number of free entries of the queued section.
+    int free_running[SNAPSHOT_MAX_RUNNING]; // The free entries of the running section. Only meaningful for the operator.
+    int num_free_running;                   // The number of free entries of the running section.
+} SNAPSHOT, *Snapshot;
+
+/**
+ * @brief Creates a new empty snapshot, which is shared with every process forked afterwards, or NULL if it fails.
+ *
+ * @param policy The name of the escalation policy, reported along with the wait times.
+ */
+Snapshot create_snapshot(const char* policy);
+
+/**
+ * @brief Lists a newly queued task.
+ *
+ * @param snapshot    The snapshot.
+ * @param task_id     The id of the task.
+ * @param command     The task command. Does not need to be null-terminated.
+ * @param command_len The length of the task command.
+ *
+ * @return The entry the task was listed in, or -1 if the queued section is full and the task is only counted.
+ */
+int snapshot_enqueue(Snapshot snapshot, int task_id, const char* command, size_t command_len);
+
+/**
+ * @brief Moves a queued task to the running section.
+ *
+ * @param snapshot    The snapshot.
+ * @param entry       The entry the task was listed in when queued, or -1 if it was not listed.
+ * @param task_id     The id of the task.
+ * @param command     The task command. Does not need to be null-terminated.
+ * @param command_len The length of the task command.
+ *
+ * @return The entry the task is listed in while running, or -1 if the running section is full and the task is only
+ * counted.
+ */
+int snapshot_dispatch(Snapshot snapshot, int entry, int task_id, const char* command, size_t command_len);
+
+/**
+ * @brief Removes a queued task that will never run, as a task it depends on failed.
+ *
+ * @param snapshot The snapshot.
+ * @param entry    The entry the task was listed in when queued, or -1 if it was not listed.
+ */
+void snapshot_cancel(Snapshot snapshot, int entry);
+
+/**
+ * @brief Moves a running task to the completed section. It is listed there even if it was not listed while running.
+ *
+ * @param snapshot    The snapshot.
+ * @param entry       The entry the task was listed in while running, or -1 if it was not listed.
+ * @param task_id     The id of the task.
+ * @param command     The task command. Does not need to be null-terminated.
+ * @param command_len The length of the task command.
+ * @param time        The time the task took, in milliseconds.
+ */
+void snapshot_complete(Snapshot snapshot, int entry, int task_id, const char* command, size_t command_len, uint32_t time);
+
+/**
+ * @brief Records the time a task waited in the backlog before being dispatched.
+ *
+ * @param snapshot The snapshot.
+ * @param wait     The time the task waited, in milliseconds.
+ */
+void snapshot_record_wait(Snapshot snapshot, uint32_t wait);
+
+/**
+ * @brief Records the size of the worker pool. Workers started or retired since the last call are counted.
+ *
+ * @param snapshot    The snapshot.
+ * @param num_workers The number of running workers.
+ * @param min_workers The number of workers the pool never shrinks below.
+ * @param max_workers The number of workers the pool never grows beyond.
+ */
+void snapshot_set_pool(Snapshot snapshot, uint32_t num_workers, uint32_t min_workers, uint32_t max_workers);
+
+/**
+ * @brief Records the adaptive concurrency limit, and the CPU load it was adjusted from.
+ *
+ * @param snapshot     The snapshot.
+ * @param limit        The number of tasks that may run at the same time.
+ * @param min_limit    The lowest the limit may be cut to. The highest is the largest the worker pool may grow to.
+ * @param cpu_busy     The share of time the CPUs were busy.
+ * @param cpu_pressure The share of time some task waited for a CPU, or -1 if unknown.
+ * @param task_cpu     The average share of a CPU a task uses, or -1 if unknown.
+ */
+void snapshot_set_concurrency(
+    Snapshot snapshot, 
+    uint32_t limit, 
+    uint32_t min_limit, 
+    double cpu_busy, 
+    double cpu_pressure, 
+    double task_cpu
+);
+
+/**
+ * @brief Returns an upper bound of a wait time percentile, in milliseconds, or 0 if no task was dispatched yet.
+ *
+ * @param copy       A consistent copy of the snapshot.
+ * @param percentile The percentile, between 0 and 100.
+ */
+uint32_t get_snapshot_wait_percentile(SnapshotShared copy, double percentile);
+
+/**
+ * @brief Copies a consistent view of the snapshot. Never blocks the operator.
+ *
+ * @param snapshot The snapshot.
+ * @param copy     Where to copy the snapshot to.
+ */
+void read_snapshot(Snapshot snapshot, SnapshotShared copy);
+
+/**
+ * @brief Returns the status report for a copy of the snapshot, as shown to clients, or NULL if it fails.
+ *
+ * @param copy            A consistent copy of the snapshot.
+ * @param sections        The sections to include, as StatusSection flags. 0 includes every section.
+ * @param completed_limit The maximum number of completed tasks to include, keeping the most recent. 0 includes all.
+ * @param len             Where to store the length of the report, without the null terminator.
+ */
+char* snapshot_to_string(SnapshotShared copy, uint8_t sections, uint32_t completed_limit, size_t* len);
+
+/**
+ * @brief Unmaps the snapshot, for the calling process.
+ */
+void destroy_snapshot(Snapshot snapshot);
+
+#endif
@@ -0,0 +1,82 @@
+/******************************************************************************
+ *                               CPU TOPOLOGY                                 *
+ *                                                                            *
+ *   The CPU Topology module places the operator and its workers on the CPUs  *
+ * the server may run on, as read from /sys/devices/system/cpu, so that they  *
+ * stop migrating between CPUs and sockets.                                   *
+ *   The CPUs are ordered so that those sharing a socket, a last level cache  *
+ * and a core end up next to each other, and are grouped into cores. The      *
+ * first core is kept for the operator, as housekeeping, and the others are   *
+ * split between the workers in that order, so that the cores of a worker     *
+ * share their caches. A worker and every process it spawns stay on its       *
+ * cores, and the stages of a pipeline are spread over them, so that stages   *
+ * feeding each other run side by side on CPUs that share a cache.            *
+ *   With more workers than cores, neighbouring workers share a core.         *
+ ******************************************************************************/
+
+#ifndef SERVER_TOPOLOGY_H
+#define SERVER_TOPOLOGY_H
+
+/**
+ * @brief The path the topology of every CPU is read from.
+ */
+#define CPU_TOPOLOGY_PATH "/sys/devices/system/cpu"
+
+typedef struct cpu_topology_entry {
+    int cpu;     // The number of the CPU.
+    int package; // The socket of the CPU.
+    int cache;   // The lowest numbered CPU sharing the last level cache of the CPU.
+    int core;    // The core of the CPU, within its socket. Hyperthreads of the same core share it.
+} CPU_TOPOLOGY_ENTRY, *CpuTopologyEntry;
+
+typedef struct cpu_list {
+    int* cpus; // The numbers of the CPUs, in topology order.
+    int len;   // The number of CPUs.
+} CPU_LIST, *CpuList;
+
+typedef struct cpu_placement {
+    CPU_LIST housekeeping; // The CPUs the operator runs on.
+    CPU_LIST* workers;     // The CPUs each worker, and every process it spawns, runs on.
+    int num_workers;       // The number of workers.
+} CPU_PLACEMENT, *CpuPlacement;
+
+/**
+ * @brief Places the operator and the workers on a set of CPUs, or returns NULL if it fails.
+ *
+ * @param cpus        The topology of every CPU that may be used. Reordered in place.
+ * @param num_cpus    The number of CPUs.
+ * @param num_workers The number of workers.
+ */
+CpuPlacement plan_cpu_placement(CpuTopologyEntry cpus, int num_cpus, int num_workers);
+
+/**
+ * @brief Places the operator and the workers on the CPUs the calling process may run on, or returns NULL if their
+ * topology can not be read.
+ *
+ * @param num_workers The number of workers.
+ */
+CpuPlacement create_cpu_placement(int num_workers);
+
+/**
+ * @brief Pins the calling process to a list of CPUs. Processes it forks afterwards inherit it.
+ *
+ * @return 0 on success, 1 if it fails.
+ */
+int pin_to_cpus(CpuList cpus);
+
+/**
+ * @brief Returns the CPU a stage of a pipeline runs on, within the CPUs of its worker, or -1 if the worker has fewer
+ * CPUs than the pipeline has stages, and the stages should share all of them.
+ *
+ * @param worker     The CPUs of the worker.
+ * @param stage      The index of the stage.
+ * @param num_stages The number of stages of the pipeline.
+ */
+int get_pipeline_stage_cpu(CpuList worker, int stage, int num_stages);
+
+/**
+ * @brief Frees a placement.
+ */
+void destroy_cpu_placement(CpuPlacement placement);
+
+#endif
@@ -7,21 +7,83 @@
  * upon which the operator process shall distribute tasks as they arrive.     *
  *   The amount of worker processes to be created depends on the server input *
  * parallel_tasks.                                                            *
+ *   Every task runs in a process group of its own, which the operator may    *
+ * suspend to lend the slot of the worker to a more urgent task, and resume   *
+ * later. A task given a timeout is killed once it runs past it, not counting *
+ * the time it spent suspended: SIGTERM first, then SIGKILL after a grace     *
+ * period, so that a hung task frees its worker within its timeout and that   *
+ * period.                                                                    *
+ *   Each stage of a task is a single process, spawned straight from the      *
+ * worker with its pipes and output already in place, without a copy of the   *
+ * worker in between. A task exits with the status of its last stage, as in a *
+ * shell, which decides whether the tasks depending on it may run.            *
  ******************************************************************************/
 
 #ifndef SERVER_WORKER_H
 #define SERVER_WORKER_H
 
 #include <fcntl.h>
+#include <signal.h>
+#include "server/ring.h"
+#include "server/claims.h"
+#include "server/topology.h"
+
+/**
+ * @brief The size of the buffer a worker reads its datagrams into. Must be larger than the biggest datagram.
+ */
+#define WORKER_READ_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @brief How long a task killed for running past its timeout is given to exit after SIGTERM, before it is sent
+ * SIGKILL, in milliseconds.
+ */
+#define TASK_KILL_GRACE 1000
+
+/**
+ * @brief How often a task with a timeout is checked on, in milliseconds, if its processes can not be watched through
+ * pidfds.
+ */
+#define TASK_POLL_INTERVAL 10
+
+/**
+ * @brief The signal the operator sends a worker to stop its running task, until it is resumed.
+ */
+#define WORKER_SIGNAL_SUSPEND SIGUSR1
+
+/**
+ * @brief The signal the operator sends a worker to continue its suspended task.
+ */
+#define WORKER_SIGNAL_RESUME SIGUSR2
 
 typedef struct worker {
     pid_t pid;
     int pipe_write;
+    size_t pipe_capacity; // The bytes the pipe to the worker holds before writing to it blocks.
 } WORKER, *Worker;
 
+/**
+ * @brief Runs a task, a pipeline of commands separated by '|', and waits for it. Its output and errors go to a file.
+ *
+ * @param input       The task.
+ * @param output_file The file the output and errors of the task are written to.
+ * @param timeout     The longest the task may run for, in milliseconds, or 0 to wait for as long as it takes.
+ * @param cpu_time    Set to the CPU time the task used, user and system, in milliseconds.
+ * @param timed_out   Set to whether the task was killed for running past its timeout.
+ * @param cpus        The CPUs of the worker, which the stages are spread over, or NULL to let them run anywhere.
+ *
+ * @return The exit status of the last stage, 128 plus the signal that killed it, or 127 if it could not be started.
+ */
+int run_task(char* input, char* output_file, uint32_t timeout, uint32_t* cpu_time, uint8_t* timed_out, CpuList cpus);
+
 /**
  * @brief Starts a new worker process.
+ *
+ * @param operator_ring The ring the worker reports completed tasks to.
+ * @param claims        The claims the worker takes before running each task.
+ * @param worker_id     The index of the worker, which it reports back on completion.
+ * @param output_dir    The folder the task outputs are stored in.
+ * @param cpus          The CPUs the worker and its tasks are pinned to, or NULL to let them run anywhere.
  */
-Worker start_worker(int operator_pd, int worker_id, char* output_dir, char* history_file_path);
+Worker start_worker(Ring operator_ring, WorkerClaims claims, int worker_id, char* output_dir, CpuList cpus);
 
 #endif
\ No newline at end of file
@@ -7,16 +7,18 @@
 
 enum WorkerDatagramMode {
     WORKER_DATAGRAM_MODE_NONE,
-    WORKER_DATAGRAM_MODE_STATUS_REQUEST,
+    WORKER_DATAGRAM_MODE_STATUS_REQUEST, // No longer sent. Status requests are answered from the status snapshot.
     WORKER_DATAGRAM_MODE_EXECUTE_REQUEST,
     WORKER_DATAGRAM_MODE_SHUTDOWN_REQUEST,
-    WORKER_DATAGRAM_MODE_COMPLETION_RESPONSE
+    WORKER_DATAGRAM_MODE_COMPLETION_RESPONSE,
+    WORKER_DATAGRAM_MODE_SKIPPED_RESPONSE // A Completion Response for a prefetched task the operator stole back.
 };
 
 typedef struct worker_datagram_header {
-    uint8_t mode; // The mode for this datagram. See WorkerDatagramMode.
-    uint8_t type; // The type for this datagram. See DatagramType.
-    int task_id;  // The id of the current task.
+    uint8_t mode;    // The mode for this datagram. See WorkerDatagramMode.
+    uint8_t type;    // The type for this datagram. See DatagramType.
+    int task_id;     // The id of the current task.
+    uint32_t length; // The size of the whole datagram, header included, so that it can be framed without its mode.
 } WORKER_DATAGRAM_HEADER, *WorkerDatagramHeader;
 
 /**
@@ -26,32 +28,29 @@ typedef struct worker_datagram {
     WORKER_DATAGRAM_HEADER header;
 } *WorkerDatagram;
 
-typedef struct worker_status_payload {
-    int task_id;
-    char data[EXECUTE_REQUEST_DATAGRAM_PAYLOAD_LEN + 1];
-} WORKER_STATUS_PAYLOAD, *WorkerStatusPayload;
-
-typedef struct worker_status_request_datagram {
-    WORKER_DATAGRAM_HEADER header; // Header for this datagram. Mode must be set to WORKER_DATAGRAM_MODE_STATUS_REQUEST.
-    int num_clients;
-    int* clients;
-    int num_tasks_queued;
-    int num_tasks;
-    WorkerStatusPayload* tasks;
-} WORKER_STATUS_REQUEST_DATAGRAM, *WorkerStatusRequestDatagram;
-
 typedef struct worker_execute_request_datagram {
     WORKER_DATAGRAM_HEADER header; // Header for this datagram. Mode must be set to WORKER_DATAGRAM_MODE_EXECUTE_REQUEST.
-    char data[EXECUTE_REQUEST_DATAGRAM_PAYLOAD_LEN + 1]; // The task to be executed.
+    uint32_t data_len; // The length of the task. The task is only null-terminated in memory, not on the pipe.
+    uint32_t timeout;  // The longest the task may run for, in milliseconds, or 0 if it may run for as long as it takes.
+    char data[];       // The task to be executed.
 } WORKER_EXECUTE_REQUEST_DATAGRAM, *WorkerExecuteRequestDatagram;
 
+/**
+ * @brief Returns the size of a Worker Execute Request Datagram as written to a worker, task included.
+ * @param dg A pointer to a WORKER_EXECUTE_REQUEST_DATAGRAM.
+ */
+#define WORKER_EXECUTE_REQUEST_DATAGRAM_SIZE(dg) (sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM) + (dg)->data_len)
+
 typedef struct worker_shutdown_request_datagram {
     WORKER_DATAGRAM_HEADER header; // Header for this datagram. Mode must be set to WORKER_DATAGRAM_MODE_SHUTDOWN_REQUEST.
 } WORKER_SHUTDOWN_REQUEST_DATAGRAM, *WorkerShutdownRequestDatagram;
 
 typedef struct worker_completion_response_datagram {
     WORKER_DATAGRAM_HEADER header; // Header for this datagram. Mode must be set to WORKER_DATAGRAM_MODE_COMPLETION_RESPONSE.
-    uint8_t worker_id;
+    int32_t worker_id;   // The slot of the worker, which may be any of the slots of every priority class.
+    uint32_t cpu_time;   // The CPU time the task used, user and system, in milliseconds.
+    uint8_t timed_out;   // Whether the task was killed for running past its timeout.
+    int32_t exit_status; // The exit status of the last stage of the task, or 128 plus the signal that killed it.
 } WORKER_COMPLETION_RESPONSE_DATAGRAM, *WorkerCompletionResponseDatagram;
 
 /**
@@ -66,23 +65,22 @@ WORKER_DATAGRAM_HEADER create_worker_datagram_header();
 WORKER_DATAGRAM_HEADER read_worker_datagram_header(int fd);
 
 /**
- * @brief Creates a new empty Worker Status Request Datagram.
+ * @brief Returns the size of the datagram at the start of a buffer, as framed by its header.
+ *
+ * @param buf The buffer holding the datagram.
+ * @param len The number of bytes in the buffer.
+ *
+ * @return The size of the datagram, 0 if the buffer does not hold its header yet, or -1 if the header is malformed.
  */
-WorkerStatusRequestDatagram create_worker_status_request_datagram(int num_clients, int* clients, int num_tasks_queued, int num_tasks, WorkerStatusPayload* tasks);
+ssize_t get_worker_datagram_size(const void* buf, size_t len);
 
 /**
- * @brief Reads a Worker Status Request Datagram from a file descriptor, or NULL if it fails. This version should be 
- * called after reading the header of a datagram, for distinguishing the datagram mode.
+ * @brief Creates a new Worker Execute Request Datagram for a task. The task is copied.
  * 
- * @param fd     The file descriptor to read.
- * @param header The already read header.
+ * @param data     The task to be executed. Does not need to be null-terminated.
+ * @param data_len The length of the task.
  */
-WorkerStatusRequestDatagram read_partial_worker_status_request_datagram(int fd, WORKER_DATAGRAM_HEADER header);
-
-/**
- * @brief Creates a new empty Worker Execute Request Datagram.
- */
-WorkerExecuteRequestDatagram create_worker_execute_request_datagram();
+WorkerExecuteRequestDatagram create_worker_execute_request_datagram(char* data, uint32_t data_len);
 
 /**
  * @brief Reads a Worker Execute Request Datagram from a file descriptor, or NULL if it fails. This version should be 
@@ -93,6 +91,15 @@ WorkerExecuteRequestDatagram create_worker_execute_request_datagram();
  */
 WorkerExecuteRequestDatagram read_partial_worker_execute_request_datagram(int fd, WORKER_DATAGRAM_HEADER header);
 
+/**
+ * @brief Unpacks a Worker Execute Request Datagram from a whole frame, or NULL if it is malformed. The task is copied
+ * and null-terminated.
+ * 
+ * @param buf  The frame, as written to the worker.
+ * @param size The size of the frame.
+ */
+WorkerExecuteRequestDatagram unpack_worker_execute_request_datagram(const void* buf, size_t size);
+
 /**
  * @brief Creates a new empty Worker Shutdown Request Datagram.
  */
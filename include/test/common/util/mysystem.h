@@ -0,0 +1,9 @@
+#ifndef TEST_COMMON_UTIL_MYSYSTEM_H
+#define TEST_COMMON_UTIL_MYSYSTEM_H
+
+/**
+ * @brief Tests the command execution functions.
+ */
+void test_mysystem();
+
+#endif
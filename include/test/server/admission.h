@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_ADMISSION_H
+#define TEST_SERVER_ADMISSION_H
+
+/**
+ * @brief Tests the Admission Control functions.
+ */
+void test_admission();
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_BACKLOG_H
+#define TEST_SERVER_BACKLOG_H
+
+/**
+ * @brief Tests the Backlog functions.
+ */
+void test_backlog();
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_CLAIMS_H
+#define TEST_SERVER_CLAIMS_H
+
+/**
+ * @brief Tests the Worker Claims functions.
+ */
+void test_claims();
+
+#endif
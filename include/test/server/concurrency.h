@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_CONCURRENCY_H
+#define TEST_SERVER_CONCURRENCY_H
+
+/**
+ * @brief Tests the Concurrency Limit functions.
+ */
+void test_concurrency();
+
+#endif
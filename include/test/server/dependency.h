@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_DEPENDENCY_H
+#define TEST_SERVER_DEPENDENCY_H
+
+/**
+ * @brief Tests the Dependency Graph functions.
+ */
+void test_dependency_graph();
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_ESTIMATOR_H
+#define TEST_SERVER_ESTIMATOR_H
+
+/**
+ * @brief Tests the Runtime Estimator functions.
+ */
+void test_estimator();
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_FAIR_QUEUE_H
+#define TEST_SERVER_FAIR_QUEUE_H
+
+/**
+ * @brief Tests the Fair Queue functions.
+ */
+void test_fair_queue();
+
+#endif
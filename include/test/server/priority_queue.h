@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_PRIORITY_QUEUE_H
+#define TEST_SERVER_PRIORITY_QUEUE_H
+
+/**
+ * @brief Tests the Priority Queue functions.
+ */
+void test_priority_queue();
+
+#endif
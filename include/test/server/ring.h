@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_RING_H
+#define TEST_SERVER_RING_H
+
+/**
+ * @brief Tests the Message Ring functions.
+ */
+void test_ring();
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_SNAPSHOT_H
+#define TEST_SERVER_SNAPSHOT_H
+
+/**
+ * @brief Tests the Status Snapshot functions.
+ */
+void test_snapshot();
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef TEST_SERVER_TOPOLOGY_H
+#define TEST_SERVER_TOPOLOGY_H
+
+/**
+ * @brief Tests the CPU Topology functions.
+ */
+void test_topology();
+
+#endif
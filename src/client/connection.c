@@ -0,0 +1,141 @@
+/******************************************************************************
+ *                            CLIENT CONNECTION                               *
+ *                                                                            *
+ *   The Client Connection module hides the transport used to reach the      *
+ * server from the client modes.                                              *
+ *   The transport is chosen through the ORCHESTRATOR_TRANSPORT environment   *
+ * variable. If it is unset, the socket is attempted first, falling back to   *
+ * the server FIFO if no server is listening on it.                           *
+ ******************************************************************************/
+
+#include <sys/socket.h>
+#include <errno.h>
+#include "client/connection.h"
+#include "common/io/io.h"
+#include "common/io/fifo.h"
+#include "common/io/socket.h"
+#include "common/datagram/execute.h"
+#include "common/util/alloc.h"
+
+/**
+ * @brief Opens a connection through the server FIFO, waiting for a server if none is open yet.
+ */
+static int open_fifo_connection(ClientConnection connection) {
+    #define ERR 1
+    char* client_fifo_name = isnprintf(CLIENT_FIFO "%d", getpid());
+    connection->client_fifo_path = join_paths(2, "build/", client_fifo_name);
+    free(client_fifo_name);
+
+    if (SAFE_FIFO_SETUP(connection->client_fifo_path, 0600) == -1) return ERR;
+
+    // Opening the client FIFO for both reading and writing keeps it open across every response, and keeps the
+    // server from blocking on it.
+    connection->response_fd = SAFE_OPEN(connection->client_fifo_path, O_RDWR, 0600);
+
+    char* server_fifo_path = join_paths(2, "build/", SERVER_FIFO);
+    connection->request_fd = SAFE_OPEN(server_fifo_path, O_WRONLY, 0600);
+    free(server_fifo_path);
+
+    return 0;
+    #undef ERR
+}
+
+ClientConnection open_client_connection() {
+    #define ERR NULL
+    ClientConnection connection = SAFE_ALLOC(ClientConnection, sizeof(CLIENT_CONNECTION));
+    connection->request_fd = -1;
+    connection->response_fd = -1;
+
+    char* transport = getenv(TRANSPORT_ENV);
+    if (transport == NULL || STRING_EQUAL(transport, "socket")) {
+        int fd = connect_server_socket();
+        if (fd != -1) {
+            connection->request_fd = fd;
+            connection->response_fd = fd;
+            connection->is_socket = 1;
+
+            return connection;
+        }
+
+        if (transport != NULL) {
+            perror("ERROR! Unable to connect to server socket");
+            goto err;
+        }
+    } else if (!STRING_EQUAL(transport, "fifo")) {
+        fprintf(stderr, "ERROR! Invalid transport '%s'. Expected 'fifo' or 'socket'.\n", transport);
+        goto err;
+    }
+
+    if (open_fifo_connection(connection) != 0) goto err;
+
+    return connection;
+
+    err: {
+        close_client_connection(connection);
+        return ERR;
+    }
+    #undef ERR
+}
+
+int send_request(ClientConnection connection, void* request, size_t size) {
+    struct iovec iov = { .iov_base = request, .iov_len = size };
+    return send_request_vector(connection, &iov, 1);
+}
+
+int send_request_vector(ClientConnection connection, const struct iovec* iov, int iovcnt) {
+    #define ERR 1
+    // Each datagram must be sent as a single message, or a single atomic write to the FIFO, so the whole datagram goes
+    // in a single call.
+    ssize_t sent;
+    if (connection->is_socket) {
+        struct msghdr msg = { .msg_iov = (struct iovec*)iov, .msg_iovlen = iovcnt };
+        do {
+            sent = sendmsg(connection->request_fd, &msg, MSG_NOSIGNAL);
+        } while (sent == -1 && errno == EINTR);
+    } else {
+        do {
+            sent = writev(connection->request_fd, iov, iovcnt);
+        } while (sent == -1 && errno == EINTR);
+    }
+
+    if (sent == -1) {
+        perror(ERROR_STR_HEADER "Unable to send request");
+        return ERR;
+    }
+
+    return 0;
+    #undef ERR
+}
+
+size_t get_max_execute_payload_len(ClientConnection connection) {
+    return connection->is_socket 
+        ? EXECUTE_REQUEST_DATAGRAM_MAX_PAYLOAD_LEN 
+        : EXECUTE_REQUEST_DATAGRAM_FIFO_MAX_PAYLOAD_LEN;
+}
+
+void* receive_message(ClientConnection connection) {
+    void* message = NULL;
+    ssize_t size = recv_message(connection->response_fd, &message, 0);
+    if (size <= 0) {
+        if (size == 0) fprintf(stderr, "ERROR! Server closed the connection.\n");
+        else perror("ERROR! Unable to receive response");
+
+        return NULL;
+    }
+
+    return message;
+}
+
+void close_client_connection(ClientConnection connection) {
+    if (connection == NULL) return;
+
+    if (connection->request_fd != -1) close(connection->request_fd);
+    if (!connection->is_socket && connection->response_fd != -1) close(connection->response_fd);
+
+    if (connection->client_fifo_path != NULL) {
+        unlink(connection->client_fifo_path);
+        free(connection->client_fifo_path);
+    }
+
+    free(connection);
+}
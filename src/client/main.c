@@ -8,69 +8,168 @@
  * instance without any significant lag or errors.                            *
  ******************************************************************************/
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <common/io/io.h>
-#include <common/io/fifo.h>
+#include <client/connection.h>
+#include <client/session.h>
 #include <common/datagram/datagram.h>
 #include <common/datagram/execute.h>
 #include <common/datagram/status.h>
 #include "common/util/string.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief The most tasks a single task may depend on.
+ */
+#define CLIENT_MAX_DEPENDENCIES 64
+
+/**
+ * @brief The shortest wait before retrying a request the server was too busy for, in milliseconds. Doubled on every
+ * attempt, unless the server asked for longer.
+ */
+#define CLIENT_RETRY_BASE 50
+
+/**
+ * @brief The longest wait before retrying a request the server was too busy for, in milliseconds.
+ */
+#define CLIENT_RETRY_MAX 5000
+
+/**
+ * @brief The most times a request the server was too busy for is retried before giving up.
+ */
+#define CLIENT_MAX_RETRIES 10
+
+/**
+ * @brief Parses the comma-separated list of tasks a task depends on, as given to --after. Positive values are ids of
+ * tasks queued before, and negative ones count entries back within the same batch.
+ *
+ * @return The number of dependencies, or -1 if the list is malformed or too long.
+ */
+static int parse_task_dependencies(const char* list, int32_t* dependencies) {
+    int num_dependencies = 0;
+    while (*list != '\0') {
+        char* end = NULL;
+        long dependency = strtol(list, &end, 10);
+        if (end == list || dependency == 0 || num_dependencies == CLIENT_MAX_DEPENDENCIES) return -1;
+
+        dependencies[num_dependencies++] = dependency;
+        list = end;
+        if (*list == ',') list++;
+        else if (*list != '\0') return -1;
+    }
+
+    return num_dependencies;
+}
+
+/**
+ * @brief Turns the dependencies of a task on entries of batches already sent into the ids those entries got.
+ *
+ * @param dependencies     The tasks the task depends on.
+ * @param num_dependencies The number of dependencies.
+ * @param position         The position of the task in the batch it is about to be appended to.
+ * @param last_id          The id of the last task sent, or 0 if none was.
+ */
+static void resolve_task_dependencies(int32_t* dependencies, int num_dependencies, int position, int last_id) {
+    for (int i = 0; i < num_dependencies; i++) {
+        if (dependencies[i] >= 0 || -dependencies[i] <= position || last_id == 0) continue;
+        dependencies[i] = last_id - (-dependencies[i] - position) + 1;
+    }
+}
+
+/**
+ * @brief Waits before retrying a request the server was too busy for. The wait grows exponentially with every attempt,
+ * is never shorter than what the server asked for, and is jittered so that clients refused together do not all retry
+ * at once.
+ *
+ * @param retry_after How long the server asked to wait, in milliseconds.
+ * @param attempt     The number of attempts already refused.
+ *
+ * @return 0 once it waited, or -1 if the request should not be retried anymore.
+ */
+static int wait_to_retry(uint32_t retry_after, int attempt) {
+    if (attempt >= CLIENT_MAX_RETRIES) {
+        fprintf(stderr, "ERROR! Server still busy after %d attempts. Giving up.\n", attempt);
+        return -1;
+    }
+
+    uint32_t wait = CLIENT_RETRY_BASE << attempt;
+    if (wait < retry_after) wait = retry_after;
+    if (wait > CLIENT_RETRY_MAX) wait = CLIENT_RETRY_MAX;
+
+    // Wait anywhere between half and all of it.
+    wait = wait / 2 + rand() % (wait / 2 + 1);
+    printf("Server busy. Retrying in %ums.\n", wait);
+
+    struct timespec delay = { .tv_sec = wait / 1000, .tv_nsec = (wait % 1000) * 1000000L };
+    nanosleep(&delay, NULL);
+    return 0;
+}
 
 int main(int argc, char const *argv[]) {
     #define ERR 1
     printf("Hello world from client!\n\n");
+    srand(getpid() ^ time(NULL));
 
-    if(argc == 2) {
-        char* mode = (char*) argv[1];
-
-        if(!strcmp("status", mode)) {
+    if(argc >= 2 && argc <= 4 && !strcmp("status", argv[1])) {
 
-            char* client_fifo_name = isnprintf(CLIENT_FIFO "%d", getpid());
-            char* client_fifo_path = join_paths(2, "build/", client_fifo_name);
-            SAFE_FIFO_SETUP(client_fifo_path, 0600);
+        StatusRequestDatagram request = create_status_request_datagram();
+        if (set_status_request_filter(request, argc - 2, (char* const*)argv + 2) != 0) {
+            fprintf(stderr, "ERROR! Expected 'status [queued|running|completed [N]|wait|workers]'.\n");
+            exit(EXIT_FAILURE);
+        }
 
-            char* server_fifo_path = join_paths(2, "build/", SERVER_FIFO);
-            int server_fifo_fd = SAFE_OPEN(server_fifo_path, O_WRONLY, 0600);
+        ClientConnection connection = open_client_connection();
+        if (connection == NULL) exit(EXIT_FAILURE);
 
-            StatusRequestDatagram request = create_status_request_datagram();
-            
-            #ifdef DEBUG
-            char* req_str = status_request_datagram_to_string(request, 1);
-            DEBUG_PRINT("[DEBUG] Sending request with %ld bytes:\n%s\n", sizeof(STATUS_REQUEST_DATAGRAM), req_str);
-            free(req_str);
-            #endif
-            
-            SAFE_WRITE(server_fifo_fd, request, sizeof(STATUS_REQUEST_DATAGRAM));
+        #ifdef DEBUG
+        char* req_str = status_request_datagram_to_string(request, 1);
+        DEBUG_PRINT("[DEBUG] Sending request with %ld bytes:\n%s\n", sizeof(STATUS_REQUEST_DATAGRAM), req_str);
+        free(req_str);
+        #endif
+        
+        if (send_request(connection, request, sizeof(STATUS_REQUEST_DATAGRAM)) != 0) exit(EXIT_FAILURE);
 
-            int client_fifo_fd = SAFE_OPEN(client_fifo_path, O_RDONLY, 0600);
-            StatusResponseDatagram response = read_status_response_datagram(client_fifo_fd);
+        // The report arrives in chunks. Each one is printed as soon as it arrives.
+        uint8_t last = 0;
+        while (!last) {
+            StatusResponseDatagram response = RECEIVE_RESPONSE(connection, read_status_response_datagram);
+            if (response == NULL) exit(EXIT_FAILURE);
 
             DEBUG_PRINT("[DEBUG] Printing payload with %d bytes.\n", response->payload_len);
-            printf("%s", response->payload);
-
-            close(client_fifo_fd);
-            unlink(client_fifo_path);
-            free(client_fifo_path);
-            free(client_fifo_name);
-            close(server_fifo_fd);
-            free(server_fifo_path);
-            
-        } else if(!strcmp("close", mode)) {
-            
-            char* client_fifo_name = isnprintf(CLIENT_FIFO "%d", getpid());
-            char* client_fifo_path = join_paths(2, "build/", client_fifo_name);
-            SAFE_FIFO_SETUP(client_fifo_path, 0600);
+            fwrite(response->payload, 1, response->payload_len, stdout);
+            fflush(stdout);
+
+            last = response->last;
+            free(response);
+        }
 
-            char* server_fifo_path = join_paths(2, "build/", SERVER_FIFO);
-            int server_fifo_fd = SAFE_OPEN(server_fifo_path, O_WRONLY, 0600);
+        free(request);
+        close_client_connection(connection);
+
+    } else if(argc == 2) {
+        char* mode = (char*) argv[1];
+
+        if(!strcmp("close", mode)) {
+            
+            ClientConnection connection = open_client_connection();
+            if (connection == NULL) exit(EXIT_FAILURE);
 
             DATAGRAM_HEADER request = create_datagram_header();
             request.mode = DATAGRAM_MODE_CLOSE_REQUEST;
-            SAFE_WRITE(server_fifo_fd, &request, sizeof(DATAGRAM_HEADER));
+            if (send_request(connection, &request, sizeof(DATAGRAM_HEADER)) != 0) exit(EXIT_FAILURE);
 
-            int client_fifo_fd = SAFE_OPEN(client_fifo_path, O_RDONLY, 0600);
-            DATAGRAM_HEADER response = read_datagram_header(client_fifo_fd);
+            DATAGRAM_HEADER response = { 0 };
+            if (connection->is_socket) {
+                DatagramHeader message = receive_message(connection);
+                if (message != NULL) response = *message;
+                free(message);
+            } else {
+                response = read_datagram_header(connection->response_fd);
+            }
 
             if(response.mode == DATAGRAM_MODE_CLOSE_RESPONSE) {
                 printf("Server shutdown request sucessfully sent.\n");
@@ -78,18 +177,183 @@ int main(int argc, char const *argv[]) {
                 printf("Server shutdown request was not received.\n");
             }
 
-            close(client_fifo_fd);
-            unlink(client_fifo_path);
-            free(client_fifo_path);
-            free(client_fifo_name);
-            close(server_fifo_fd);
-            free(server_fifo_path);
+            close_client_connection(connection);
+
+        } else if(!strcmp("session", mode)) {
+
+            // Commands are read one per line from stdin, and pipelined through a single connection.
+            ClientConnection connection = open_client_connection();
+            if (connection == NULL) exit(EXIT_FAILURE);
+
+            int status = run_session(connection, STDIN_FILENO);
+            close_client_connection(connection);
+
+            if (status != 0) exit(EXIT_FAILURE);
 
         } else {
             printf("Invalid mode. Try again later.\n");
             exit(EXIT_FAILURE);
         }
-    } else if(argc == 5) {
+    } else if(argc == 3) {
+        char* mode = (char*) argv[1];
+
+        if(!strcmp("execute-batch", mode)) {
+
+            // Tasks are read one per line, as "<time> <-u|-p> [--priority=<class>] [--after=<tasks>] <task>". A file of
+            // "-" reads the tasks from stdin.
+            FILE* tasks_file = (!strcmp("-", argv[2])) ? stdin : fopen(argv[2], "r");
+            if (tasks_file == NULL) {
+                perror("ERROR! Unable to open tasks file");
+                exit(EXIT_FAILURE);
+            }
+
+            // A single connection is kept open across every batch.
+            ClientConnection connection = open_client_connection();
+            if (connection == NULL) exit(EXIT_FAILURE);
+
+            ExecuteBatchRequestDatagram request = create_execute_batch_request_datagram();
+
+            char* line = NULL;
+            size_t line_cap = 0;
+            ssize_t line_len = 0;
+            int line_num = 0;
+            int last_id = 0;
+            int done = 0;
+            while (!done) {
+                line_len = getline(&line, &line_cap, tasks_file);
+                done = (line_len == -1);
+
+                char* task = NULL;
+                short int time = 0;
+                uint8_t type = DATAGRAM_TYPE_UNIQUE;
+                uint8_t priority = TASK_PRIORITY_NORMAL;
+                int32_t dependencies[CLIENT_MAX_DEPENDENCIES];
+                int num_dependencies = 0;
+                if (!done) {
+                    line_num++;
+                    if (line[line_len - 1] == '\n') line[--line_len] = '\0';
+
+                    char* rest = NULL;
+                    time = strtol(line, &rest, 10);
+                    while (*rest == ' ') rest++;
+                    if (*rest == '\0' || *rest == '#' || rest == line) continue;
+
+                    type = (STRING_BEGIN_EQUAL("-u", rest, 2)) ? DATAGRAM_TYPE_UNIQUE : DATAGRAM_TYPE_PIPELINE;
+                    task = rest + 2;
+                    while (*task == ' ') task++;
+
+                    // Options come before the task itself.
+                    int invalid = 0;
+                    while (!invalid && STRING_BEGIN_EQUAL("--", task, 2)) {
+                        char* option = task;
+                        task = strchr(task, ' ');
+                        if (task == NULL) task = option + strlen(option);
+                        else *task++ = '\0';
+                        while (*task == ' ') task++;
+
+                        if (STRING_BEGIN_EQUAL("--after=", option, 8)) {
+                            num_dependencies = parse_task_dependencies(option + 8, dependencies);
+                            invalid = (num_dependencies == -1);
+                        } else if (STRING_BEGIN_EQUAL("--priority=", option, 11)) {
+                            int class = parse_task_priority(option + 11);
+                            priority = class;
+                            invalid = (class == -1);
+                        } else {
+                            invalid = 1;
+                        }
+                    }
+                    if (invalid) {
+                        fprintf(stderr, "ERROR! Task on line %d has an invalid option. Skipping.\n", line_num);
+                        continue;
+                    }
+
+                    size_t task_len = strlen(task);
+                    if(
+                        sizeof(EXECUTE_BATCH_REQUEST_DATAGRAM) + EXECUTE_BATCH_ENTRY_SIZE(task_len, num_dependencies) 
+                            > EXECUTE_BATCH_REQUEST_DATAGRAM_MAX_SIZE
+                    ) {
+                        fprintf(stderr, "ERROR! Task on line %d does not fit in a batch. Skipping.\n", line_num);
+                        continue;
+                    }
+
+                    resolve_task_dependencies(dependencies, num_dependencies, request->num_tasks, last_id);
+                    if (
+                        append_execute_batch_request_datagram(
+                            request, 
+                            time, 
+                            type, 
+                            priority, 
+                            task, 
+                            dependencies, 
+                            num_dependencies
+                        ) == 0
+                    ) continue;
+                }
+
+                // The batch is full or there are no more tasks. Send it and wait for the identifiers.
+                if (request->num_tasks > 0) {
+                    #ifdef DEBUG
+                    char* req_str = execute_batch_request_datagram_to_string(request, 1);
+                    DEBUG_PRINT("[DEBUG] Sending request with %ld bytes:\n%s\n", EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(request), req_str);
+                    free(req_str);
+                    #endif
+
+                    ExecuteBatchResponseDatagram response = NULL;
+                    for (int attempt = 0; ; attempt++) {
+                        if (send_request(connection, request, EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(request)) != 0) {
+                            exit(EXIT_FAILURE);
+                        }
+
+                        response = RECEIVE_RESPONSE(connection, read_execute_batch_response_datagram);
+                        if (response == NULL) exit(EXIT_FAILURE);
+                        if (response->status != EXECUTE_STATUS_BUSY) break;
+
+                        uint32_t retry_after = response->retry_after;
+                        free(response);
+                        if (wait_to_retry(retry_after, attempt) != 0) exit(EXIT_FAILURE);
+                    }
+                    if (response->status == EXECUTE_STATUS_INVALID) {
+                        fprintf(stderr, "ERROR! Server rejected the batch as malformed.\n");
+                        exit(EXIT_FAILURE);
+                    }
+
+                    printf(
+                        "Tasks queued with identifiers %d to %d.\n", 
+                        response->first_taskid, 
+                        response->first_taskid + response->num_tasks - 1
+                    );
+                    last_id = response->first_taskid + response->num_tasks - 1;
+                    free(response);
+
+                    request->num_tasks = 0;
+                    request->payload_len = 0;
+                }
+
+                if (task != NULL) {
+                    resolve_task_dependencies(dependencies, num_dependencies, request->num_tasks, last_id);
+                    append_execute_batch_request_datagram(
+                        request, 
+                        time, 
+                        type, 
+                        priority, 
+                        task, 
+                        dependencies, 
+                        num_dependencies
+                    );
+                }
+            }
+
+            free(line);
+            free(request);
+            if (tasks_file != stdin) fclose(tasks_file);
+
+            close_client_connection(connection);
+
+        } else {
+            printf("Invalid mode. Try again later.\n");
+            exit(EXIT_FAILURE);
+        }
+    } else if(argc >= 5 && argc <= 7) {
         char* mode = (char*) argv[1];
 
         if(!strcmp("execute", mode)) {
@@ -97,42 +361,121 @@ int main(int argc, char const *argv[]) {
             short int time = (atoi(argv[2]));
             char* type = (char*) argv[3];
             char* data = (char*) argv[4];
-            if(strlen(data) > 300) {
-                perror("ERROR! Arguments passed to execute mode exceeds 300 bytes.\n");
-                exit(EXIT_FAILURE);
+            size_t data_len = strlen(data);
+
+            // The priority and the tasks it depends on may come in any order.
+            int priority = TASK_PRIORITY_NORMAL;
+            int32_t dependencies[CLIENT_MAX_DEPENDENCIES];
+            int num_dependencies = 0;
+            for (int i = 5; i < argc; i++) {
+                if (STRING_BEGIN_EQUAL("--after=", argv[i], 8)) {
+                    num_dependencies = parse_task_dependencies(argv[i] + 8, dependencies);
+                    if (num_dependencies == -1) {
+                        fprintf(stderr, "ERROR! Expected '--after=<id>[,<id>...]', with at most %d ids.\n", CLIENT_MAX_DEPENDENCIES);
+                        exit(EXIT_FAILURE);
+                    }
+                } else {
+                    priority = parse_task_priority(argv[i]);
+                    if (priority == -1) {
+                        fprintf(stderr, "ERROR! Expected a priority of 'low', 'normal' or 'high'.\n");
+                        exit(EXIT_FAILURE);
+                    }
+                }
             }
 
-            char* client_fifo_name = isnprintf(CLIENT_FIFO "%d", getpid());
-            char* client_fifo_path = join_paths(2, "build/", client_fifo_name);
-            SAFE_FIFO_SETUP(client_fifo_path, 0600);
+            ClientConnection connection = open_client_connection();
+            if (connection == NULL) exit(EXIT_FAILURE);
+
+            // Only batch entries carry dependencies, so a dependent task is sent as a batch of its own.
+            if (num_dependencies > 0) {
+                ExecuteBatchRequestDatagram request = create_execute_batch_request_datagram();
+                int appended = append_execute_batch_request_datagram(
+                    request, 
+                    time, 
+                    (!strcmp("-u", type)) ? DATAGRAM_TYPE_UNIQUE : DATAGRAM_TYPE_PIPELINE, 
+                    priority, 
+                    data, 
+                    dependencies, 
+                    num_dependencies
+                );
+                if (appended != 0) {
+                    fprintf(stderr, "ERROR! Arguments passed to execute mode do not fit in a batch.\n");
+                    exit(EXIT_FAILURE);
+                }
 
-            char* server_fifo_path = join_paths(2, "build/", SERVER_FIFO);
-            int server_fifo_fd = SAFE_OPEN(server_fifo_path, O_WRONLY, 0600);
+                ExecuteBatchResponseDatagram response = NULL;
+                for (int attempt = 0; ; attempt++) {
+                    if (send_request(connection, request, EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(request)) != 0) {
+                        exit(EXIT_FAILURE);
+                    }
 
-            ExecuteRequestDatagram request = create_execute_request_datagram();
+                    response = RECEIVE_RESPONSE(connection, read_execute_batch_response_datagram);
+                    if (response == NULL) exit(EXIT_FAILURE);
+                    if (response->status != EXECUTE_STATUS_BUSY) break;
+
+                    uint32_t retry_after = response->retry_after;
+                    free(response);
+                    if (wait_to_retry(retry_after, attempt) != 0) exit(EXIT_FAILURE);
+                }
+                if (response->status == EXECUTE_STATUS_INVALID) {
+                    fprintf(stderr, "ERROR! Server rejected the batch as malformed.\n");
+                    exit(EXIT_FAILURE);
+                }
+
+                printf("Task queued with identifier %d.\n", response->first_taskid);
+
+                free(response);
+                free(request);
+                close_client_connection(connection);
+                return 0;
+            }
+
+            if(data_len > get_max_execute_payload_len(connection)) {
+                fprintf(
+                    stderr, 
+                    "ERROR! Arguments passed to execute mode exceed %zu bytes.\n", 
+                    get_max_execute_payload_len(connection)
+                );
+                exit(EXIT_FAILURE);
+            }
+
+            // Only the fixed part of the datagram is allocated. The command is sent straight from the arguments.
+            ExecuteRequestDatagram request = create_execute_request_datagram(NULL, data_len);
             request->header.type = (!strcmp("-u", type)) ? DATAGRAM_TYPE_UNIQUE : DATAGRAM_TYPE_PIPELINE;
             request->time = time;
-            memcpy(request->data, data, strlen(data));
+            request->priority = priority;
 
-            #ifdef DEBUG
-            char* req_str = execute_request_datagram_to_string(request, 1, 0);
-            DEBUG_PRINT("[DEBUG] Sending request with %ld bytes:\n%s\n", sizeof(EXECUTE_REQUEST_DATAGRAM), req_str);
-            free(req_str);
-            #endif
+            DEBUG_PRINT(
+                "[DEBUG] Sending request with %ld bytes: time: %d, priority: %d, data_len: %d, data: '%s'\n", 
+                EXECUTE_REQUEST_DATAGRAM_SIZE(request), 
+                request->time,
+                request->priority,
+                request->data_len,
+                data
+            );
 
-            SAFE_WRITE(server_fifo_fd, request, sizeof(EXECUTE_REQUEST_DATAGRAM));
+            struct iovec iov[] = {
+                { .iov_base = request, .iov_len = sizeof(EXECUTE_REQUEST_DATAGRAM) },
+                { .iov_base = data, .iov_len = data_len }
+            };
+            ExecuteResponseDatagram response = NULL;
+            for (int attempt = 0; ; attempt++) {
+                if (send_request_vector(connection, iov, 2) != 0) exit(EXIT_FAILURE);
 
-            int client_fifo_fd = SAFE_OPEN(client_fifo_path, O_RDONLY, 0600);
-            ExecuteResponseDatagram response = read_execute_response_datagram(client_fifo_fd);
+                response = RECEIVE_RESPONSE(connection, read_execute_response_datagram);
+                if (response == NULL) exit(EXIT_FAILURE);
+                if (response->status != EXECUTE_STATUS_BUSY) break;
+
+                uint32_t retry_after = response->retry_after;
+                free(response);
+                if (wait_to_retry(retry_after, attempt) != 0) exit(EXIT_FAILURE);
+            }
 
             printf("Task queued with identifier %d.\n", response->taskid);
 
-            close(client_fifo_fd);
-            unlink(client_fifo_path);
-            free(client_fifo_path);
-            free(client_fifo_name);
-            close(server_fifo_fd);
-            free(server_fifo_path);
+            free(response);
+            free(request);
+            close_client_connection(connection);
 
         } else {
             printf("Invalid mode. Try again later.\n");
@@ -140,7 +483,10 @@ int main(int argc, char const *argv[]) {
     } else {
         printf("Insufficient arguments.\n"
             "Please provide the following parameters:\n"
-            "(execution_mode) [task_time] [task_type] [\"task\"]\n");
+            "(execution_mode) [task_time] [task_type] [\"task\"] [low|normal|high] [--after=<id>[,<id>...]]\n"
+            "status [queued|running|completed [N]|wait|workers]\n"
+            "execute-batch <tasks_file|->\n"
+            "session\n");
         exit(EXIT_FAILURE);
     }
 
@@ -0,0 +1,498 @@
+/******************************************************************************
+ *                              CLIENT SESSION                                *
+ *                                                                            *
+ *   The Client Session is a long-lived client mode, that keeps a single      *
+ * connection to the server open and reads commands from a file descriptor,   *
+ * usually the standard input, one per line.                                 *
+ *   Requests are pipelined: each request is tagged with a request id and    *
+ * sent without waiting for the response of the previous ones, up to a       *
+ * window of outstanding requests. Responses are matched to their requests   *
+ * by the request id echoed back by the server, as they arrive.              *
+ *   A task the server is too busy for keeps its place in the window, and no  *
+ * command is sent until a pause, growing with every refusal in a row,        *
+ * expires and the task was resent.                                           *
+ *                                                                            *
+ *   The accepted commands are:                                               *
+ *     execute <time> <-u|-p> <task>                                          *
+ *     status [queued|running|completed [N]|wait|workers]                     *
+ *     close                                                                  *
+ *   Blank lines and lines starting with '#' are ignored.                     *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <sys/socket.h>
+#include <poll.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include "client/session.h"
+#include "common/io/io.h"
+#include "common/io/socket.h"
+#include "common/datagram/datagram.h"
+#include "common/datagram/execute.h"
+#include "common/datagram/status.h"
+#include "common/util/string.h"
+#include "common/util/alloc.h"
+
+/**
+ * @brief Returns the slot of a request id.
+ */
+#define SESSION_SLOT_OF(session, request_id) (&(session)->slots[(request_id) % SESSION_WINDOW])
+
+/**
+ * @brief Returns the current time of the monotonic clock, in milliseconds.
+ */
+static uint64_t session_clock() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Checks whether the slot of the next request is free, meaning the window has room for another request.
+ */
+static inline int session_has_room(Session session) {
+    return SESSION_SLOT_OF(session, session->next_request_id)->mode == DATAGRAM_MODE_NONE;
+}
+
+#pragma region ======= REQUESTS =======
+/**
+ * @brief Sends a request, tagging it with the next request id and taking its slot.
+ *
+ * @param session The session.
+ * @param header  The header of the request, where the request id is written to.
+ * @param iov     The buffers that make up the request, in order.
+ * @param iovcnt  The number of buffers.
+ *
+ * @return 0 on success, 1 if it fails.
+ */
+static int send_session_request(Session session, DatagramHeader header, const struct iovec* iov, int iovcnt) {
+    uint32_t request_id = session->next_request_id;
+    header->request_id = request_id;
+
+    if (send_request_vector(session->connection, iov, iovcnt) != 0) {
+        session->server_gone = 1;
+        return 1;
+    }
+
+    SessionSlot slot = SESSION_SLOT_OF(session, request_id);
+    slot->request_id = request_id;
+    slot->mode = header->mode;
+    slot->line_num = session->line_num;
+    slot->streaming = 0;
+    slot->attempts = 0;
+    slot->retry = 0;
+
+    // Execute requests may be refused by a busy server, so a copy is kept to resend them.
+    if (header->mode == DATAGRAM_MODE_EXECUTE_REQUEST) {
+        slot->request_len = 0;
+        for (int i = 0; i < iovcnt; i++) slot->request_len += iov[i].iov_len;
+
+        slot->request = malloc(slot->request_len);
+        if (slot->request != NULL) {
+            size_t offset = 0;
+            for (int i = 0; i < iovcnt; i++) {
+                memcpy(slot->request + offset, iov[i].iov_base, iov[i].iov_len);
+                offset += iov[i].iov_len;
+            }
+        }
+    }
+
+    session->next_request_id++;
+    session->outstanding++;
+    return 0;
+}
+
+/**
+ * @brief Parses a single command and sends its request.
+ *
+ * @param session The session.
+ * @param line    The null-terminated command, without the line terminator.
+ */
+static void process_session_command(Session session, char* line) {
+    while (*line == ' ' || *line == '\t') line++;
+    if (*line == '\0' || *line == '#') return;
+
+    if (STRING_BEGIN_EQUAL("execute ", line, 8)) {
+        char* rest = NULL;
+        short int time = strtol(line + 8, &rest, 10);
+        while (*rest == ' ') rest++;
+
+        if (rest == line + 8 || (!STRING_BEGIN_EQUAL("-u ", rest, 3) && !STRING_BEGIN_EQUAL("-p ", rest, 3))) {
+            fprintf(stderr, "ERROR! Line %d: Expected 'execute <time> <-u|-p> <task>'.\n", session->line_num);
+            session->errors++;
+            return;
+        }
+
+        char* task = rest + 3;
+        while (*task == ' ') task++;
+        size_t task_len = strlen(task);
+
+        if (task_len == 0 || task_len > get_max_execute_payload_len(session->connection)) {
+            fprintf(
+                stderr,
+                "ERROR! Line %d: Task must have between 1 and %zu bytes.\n",
+                session->line_num,
+                get_max_execute_payload_len(session->connection)
+            );
+            session->errors++;
+            return;
+        }
+
+        // Only the fixed part of the datagram is built. The command is sent straight from the line.
+        EXECUTE_REQUEST_DATAGRAM request = { 0 };
+        request.header = create_datagram_header();
+        request.header.mode = DATAGRAM_MODE_EXECUTE_REQUEST;
+        request.header.type = (rest[1] == 'u') ? DATAGRAM_TYPE_UNIQUE : DATAGRAM_TYPE_PIPELINE;
+        request.time = time;
+        request.priority = TASK_PRIORITY_NORMAL;
+        request.data_len = task_len;
+
+        struct iovec iov[] = {
+            { .iov_base = &request, .iov_len = sizeof(EXECUTE_REQUEST_DATAGRAM) },
+            { .iov_base = task, .iov_len = task_len }
+        };
+        send_session_request(session, &request.header, iov, 2);
+    } else if (STRING_EQUAL("status", line) || STRING_BEGIN_EQUAL("status ", line, 7)) {
+        STATUS_REQUEST_DATAGRAM request = { .header = create_datagram_header() };
+        request.header.mode = DATAGRAM_MODE_STATUS_REQUEST;
+
+        // The filter takes at most two words. A third one is kept only to be rejected.
+        char* args[3];
+        int num_args = 0;
+        char* save = NULL;
+        for (char* word = strtok_r(line + 6, " \t", &save); word != NULL; word = strtok_r(NULL, " \t", &save)) {
+            args[num_args++] = word;
+            if (num_args == 3) break;
+        }
+
+        if (set_status_request_filter(&request, num_args, args) != 0) {
+            fprintf(
+                stderr, 
+                "ERROR! Line %d: Expected 'status [queued|running|completed [N]|wait|workers]'.\n", 
+                session->line_num
+            );
+            session->errors++;
+            return;
+        }
+
+        struct iovec iov = { .iov_base = &request, .iov_len = sizeof(STATUS_REQUEST_DATAGRAM) };
+        send_session_request(session, &request.header, &iov, 1);
+    } else if (STRING_EQUAL("close", line)) {
+        DATAGRAM_HEADER request = create_datagram_header();
+        request.mode = DATAGRAM_MODE_CLOSE_REQUEST;
+
+        struct iovec iov = { .iov_base = &request, .iov_len = sizeof(DATAGRAM_HEADER) };
+        send_session_request(session, &request, &iov, 1);
+    } else {
+        fprintf(stderr, "ERROR! Line %d: Unknown command '%s'.\n", session->line_num, line);
+        session->errors++;
+    }
+}
+
+/**
+ * @brief Resends every request the server was too busy for, oldest first.
+ */
+static void retry_session_requests(Session session) {
+    for (int i = 0; i < SESSION_WINDOW && !session->server_gone; i++) {
+        SessionSlot slot = SESSION_SLOT_OF(session, session->next_request_id + i);
+        if (slot->mode == DATAGRAM_MODE_NONE || !slot->retry) continue;
+
+        if (send_request(session->connection, slot->request, slot->request_len) != 0) {
+            session->server_gone = 1;
+            return;
+        }
+        slot->retry = 0;
+    }
+}
+
+/**
+ * @brief Sends a request for every complete command buffered, while the window has room for it. Requests the server
+ * was too busy for are resent first, once the session is no longer paused.
+ */
+static void process_session_input(Session session) {
+    ReadBuffer input = session->input;
+    if (session_clock() < session->paused_until) return;
+    retry_session_requests(session);
+
+    while (READ_BUFFER_LEN(input) > 0 && session_has_room(session) && !session->server_gone) {
+        char* line = (char*)READ_BUFFER_HEAD(input);
+        char* newline = memchr(line, '\n', READ_BUFFER_LEN(input));
+
+        size_t line_len;
+        if (newline != NULL) {
+            line_len = newline - line;
+        } else if (session->input_ended) {
+            line_len = READ_BUFFER_LEN(input);
+        } else if (input->start == 0 && input->end == input->cap) {
+            // A line that can not fit the buffer would stall the session forever.
+            fprintf(stderr, "ERROR! Line %d: Line exceeds %d bytes.\n", session->line_num + 1, SESSION_INPUT_BUFFER_SIZE);
+            session->errors++;
+            session->input_ended = 1;
+            clear_read_buffer(input);
+            return;
+        } else {
+            return;
+        }
+
+        session->line_num++;
+
+        // The line is terminated in place. A final line without a terminator is copied, as there may be no room for one.
+        if (newline != NULL) {
+            *newline = '\0';
+            if (line_len > 0 && line[line_len - 1] == '\r') line[line_len - 1] = '\0';
+            process_session_command(session, line);
+        } else {
+            char* copy = isnprintf("%.*s", (int)line_len, line);
+            if (copy != NULL) process_session_command(session, copy);
+            free(copy);
+        }
+
+        consume_read_buffer(input, line_len + (newline != NULL));
+    }
+}
+#pragma endregion
+
+#pragma region ======= RESPONSES =======
+/**
+ * @brief Matches a single response to its request, and displays it.
+ *
+ * @param session  The session.
+ * @param response The response.
+ * @param size     The size of the response.
+ */
+static void handle_session_response(Session session, const void* response, size_t size) {
+    DATAGRAM_HEADER header;
+    memcpy(&header, response, sizeof(DATAGRAM_HEADER));
+
+    SessionSlot slot = SESSION_SLOT_OF(session, header.request_id);
+    if (slot->mode == DATAGRAM_MODE_NONE || slot->request_id != header.request_id) {
+        fprintf(stderr, "ERROR! Received response to unknown request %u.\n", header.request_id);
+        return;
+    }
+
+    switch (header.mode) {
+        case DATAGRAM_MODE_EXECUTE_RESPONSE: {
+            const EXECUTE_RESPONSE_DATAGRAM* execute = response;
+            if (execute->status != EXECUTE_STATUS_BUSY) {
+                printf("[%u] Task queued with identifier %d.\n", header.request_id, execute->taskid);
+                session->busy_streak = 0;
+                break;
+            }
+
+            if (slot->request == NULL || slot->attempts >= SESSION_MAX_RETRIES) {
+                fprintf(stderr, "ERROR! Line %d: Server still busy. Task not queued.\n", slot->line_num);
+                session->errors++;
+                break;
+            }
+
+            // The task keeps its slot, and every command is held back until it is resent, so that the server gets
+            // room to recover.
+            int shift = (session->busy_streak < 16) ? session->busy_streak : 16;
+            uint64_t pause = (uint64_t)SESSION_BUSY_PAUSE << shift;
+            if (pause < execute->retry_after) pause = execute->retry_after;
+            if (pause > SESSION_MAX_BUSY_PAUSE) pause = SESSION_MAX_BUSY_PAUSE;
+
+            session->busy_streak++;
+            session->paused_until = session_clock() + pause;
+
+            slot->attempts++;
+            slot->retry = 1;
+            printf(
+                "[%u] Line %d: Server busy. Retrying in %lums.\n", 
+                header.request_id, 
+                slot->line_num, 
+                (unsigned long)pause
+            );
+            return;
+        }
+        case DATAGRAM_MODE_STATUS_RESPONSE: {
+            // The report arrives in chunks. Only the first one is tagged, and the request is done on the last one.
+            const STATUS_RESPONSE_DATAGRAM* status = response;
+            if (!slot->streaming) printf("[%u] ", header.request_id);
+            fwrite(status->payload, 1, size - sizeof(STATUS_RESPONSE_DATAGRAM), stdout);
+
+            slot->streaming = !status->last;
+            if (slot->streaming) return;
+            break;
+        }
+        case DATAGRAM_MODE_CLOSE_RESPONSE: {
+            printf("[%u] Server shutdown request successfully sent.\n", header.request_id);
+            break;
+        }
+        default: {
+            fprintf(stderr, "ERROR! Line %d: Received unexpected response.\n", slot->line_num);
+            session->errors++;
+            break;
+        }
+    }
+
+    slot->mode = DATAGRAM_MODE_NONE;
+    free(slot->request);
+    slot->request = NULL;
+    session->outstanding--;
+}
+
+/**
+ * @brief Handles every response currently available on the connection, without blocking.
+ */
+static void receive_session_responses(Session session) {
+    int fd = session->connection->response_fd;
+
+    if (session->connection->is_socket) {
+        for (;;) {
+            void* message = NULL;
+            ssize_t size = recv_message(fd, &message, MSG_DONTWAIT);
+            if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+
+            if (size <= 0) {
+                if (size == 0) fprintf(stderr, "ERROR! Server closed the connection.\n");
+                else perror("ERROR! Unable to receive response");
+
+                session->server_gone = 1;
+                return;
+            }
+
+            if ((size_t)size >= sizeof(DATAGRAM_HEADER) && get_response_datagram_size(message, size) == size) {
+                handle_session_response(session, message, size);
+            } else {
+                fprintf(stderr, "ERROR! Received malformed response.\n");
+            }
+
+            free(message);
+        }
+    }
+
+    ReadBuffer responses = session->responses;
+    if (fill_read_buffer(responses, fd) == -1) {
+        perror("ERROR! Unable to receive response");
+        session->server_gone = 1;
+        return;
+    }
+
+    // A FIFO is a byte stream, so responses are split by their own sizes.
+    for (;;) {
+        ssize_t size = get_response_datagram_size(READ_BUFFER_HEAD(responses), READ_BUFFER_LEN(responses));
+        if (size == 0 || (size > 0 && (size_t)size > READ_BUFFER_LEN(responses) && (size_t)size <= responses->cap)) {
+            return;
+        }
+
+        if (size < 0 || (size_t)size > responses->cap) {
+            // The stream can not be resynchronized.
+            fprintf(stderr, "ERROR! Received malformed response.\n");
+            session->server_gone = 1;
+            clear_read_buffer(responses);
+            return;
+        }
+
+        handle_session_response(session, READ_BUFFER_HEAD(responses), size);
+        consume_read_buffer(responses, size);
+    }
+}
+#pragma endregion
+
+int run_session(ClientConnection connection, int input_fd) {
+    #define ERR 1
+    int ret = ERR;
+
+    Session session = SAFE_ALLOC(Session, sizeof(SESSION));
+    memset(session, 0, sizeof(SESSION));
+    session->connection = connection;
+    session->next_request_id = 1;
+
+    // A server that goes away mid-session is reported through the failed send, instead of killing the session.
+    signal(SIGPIPE, SIG_IGN);
+
+    session->input = create_read_buffer(SESSION_INPUT_BUFFER_SIZE);
+    if (session->input == NULL) goto err;
+
+    if (!connection->is_socket) {
+        session->responses = create_read_buffer(SESSION_RESPONSE_BUFFER_SIZE);
+        if (session->responses == NULL) goto err;
+
+        int flags = fcntl(connection->response_fd, F_GETFL);
+        if (flags == -1 || fcntl(connection->response_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+            perror("ERROR! Unable to set up response FIFO");
+            goto err;
+        }
+    }
+
+    uint64_t drain_deadline = 0;
+    for (;;) {
+        process_session_input(session);
+        if (session->server_gone) break;
+
+        int input_done = session->input_ended && READ_BUFFER_LEN(session->input) == 0;
+        if (input_done && session->outstanding == 0) break;
+
+        // While paused, wake up in time to resume sending.
+        uint64_t now = session_clock();
+        int paused = now < session->paused_until;
+        int timeout = paused ? (int)(session->paused_until - now) : -1;
+        if (paused) {
+            // Waiting to resend a refused task does not count towards the time given to the outstanding responses.
+            drain_deadline = 0;
+        } else if (input_done) {
+            if (drain_deadline == 0) drain_deadline = now + SESSION_DRAIN_TIMEOUT;
+            if (now >= drain_deadline) break;
+
+            timeout = drain_deadline - now;
+        }
+
+        // The input is only read while the window has room, so that a slow server throttles the session.
+        struct pollfd pfds[2] = {
+            { .fd = connection->response_fd, .events = POLLIN },
+            { .fd = (!session->input_ended && !paused && session_has_room(session)) ? input_fd : -1, .events = POLLIN }
+        };
+
+        int ready = poll(pfds, 2, timeout);
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+
+            perror("ERROR! Unable to wait for the session");
+            goto err;
+        }
+
+        if (pfds[0].revents & (POLLIN | POLLHUP | POLLERR)) receive_session_responses(session);
+
+        if (pfds[1].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t rd = read_once_read_buffer(session->input, input_fd);
+            if (rd == 0) {
+                session->input_ended = 1;
+            } else if (rd == -1) {
+                perror("ERROR! Unable to read commands");
+                session->input_ended = 1;
+                session->errors++;
+            }
+        }
+    }
+
+    if (session->outstanding > 0) {
+        fprintf(stderr, "ERROR! %d requests were left unanswered:\n", session->outstanding);
+        for (int i = 0; i < SESSION_WINDOW; i++) {
+            if (session->slots[i].mode == DATAGRAM_MODE_NONE) continue;
+
+            fprintf(
+                stderr,
+                "  [%u] Line %d.\n",
+                session->slots[i].request_id,
+                session->slots[i].line_num
+            );
+        }
+    }
+
+    ret = (session->errors > 0 || session->outstanding > 0 || session->server_gone) ? ERR : 0;
+
+    err: {
+        fflush(stdout);
+
+        for (int i = 0; i < SESSION_WINDOW; i++) free(session->slots[i].request);
+        destroy_read_buffer(session->input);
+        destroy_read_buffer(session->responses);
+        free(session);
+        return ret;
+    }
+    #undef ERR
+}
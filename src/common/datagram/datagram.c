@@ -8,6 +8,8 @@
  ******************************************************************************/
 
 #include "common/datagram/datagram.h"
+#include "common/datagram/execute.h"
+#include "common/datagram/status.h"
 #include "common/util/string.h"
 #include "common/io/io.h"
 
@@ -16,7 +18,8 @@ DATAGRAM_HEADER create_datagram_header() {
         .version = DATAGRAM_VERSION,
         .mode = DATAGRAM_MODE_NONE,
         .type = DATAGRAM_TYPE_NONE,
-        .pid = getpid()
+        .pid = getpid(),
+        .request_id = 0
     };
 
     return dh;
@@ -32,6 +35,62 @@ DATAGRAM_HEADER read_datagram_header(int fd) {
     #undef ERR
 }
 
+ssize_t get_request_datagram_size(const void* buf, size_t len) {
+    if (len < sizeof(DATAGRAM_HEADER)) return 0;
+
+    DATAGRAM_HEADER header;
+    memcpy(&header, buf, sizeof(DATAGRAM_HEADER));
+    if (!IS_DATAGRAM_SUPPORTED_H(header)) return -1;
+
+    switch (header.mode) {
+        case DATAGRAM_MODE_STATUS_REQUEST: return sizeof(STATUS_REQUEST_DATAGRAM);
+        case DATAGRAM_MODE_EXECUTE_REQUEST: {
+            if (len < sizeof(EXECUTE_REQUEST_DATAGRAM)) return 0;
+
+            EXECUTE_REQUEST_DATAGRAM execute;
+            memcpy(&execute, buf, sizeof(EXECUTE_REQUEST_DATAGRAM));
+            if (execute.data_len > EXECUTE_REQUEST_DATAGRAM_MAX_PAYLOAD_LEN) return -1;
+
+            return EXECUTE_REQUEST_DATAGRAM_SIZE(&execute);
+        }
+        case DATAGRAM_MODE_CLOSE_REQUEST: return sizeof(DATAGRAM_HEADER);
+        case DATAGRAM_MODE_EXECUTE_BATCH_REQUEST: {
+            if (len < sizeof(EXECUTE_BATCH_REQUEST_DATAGRAM)) return 0;
+
+            EXECUTE_BATCH_REQUEST_DATAGRAM batch;
+            memcpy(&batch, buf, sizeof(EXECUTE_BATCH_REQUEST_DATAGRAM));
+            if (EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(&batch) > EXECUTE_BATCH_REQUEST_DATAGRAM_MAX_SIZE) return -1;
+
+            return EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(&batch);
+        }
+        default: return -1;
+    }
+}
+
+ssize_t get_response_datagram_size(const void* buf, size_t len) {
+    if (len < sizeof(DATAGRAM_HEADER)) return 0;
+
+    DATAGRAM_HEADER header;
+    memcpy(&header, buf, sizeof(DATAGRAM_HEADER));
+    if (!IS_DATAGRAM_SUPPORTED_H(header)) return -1;
+
+    switch (header.mode) {
+        case DATAGRAM_MODE_EXECUTE_RESPONSE: return sizeof(EXECUTE_RESPONSE_DATAGRAM);
+        case DATAGRAM_MODE_EXECUTE_BATCH_RESPONSE: return sizeof(EXECUTE_BATCH_RESPONSE_DATAGRAM);
+        case DATAGRAM_MODE_CLOSE_RESPONSE: return sizeof(DATAGRAM_HEADER);
+        case DATAGRAM_MODE_STATUS_RESPONSE: {
+            if (len < sizeof(STATUS_RESPONSE_DATAGRAM)) return 0;
+
+            STATUS_RESPONSE_DATAGRAM status;
+            memcpy(&status, buf, sizeof(STATUS_RESPONSE_DATAGRAM));
+            if (status.payload_len > STATUS_RESPONSE_DATAGRAM_MAX_PAYLOAD_LEN) return -1;
+
+            return sizeof(STATUS_RESPONSE_DATAGRAM) + status.payload_len;
+        }
+        default: return -1;
+    }
+}
+
 char* datagram_header_to_string(DatagramHeader header, int expandEnums) {
     static const char* datagram_mode_strings[] = {
         "DATAGRAM_MODE_NONE",
@@ -40,7 +99,9 @@ char* datagram_header_to_string(DatagramHeader header, int expandEnums) {
         "DATAGRAM_MODE_STATUS_RESPONSE",
         "DATAGRAM_MODE_EXECUTE_RESPONSE",
         "DATAGRAM_MODE_CLOSE_REQUEST",
-        "DATAGRAM_MODE_CLOSE_RESPONSE"
+        "DATAGRAM_MODE_CLOSE_RESPONSE",
+        "DATAGRAM_MODE_EXECUTE_BATCH_REQUEST",
+        "DATAGRAM_MODE_EXECUTE_BATCH_RESPONSE"
     };
     static const char* datagram_type_strings[] = {
         "DATAGRAM_TYPE_NONE",
@@ -49,16 +110,17 @@ char* datagram_header_to_string(DatagramHeader header, int expandEnums) {
     };
 
     if (expandEnums) {
-        char* template = "DatagramHeader{ version: %d, mode: %s, type: %s, pid: %d }";
+        char* template = "DatagramHeader{ version: %d, mode: %s, type: %s, pid: %d, request_id: %u }";
         return isnprintf(
             template, 
             header->version, 
             datagram_mode_strings[header->mode], 
             datagram_type_strings[header->type], 
-            header->pid
+            header->pid,
+            header->request_id
         );
     } else {
-        char* template = "DatagramHeader{ version: %d, mode: %d, type: %d, pid: %d }";
-        return isnprintf(template, header->version, header->mode, header->type, header->pid);
+        char* template = "DatagramHeader{ version: %d, mode: %d, type: %d, pid: %d, request_id: %u }";
+        return isnprintf(template, header->version, header->mode, header->type, header->pid, header->request_id);
     }
 }
\ No newline at end of file
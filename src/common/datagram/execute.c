@@ -5,6 +5,12 @@
  * Response Datagrams for the Execute Mode of the application architecture.   *
  *   The Execute Mode is the mode used to queue a new task on a server        *
  * instance, and get the id of the queued task.                               *
+ *   The Execute Batch variants queue several tasks with a single datagram,   *
+ * and get back the contiguous range of ids assigned to them. A task of a     *
+ * batch may depend on earlier tasks, either by id or by its position in the  *
+ * batch, so that a whole dependency graph is queued at once.                 *
+ *   A server over its admission limits answers with a busy status, and how   *
+ * long to wait before retrying, instead of queueing the tasks.               *
  *                                                                            *
  *   The create_execute_<kind>_datagram functions create a new empty datagram *
  * of the specified kind, initially valid for transmission, that allows, but  *
@@ -27,28 +33,30 @@
 #include "common/io/io.h"
 
 #pragma region ======= REQUEST =======
-ExecuteRequestDatagram create_execute_request_datagram() {
+ExecuteRequestDatagram create_execute_request_datagram(char* data, uint16_t data_len) {
     #define ERR NULL
     
-    ExecuteRequestDatagram dg = SAFE_ALLOC(ExecuteRequestDatagram, sizeof(EXECUTE_REQUEST_DATAGRAM));
+    size_t size = sizeof(EXECUTE_REQUEST_DATAGRAM) + ((data != NULL) ? data_len + 1 : 0);
+    ExecuteRequestDatagram dg = SAFE_ALLOC(ExecuteRequestDatagram, size);
     dg->header = create_datagram_header();
     dg->header.mode = DATAGRAM_MODE_EXECUTE_REQUEST;
 
     dg->time = 0;
-    memset(dg->data, 0, 300);
+    dg->data_len = data_len;
+    dg->priority = TASK_PRIORITY_NORMAL;
+    memset(dg->reserved, 0, sizeof(dg->reserved));
+    if (data != NULL) {
+        memcpy(dg->data, data, data_len);
+        dg->data[data_len] = '\0';
+    }
 
     return dg;
     #undef ERR
 }
 
 ExecuteRequestDatagram read_execute_request_datagram(int fd) {
-    #define ERR NULL
-
-    ExecuteRequestDatagram execute = calloc(1, sizeof(EXECUTE_REQUEST_DATAGRAM));
-    SAFE_READ(fd, execute, sizeof(EXECUTE_REQUEST_DATAGRAM));
-
-    return execute;
-    #undef ERR
+    DATAGRAM_HEADER header = read_datagram_header(fd);
+    return read_partial_execute_request_datagram(fd, header);
 }
 
 ExecuteRequestDatagram read_partial_execute_request_datagram(int fd, DATAGRAM_HEADER header) {
@@ -57,7 +65,24 @@ ExecuteRequestDatagram read_partial_execute_request_datagram(int fd, DATAGRAM_HE
     ExecuteRequestDatagram execute = calloc(1, sizeof(EXECUTE_REQUEST_DATAGRAM));
     execute->header = header;
 
-    SAFE_READ(fd, (((void*)execute) + sizeof(DATAGRAM_HEADER)), sizeof(EXECUTE_REQUEST_DATAGRAM) - sizeof(DATAGRAM_HEADER));
+    // Read time + command length
+    SAFE_READ(
+        fd, 
+        (((void*)execute) + sizeof(DATAGRAM_HEADER)), 
+        sizeof(EXECUTE_REQUEST_DATAGRAM) - sizeof(DATAGRAM_HEADER)
+    );
+
+    if (execute->data_len > EXECUTE_REQUEST_DATAGRAM_MAX_PAYLOAD_LEN) {
+        free(execute);
+        return ERR;
+    }
+
+    // Allocate space for the command, and keep it null-terminated in memory
+    SAFE_REALLOC(execute, EXECUTE_REQUEST_DATAGRAM_SIZE(execute) + 1);
+    execute->data[execute->data_len] = '\0';
+
+    // Read the command
+    SAFE_READ(fd, execute->data, execute->data_len);
 
     return execute;
     #undef ERR
@@ -66,20 +91,32 @@ ExecuteRequestDatagram read_partial_execute_request_datagram(int fd, DATAGRAM_HE
 char* execute_request_datagram_to_string(ExecuteRequestDatagram dg, int expandEnums, int stringPayload) {
     char* dh = datagram_header_to_string(&dg->header, expandEnums);
     short int time = dg->time;
-    char* bytes = stringPayload ? dg->data : bytes_to_hex_string(dg->data, EXECUTE_REQUEST_DATAGRAM_PAYLOAD_LEN, ':');
+    char* bytes = (stringPayload || dg->data_len == 0) ? NULL : bytes_to_hex_string(dg->data, dg->data_len, ':');
 
+    // The command is not null-terminated within a datagram received as a whole, so its length is always given.
     char* str = isnprintf(
-        "ExecuteRequestDatagram{ header: %s, time: %d, data: '%s' }",
+        "ExecuteRequestDatagram{ header: %s, time: %d, priority: %d, data_len: %d, data: '%.*s' }",
         dh,
         time,
-        bytes
+        dg->priority,
+        dg->data_len,
+        (bytes != NULL) ? (int)strlen(bytes) : dg->data_len,
+        (bytes != NULL) ? bytes : dg->data
     );
 
-    if (!stringPayload) free(bytes);
+    free(bytes);
     free(dh);
 
     return str;
 }
+
+int parse_task_priority(const char* name) {
+    if (STRING_EQUAL(name, "low")) return TASK_PRIORITY_LOW;
+    if (STRING_EQUAL(name, "normal")) return TASK_PRIORITY_NORMAL;
+    if (STRING_EQUAL(name, "high")) return TASK_PRIORITY_HIGH;
+
+    return -1;
+}
 #pragma endregion
 
 #pragma region ======= RESPONSE =======
@@ -91,6 +128,8 @@ ExecuteResponseDatagram create_execute_response_datagram() {
     dg->header.mode = DATAGRAM_MODE_EXECUTE_RESPONSE;
 
     dg->taskid = 0;
+    dg->retry_after = 0;
+    dg->status = EXECUTE_STATUS_QUEUED;
 
     return dg;
     #undef ERR
@@ -122,9 +161,230 @@ char* execute_response_datagram_to_string(ExecuteResponseDatagram dg, int expand
     char* dh = datagram_header_to_string(&dg->header, expandEnums);
     
     char* str = isnprintf(
-        "ExecuteResponseDatagram{ header: %s, taskid: %d }",
+        "ExecuteResponseDatagram{ header: %s, taskid: %d, status: %d, retry_after: %d }",
+        dh,
+        dg->taskid,
+        dg->status,
+        dg->retry_after
+    );
+
+    free(dh);
+
+    return str;
+}
+#pragma endregion
+
+#pragma region ======= BATCH REQUEST =======
+ExecuteBatchRequestDatagram create_execute_batch_request_datagram() {
+    #define ERR NULL
+
+    ExecuteBatchRequestDatagram dg = SAFE_ALLOC(ExecuteBatchRequestDatagram, EXECUTE_BATCH_REQUEST_DATAGRAM_MAX_SIZE);
+    dg->header = create_datagram_header();
+    dg->header.mode = DATAGRAM_MODE_EXECUTE_BATCH_REQUEST;
+
+    dg->num_tasks = 0;
+    dg->payload_len = 0;
+
+    return dg;
+    #undef ERR
+}
+
+int append_execute_batch_request_datagram(
+    ExecuteBatchRequestDatagram dg, 
+    short int time, 
+    uint8_t type, 
+    uint8_t priority, 
+    char* data, 
+    const int32_t* dependencies, 
+    uint16_t num_dependencies
+) {
+    size_t data_len = strlen(data);
+    size_t entry_size = EXECUTE_BATCH_ENTRY_SIZE(data_len, num_dependencies);
+
+    if (EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(dg) + entry_size > EXECUTE_BATCH_REQUEST_DATAGRAM_MAX_SIZE) return 1;
+
+    ExecuteBatchEntry entry = (ExecuteBatchEntry)(dg->payload + dg->payload_len);
+    memset(entry, 0, entry_size);
+    entry->time = time;
+    entry->type = type;
+    entry->priority = priority;
+    entry->data_len = data_len;
+    entry->num_dependencies = num_dependencies;
+    memcpy(entry->data, data, data_len);
+    if (num_dependencies > 0) memcpy(entry->data + data_len, dependencies, num_dependencies * sizeof(int32_t));
+
+    dg->num_tasks++;
+    dg->payload_len += entry_size;
+
+    return 0;
+}
+
+int32_t get_execute_batch_entry_dependency(ExecuteBatchEntry entry, int index) {
+    int32_t dependency;
+    memcpy(&dependency, entry->data + entry->data_len + index * sizeof(int32_t), sizeof(int32_t));
+
+    return dependency;
+}
+
+ExecuteBatchEntry next_execute_batch_entry(ExecuteBatchRequestDatagram dg, ExecuteBatchEntry entry) {
+    size_t offset = 0;
+    if (entry != NULL) {
+        offset = ((uint8_t*)entry - dg->payload) + EXECUTE_BATCH_ENTRY_SIZE(entry->data_len, entry->num_dependencies);
+    }
+
+    if (offset + sizeof(EXECUTE_BATCH_ENTRY) > dg->payload_len) return NULL;
+
+    ExecuteBatchEntry next = (ExecuteBatchEntry)(dg->payload + offset);
+    if (offset + EXECUTE_BATCH_ENTRY_SIZE(next->data_len, next->num_dependencies) > dg->payload_len) return NULL;
+
+    return next;
+}
+
+int count_execute_batch_entries(const uint8_t* payload, uint16_t payload_len) {
+    int num_entries = 0;
+    size_t offset = 0;
+    while (offset < payload_len) {
+        EXECUTE_BATCH_ENTRY entry;
+        if (offset + sizeof(EXECUTE_BATCH_ENTRY) > payload_len) return -1;
+        memcpy(&entry, payload + offset, sizeof(EXECUTE_BATCH_ENTRY));
+
+        offset += EXECUTE_BATCH_ENTRY_SIZE(entry.data_len, entry.num_dependencies);
+        if (offset > payload_len) return -1;
+        num_entries++;
+    }
+
+    return num_entries;
+}
+
+ExecuteBatchRequestDatagram read_execute_batch_request_datagram(int fd) {
+    DATAGRAM_HEADER header = read_datagram_header(fd);
+    return read_partial_execute_batch_request_datagram(fd, header);
+}
+
+ExecuteBatchRequestDatagram read_partial_execute_batch_request_datagram(int fd, DATAGRAM_HEADER header) {
+    #define ERR NULL
+
+    ExecuteBatchRequestDatagram execute = calloc(1, sizeof(EXECUTE_BATCH_REQUEST_DATAGRAM));
+    execute->header = header;
+
+    // Read number of tasks + payload length
+    SAFE_READ(
+        fd, 
+        (((void*)execute) + sizeof(DATAGRAM_HEADER)), 
+        sizeof(EXECUTE_BATCH_REQUEST_DATAGRAM) - sizeof(DATAGRAM_HEADER)
+    );
+
+    if (EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(execute) > EXECUTE_BATCH_REQUEST_DATAGRAM_MAX_SIZE) {
+        free(execute);
+        return ERR;
+    }
+
+    // Allocate space for payload
+    SAFE_REALLOC(execute, EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(execute));
+
+    // Read datagram payload
+    SAFE_READ(fd, execute->payload, execute->payload_len);
+
+    return execute;
+    #undef ERR
+}
+
+char* execute_batch_request_datagram_to_string(ExecuteBatchRequestDatagram dg, int expandEnums) {
+    char* dh = datagram_header_to_string(&dg->header, expandEnums);
+    char* tasks = calloc(1, sizeof(char));
+
+    for (ExecuteBatchEntry entry = next_execute_batch_entry(dg, NULL); entry; entry = next_execute_batch_entry(dg, entry)) {
+        char* after = calloc(1, sizeof(char));
+        for (int i = 0; i < entry->num_dependencies; i++) {
+            char* _after = after;
+            after = isnprintf("%s%s%d", after, *after ? ", " : "", get_execute_batch_entry_dependency(entry, i));
+            free(_after);
+        }
+
+        char* _tasks = tasks;
+        tasks = isnprintf(
+            "%s%s{ time: %d, type: %d, priority: %d, after: [%s], data: '%.*s' }",
+            tasks,
+            *tasks ? ", " : "",
+            entry->time,
+            entry->type,
+            entry->priority,
+            after,
+            entry->data_len,
+            entry->data
+        );
+        free(_tasks);
+        free(after);
+    }
+
+    char* str = isnprintf(
+        "ExecuteBatchRequestDatagram{ header: %s, num_tasks: %d, payload_len: %d, tasks: [%s] }",
+        dh,
+        dg->num_tasks,
+        dg->payload_len,
+        tasks
+    );
+
+    free(tasks);
+    free(dh);
+
+    return str;
+}
+#pragma endregion
+
+#pragma region ======= BATCH RESPONSE =======
+ExecuteBatchResponseDatagram create_execute_batch_response_datagram() {
+    #define ERR NULL
+    
+    ExecuteBatchResponseDatagram dg = SAFE_ALLOC(ExecuteBatchResponseDatagram, sizeof(EXECUTE_BATCH_RESPONSE_DATAGRAM));
+    dg->header = create_datagram_header();
+    dg->header.mode = DATAGRAM_MODE_EXECUTE_BATCH_RESPONSE;
+
+    dg->first_taskid = 0;
+    dg->num_tasks = 0;
+    dg->status = EXECUTE_STATUS_QUEUED;
+    dg->retry_after = 0;
+
+    return dg;
+    #undef ERR
+}
+
+ExecuteBatchResponseDatagram read_execute_batch_response_datagram(int fd) {
+    #define ERR NULL
+
+    ExecuteBatchResponseDatagram execute = calloc(1, sizeof(EXECUTE_BATCH_RESPONSE_DATAGRAM));
+    SAFE_READ(fd, execute, sizeof(EXECUTE_BATCH_RESPONSE_DATAGRAM));
+
+    return execute;
+    #undef ERR
+}
+
+ExecuteBatchResponseDatagram read_partial_execute_batch_response_datagram(int fd, DATAGRAM_HEADER header) {
+    #define ERR NULL
+    
+    ExecuteBatchResponseDatagram execute = calloc(1, sizeof(EXECUTE_BATCH_RESPONSE_DATAGRAM));
+    execute->header = header;
+
+    SAFE_READ(
+        fd, 
+        (((void*)execute) + sizeof(DATAGRAM_HEADER)), 
+        sizeof(EXECUTE_BATCH_RESPONSE_DATAGRAM) - sizeof(DATAGRAM_HEADER)
+    );
+
+    return execute;
+    #undef ERR
+}
+
+char* execute_batch_response_datagram_to_string(ExecuteBatchResponseDatagram dg, int expandEnums) {
+    char* dh = datagram_header_to_string(&dg->header, expandEnums);
+    
+    char* str = isnprintf(
+        "ExecuteBatchResponseDatagram{ header: %s, first_taskid: %d, num_tasks: %d, status: %d, retry_after: %d }",
         dh,
-        dg->taskid
+        dg->first_taskid,
+        dg->num_tasks,
+        dg->status,
+        dg->retry_after
     );
 
     free(dh);
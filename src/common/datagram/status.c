@@ -5,6 +5,9 @@
  * Response Datagrams for the Status Mode of the application architecture.    *
  *   The Status Mode is the mode used to query the current state of a server  *
  * instance, returning the queues, running and completed tasks.               *
+ *   A request may ask for only some sections of the report, and only the     *
+ * last completed tasks. The report is streamed back as a sequence of         *
+ * bounded chunks, the last of which is marked as such.                       *
  *                                                                            *
  *   The create_status_<kind>_datagram functions create a new empty datagram  *
  * of the specified kind, initially valid for transmission, that allows, but  *
@@ -33,11 +36,44 @@ StatusRequestDatagram create_status_request_datagram() {
     StatusRequestDatagram dg = SAFE_ALLOC(StatusRequestDatagram, sizeof(STATUS_REQUEST_DATAGRAM));
     dg->header = create_datagram_header();
     dg->header.mode = DATAGRAM_MODE_STATUS_REQUEST;
+    dg->sections = STATUS_SECTION_ALL;
+    dg->completed_limit = 0;
 
     return dg;
     #undef ERR
 }
 
+int set_status_request_filter(StatusRequestDatagram dg, int argc, char* const argv[]) {
+    dg->sections = STATUS_SECTION_ALL;
+    dg->completed_limit = 0;
+    if (argc == 0) return 0;
+
+    if (STRING_EQUAL("queued", argv[0])) {
+        dg->sections = STATUS_SECTION_QUEUED;
+    } else if (STRING_EQUAL("running", argv[0])) {
+        dg->sections = STATUS_SECTION_RUNNING;
+    } else if (STRING_EQUAL("completed", argv[0])) {
+        dg->sections = STATUS_SECTION_COMPLETED;
+    } else if (STRING_EQUAL("wait", argv[0])) {
+        dg->sections = STATUS_SECTION_WAIT_TIMES;
+    } else if (STRING_EQUAL("workers", argv[0])) {
+        dg->sections = STATUS_SECTION_WORKERS;
+    } else {
+        return 1;
+    }
+
+    // Only the completed section takes a limit.
+    if (argc == 1) return 0;
+    if (argc > 2 || dg->sections != STATUS_SECTION_COMPLETED) return 1;
+
+    char* end = NULL;
+    long limit = strtol(argv[1], &end, 10);
+    if (end == argv[1] || *end != '\0' || limit <= 0) return 1;
+
+    dg->completed_limit = limit;
+    return 0;
+}
+
 StatusRequestDatagram read_status_request_datagram(int fd) {
     #define ERR NULL
 
@@ -49,14 +85,12 @@ StatusRequestDatagram read_status_request_datagram(int fd) {
 }
 
 StatusRequestDatagram read_partial_status_request_datagram(int fd, DATAGRAM_HEADER header) {
-    UNUSED(fd);
-
     #define ERR NULL
     
     StatusRequestDatagram status = calloc(1, sizeof(STATUS_REQUEST_DATAGRAM));
     status->header = header;
 
-    // SAFE_READ(fd, (((void*)status) + sizeof(DATAGRAM_HEADER)), sizeof(STATUS_REQUEST_DATAGRAM) - sizeof(DATAGRAM_HEADER));
+    SAFE_READ(fd, (((void*)status) + sizeof(DATAGRAM_HEADER)), sizeof(STATUS_REQUEST_DATAGRAM) - sizeof(DATAGRAM_HEADER));
 
     return status;
     #undef ERR
@@ -70,8 +104,10 @@ char* status_request_datagram_to_string(StatusRequestDatagram dg, int expandEnum
         // "StatusRequestDatagram{ header: %s, data: '%s' }",
         // dh,
         // bytes
-        "StatusRequestDatagram{ header: %s }",
-        dh
+        "StatusRequestDatagram{ header: %s, sections: %d, completed_limit: %u }",
+        dh,
+        dg->sections,
+        dg->completed_limit
     );
 
     // free(bytes);
@@ -91,6 +127,7 @@ StatusResponseDatagram create_status_response_datagram(uint8_t payload[], int pa
     dg->header.mode = DATAGRAM_MODE_STATUS_RESPONSE;
 
     dg->payload_len = payload_len;
+    dg->last = 1;
     if (payload_len > 0 && payload != NULL) {
         memcpy(dg->payload, payload, payload_len);
     }
@@ -105,15 +142,24 @@ StatusResponseDatagram read_status_response_datagram(int fd) {
 
     StatusResponseDatagram status = calloc(1, sizeof(STATUS_RESPONSE_DATAGRAM));
 
-    // Read datagram header + payload length
-    int size = STRUCT_MEMBER_SIZE(STATUS_RESPONSE_DATAGRAM, header) + STRUCT_MEMBER_SIZE(STATUS_RESPONSE_DATAGRAM, payload_len);
+    // Read datagram header + payload length + chunk flag
+    int size = sizeof(STATUS_RESPONSE_DATAGRAM);
     SAFE_READ(fd, status, size);
     
+    // Chunks never exceed the maximum payload, so anything larger is a broken stream.
+    if (status->payload_len > STATUS_RESPONSE_DATAGRAM_MAX_PAYLOAD_LEN) {
+        free(status);
+        return ERR;
+    }
+
     // Allocate space for payload
     SAFE_REALLOC(status, sizeof(STATUS_RESPONSE_DATAGRAM) + status->payload_len);
 
-    // Read datagram payload
-    SAFE_READ(fd, (((void*)status) + size), status->payload_len);
+    // Read datagram payload. Payloads larger than PIPE_BUF may arrive in several pieces.
+    if (read_full(fd, (((void*)status) + size), status->payload_len) != (ssize_t)status->payload_len) {
+        free(status);
+        return ERR;
+    }
 
     return status;
     #undef ERR
@@ -129,16 +175,25 @@ StatusResponseDatagram read_partial_status_response_datagram(int fd, DATAGRAM_HE
     
     int offset = sizeof(DATAGRAM_HEADER);
 
-    // Read datagram header + payload length
-    int size = STRUCT_MEMBER_SIZE(STATUS_RESPONSE_DATAGRAM, payload_len);
+    // Read payload length + chunk flag
+    int size = sizeof(STATUS_RESPONSE_DATAGRAM) - sizeof(DATAGRAM_HEADER);
     SAFE_READ(fd, (((void*)status) + offset), size);
     offset += size;
 
+    // Chunks never exceed the maximum payload, so anything larger is a broken stream.
+    if (status->payload_len > STATUS_RESPONSE_DATAGRAM_MAX_PAYLOAD_LEN) {
+        free(status);
+        return ERR;
+    }
+
     // Allocate space for payload
     SAFE_REALLOC(status, sizeof(STATUS_RESPONSE_DATAGRAM) + status->payload_len);
 
-    // Read datagram payload
-    SAFE_READ(fd, (((void*)status) + offset), status->payload_len);
+    // Read datagram payload. Payloads larger than PIPE_BUF may arrive in several pieces.
+    if (read_full(fd, (((void*)status) + offset), status->payload_len) != (ssize_t)status->payload_len) {
+        free(status);
+        return ERR;
+    }
 
     return status;
     #undef ERR
@@ -158,9 +213,10 @@ char* status_response_datagram_to_string(StatusResponseDatagram dg, int expandEn
     }
 
     char* str = isnprintf(
-        "StatusResponseDatagram{ header: %s, payload_len: %d, data: '%s' }",
+        "StatusResponseDatagram{ header: %s, payload_len: %d, last: %d, data: '%s' }",
         dh,
         dg->payload_len,
+        dg->last,
         bytes
     );
 
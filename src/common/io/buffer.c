@@ -0,0 +1,95 @@
+/******************************************************************************
+ *                              IO BUFFER UTILITY                             *
+ *                                                                            *
+ *   The IO Buffer Utility provides a fixed-capacity read buffer used to      *
+ * drain a non-blocking file descriptor in as few read calls as possible,     *
+ * and then consume the buffered bytes one datagram at a time. The buffer     *
+ * never grows, so its capacity, set when it is created, must hold the        *
+ * largest datagram read through it.                                          *
+ *                                                                            *
+ *   Bytes are always appended at the tail of the buffer and consumed from    *
+ * its head. Consumed bytes are only discarded when more space is needed, so  *
+ * consuming many small datagrams from a single fill does not move memory.    *
+ ******************************************************************************/
+
+#include <errno.h>
+#include "common/io/buffer.h"
+#include "common/util/alloc.h"
+#include "common/io/io.h"
+
+ReadBuffer create_read_buffer(size_t cap) {
+    #define ERR NULL
+
+    ReadBuffer rb = SAFE_ALLOC(ReadBuffer, sizeof(READ_BUFFER));
+    rb->data = SAFE_ALLOC(uint8_t*, cap);
+    rb->start = 0;
+    rb->end = 0;
+    rb->cap = cap;
+
+    return rb;
+    #undef ERR
+}
+
+/**
+ * @brief Discards the consumed bytes of a Read Buffer, to make room at its tail.
+ */
+static inline void compact_read_buffer(ReadBuffer rb) {
+    if (rb->start > 0) {
+        memmove(rb->data, rb->data + rb->start, rb->end - rb->start);
+        rb->end -= rb->start;
+        rb->start = 0;
+    }
+}
+
+ssize_t fill_read_buffer(ReadBuffer rb, int fd) {
+    compact_read_buffer(rb);
+
+    ssize_t total = 0;
+    while (rb->end < rb->cap) {
+        ssize_t rd = read(fd, rb->data + rb->end, rb->cap - rb->end);
+        if (rd == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        if (rd == 0) break;
+
+        rb->end += rd;
+        total += rd;
+    }
+
+    return total;
+}
+
+ssize_t read_once_read_buffer(ReadBuffer rb, int fd) {
+    compact_read_buffer(rb);
+    if (rb->end == rb->cap) return 0;
+
+    ssize_t rd;
+    do {
+        rd = read(fd, rb->data + rb->end, rb->cap - rb->end);
+    } while (rd == -1 && errno == EINTR);
+
+    if (rd > 0) rb->end += rd;
+    return rd;
+}
+
+void consume_read_buffer(ReadBuffer rb, size_t n) {
+    rb->start += n;
+    if (rb->start >= rb->end) {
+        rb->start = 0;
+        rb->end = 0;
+    }
+}
+
+void clear_read_buffer(ReadBuffer rb) {
+    rb->start = 0;
+    rb->end = 0;
+}
+
+void destroy_read_buffer(ReadBuffer rb) {
+    if (rb == NULL) return;
+
+    free(rb->data);
+    free(rb);
+}
@@ -12,6 +12,7 @@
  * Critical Marks.                                                            *
  ******************************************************************************/
 
+#include <errno.h>
 #include "common/io/io.h"
 
 char* get_cwd() {
@@ -66,3 +67,20 @@ void drain_fifo(int fd) {
         bytes_read = read(fd, buffer, sizeof(buffer));
     } while (bytes_read > 0);
 }
+
+ssize_t read_full(int fd, void* buf, size_t nbytes) {
+    size_t total = 0;
+
+    while (total < nbytes) {
+        ssize_t rd = read(fd, (uint8_t*)buf + total, nbytes - total);
+        if (rd == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (rd == 0) break;
+
+        total += rd;
+    }
+
+    return total;
+}
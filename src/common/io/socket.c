@@ -0,0 +1,93 @@
+/******************************************************************************
+ *                            IO SOCKET UTILITY                               *
+ *                                                                            *
+ *   The IO Socket Utility module contains the names and helpers for the      *
+ * Unix domain socket transport, an alternative to the named FIFOs.           *
+ *                                                                            *
+ *   The server listens on a SOCK_SEQPACKET socket bound to the abstract      *
+ * namespace, so no file is ever created or removed. Each accepted connection *
+ * is a session of its own: replies are sent back through the connection the *
+ * request came from, and every datagram is delivered as a single message.    *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <stddef.h>
+#include <errno.h>
+#include "common/io/socket.h"
+#include "common/io/io.h"
+
+#define SERVER_SOCKET_BACKLOG 128
+
+/**
+ * @brief Fills the abstract address of the server socket, returning the length of the address.
+ */
+static socklen_t get_server_socket_address(struct sockaddr_un* addr) {
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+
+    // The leading null byte places the name in the abstract namespace.
+    int len = snprintf(addr->sun_path + 1, sizeof(addr->sun_path) - 1, SERVER_SOCKET "%s", get_cwd());
+    if (len > (int)sizeof(addr->sun_path) - 1) len = sizeof(addr->sun_path) - 1;
+
+    return offsetof(struct sockaddr_un, sun_path) + 1 + len;
+}
+
+int create_server_socket() {
+    struct sockaddr_un addr;
+    socklen_t addr_len = get_server_socket_address(&addr);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        perror(ERROR_STR_HEADER "Unable to create server socket");
+        return -1;
+    }
+
+    if (bind(fd, (struct sockaddr*)&addr, addr_len) == -1 || listen(fd, SERVER_SOCKET_BACKLOG) == -1) {
+        perror(ERROR_STR_HEADER "Unable to listen on server socket");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int connect_server_socket() {
+    struct sockaddr_un addr;
+    socklen_t addr_len = get_server_socket_address(&addr);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd == -1) return -1;
+
+    if (connect(fd, (struct sockaddr*)&addr, addr_len) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+ssize_t recv_message(int fd, void** buf, int flags) {
+    // Peek the size of the next message without consuming it.
+    ssize_t size;
+    do {
+        size = recv(fd, NULL, 0, MSG_PEEK | MSG_TRUNC | flags);
+    } while (size == -1 && errno == EINTR);
+    if (size <= 0) return size;
+
+    *buf = malloc(size);
+    if (*buf == NULL) return -1;
+
+    do {
+        size = recv(fd, *buf, size, flags);
+    } while (size == -1 && errno == EINTR);
+
+    if (size <= 0) {
+        free(*buf);
+        *buf = NULL;
+    }
+
+    return size;
+}
@@ -59,3 +59,61 @@ char* trim(char* orig) {
     while (*ptr == ' '){ *ptr = '\0' ; ptr--; };
     return str;
 }
+
+StringBuilder create_string_builder(size_t cap) {
+    StringBuilder sb = malloc(sizeof(STRING_BUILDER));
+    if (sb == NULL) return NULL;
+
+    if (cap == 0) cap = 64;
+    sb->str = malloc(cap);
+    if (sb->str == NULL) {
+        free(sb);
+        return NULL;
+    }
+
+    sb->str[0] = '\0';
+    sb->len = 0;
+    sb->cap = cap;
+
+    return sb;
+}
+
+int string_builder_append(StringBuilder sb, const char* format, ...) {
+    va_list args;
+
+    for (;;) {
+        va_start(args, format);
+        int length = vsnprintf(sb->str + sb->len, sb->cap - sb->len, format, args);
+        va_end(args);
+
+        if (length < 0) {
+            sb->str[sb->len] = '\0';
+            return 1;
+        }
+        if ((size_t)length < sb->cap - sb->len) {
+            sb->len += length;
+            return 0;
+        }
+
+        // Didn't fit. Grow and format again.
+        size_t cap = sb->cap * 2;
+        while (cap - sb->len <= (size_t)length) cap *= 2;
+
+        char* str = realloc(sb->str, cap);
+        if (str == NULL) {
+            sb->str[sb->len] = '\0';
+            return 1;
+        }
+
+        sb->str = str;
+        sb->cap = cap;
+    }
+}
+
+char* finish_string_builder(StringBuilder sb, size_t* len) {
+    char* str = sb->str;
+    if (len != NULL) *len = sb->len;
+
+    free(sb);
+    return str;
+}
@@ -0,0 +1,121 @@
+/******************************************************************************
+ *                             ADMISSION CONTROL                              *
+ *                                                                            *
+ *   The Admission Control bounds how many tasks may be outstanding at once,  *
+ * across every client and for each client, so that a runaway submitter can   *
+ * not grow the backlog of the operator until it runs out of memory. Requests *
+ * over either limit are answered as busy, with a hint of how long to wait    *
+ * before retrying, and nothing is queued.                                    *
+ *   A task is outstanding from the moment the server admits it until the     *
+ * operator is done with it, whether it completed or was cancelled. The       *
+ * server counts the tasks it admits and the operator the tasks it finishes,  *
+ * each in counters only it writes, so that neither ever waits on the other.  *
+ * The finished counters live in memory shared by both.                       *
+ *   Clients are told apart by their pid, hashed into a fixed number of       *
+ * slots. Clients sharing a slot share their limit.                           *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "server/admission.h"
+#include "common/error.h"
+#include "common/util/string.h"
+
+/**
+ * @brief Returns the slot of a client.
+ */
+static inline int get_admission_slot(pid_t client) {
+    return (uint32_t)client % ADMISSION_CLIENT_SLOTS;
+}
+
+Admission create_admission(uint32_t max_tasks, uint32_t max_client_tasks) {
+    Admission admission = calloc(1, sizeof(ADMISSION));
+    if (admission == NULL) return NULL;
+
+    // The new memory is zeroed, which starts every counter at 0.
+    admission->shared = mmap(
+        NULL,
+        sizeof(ADMISSION_SHARED),
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS,
+        -1,
+        0
+    );
+    if (admission->shared == MAP_FAILED) {
+        perror(ERROR_STR_HEADER "Unable to map admission memory");
+        free(admission);
+        return NULL;
+    }
+
+    admission->max_tasks = max_tasks;
+    admission->max_client_tasks = max_client_tasks;
+
+    return admission;
+}
+
+/**
+ * @brief Returns how long a client should wait before retrying a request that would leave outstanding tasks over a
+ * limit, or 0 if it would not. Counters wrap around, so only their differences are meaningful.
+ */
+static uint32_t get_admission_retry_after(uint32_t admitted, uint32_t finished, uint32_t limit, uint32_t num_tasks) {
+    uint32_t outstanding = admitted - finished;
+    if (limit == 0 || outstanding + num_tasks <= limit || outstanding == 0) return 0;
+
+    uint64_t retry_after = (uint64_t)ADMISSION_RETRY_AFTER * (outstanding + num_tasks) / limit;
+    return (retry_after < ADMISSION_MAX_RETRY_AFTER) ? (uint32_t)retry_after : ADMISSION_MAX_RETRY_AFTER;
+}
+
+uint32_t admission_admit(Admission admission, pid_t client, uint32_t num_tasks) {
+    if (admission == NULL) return 0;
+
+    int slot = get_admission_slot(client);
+    uint32_t finished = atomic_load_explicit(&admission->shared->finished, memory_order_acquire);
+    uint32_t client_finished = atomic_load_explicit(&admission->shared->client_finished[slot], memory_order_acquire);
+
+    uint32_t retry_after = get_admission_retry_after(admission->admitted, finished, admission->max_tasks, num_tasks);
+    uint32_t client_retry_after = get_admission_retry_after(
+        admission->client_admitted[slot],
+        client_finished,
+        admission->max_client_tasks,
+        num_tasks
+    );
+    if (client_retry_after > retry_after) retry_after = client_retry_after;
+
+    if (retry_after != 0) {
+        admission->rejected++;
+        return retry_after;
+    }
+
+    admission->admitted += num_tasks;
+    admission->client_admitted[slot] += num_tasks;
+    return 0;
+}
+
+void admission_revoke(Admission admission, pid_t client, uint32_t num_tasks) {
+    if (admission == NULL) return;
+
+    admission->admitted -= num_tasks;
+    admission->client_admitted[get_admission_slot(client)] -= num_tasks;
+}
+
+void admission_release(Admission admission, pid_t client) {
+    if (admission == NULL) return;
+
+    atomic_fetch_add_explicit(&admission->shared->client_finished[get_admission_slot(client)], 1, memory_order_release);
+    atomic_fetch_add_explicit(&admission->shared->finished, 1, memory_order_release);
+}
+
+uint32_t get_admission_outstanding(Admission admission) {
+    return admission->admitted - atomic_load_explicit(&admission->shared->finished, memory_order_acquire);
+}
+
+void destroy_admission(Admission admission) {
+    if (admission == NULL) return;
+
+    munmap(admission->shared, sizeof(ADMISSION_SHARED));
+    free(admission);
+}
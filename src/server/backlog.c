@@ -0,0 +1,59 @@
+/******************************************************************************
+ *                                  BACKLOG                                   *
+ *                                                                            *
+ *   The Backlog holds the tasks waiting for a worker, split by their         *
+ * priority class. Every class gets its own Fair Queue, and a task is only    *
+ * dispatched once every class above its own is empty, so that urgent tasks   *
+ * never wait behind tasks of a lower class, however many of them are queued. *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include "server/backlog.h"
+
+Backlog create_backlog(uint32_t quantum, FairQueueCostFunc cost, GCompareDataFunc compare, gpointer user_data) {
+    Backlog backlog = calloc(1, sizeof(BACKLOG));
+    if (backlog == NULL) return NULL;
+
+    for (int i = 0; i < TASK_PRIORITY_CLASSES; i++) {
+        backlog->classes[i] = create_fair_queue(quantum, cost, compare, user_data);
+        if (backlog->classes[i] == NULL) {
+            destroy_backlog(backlog);
+            return NULL;
+        }
+    }
+
+    return backlog;
+}
+
+int backlog_push(Backlog backlog, uint8_t priority, int tenant_id, gpointer data) {
+    if (priority >= TASK_PRIORITY_CLASSES) priority = TASK_PRIORITY_CLASSES - 1;
+    if (fair_queue_push(backlog->classes[priority], tenant_id, data) != 0) return 1;
+
+    backlog->length++;
+    return 0;
+}
+
+gpointer backlog_pop(Backlog backlog) {
+    int priority = get_backlog_priority(backlog);
+    if (priority == -1) return NULL;
+
+    backlog->length--;
+    return fair_queue_pop(backlog->classes[priority]);
+}
+
+int get_backlog_priority(Backlog backlog) {
+    for (int i = TASK_PRIORITY_CLASSES - 1; i >= 0; i--) {
+        if (backlog->classes[i]->length > 0) return i;
+    }
+
+    return -1;
+}
+
+void destroy_backlog(Backlog backlog) {
+    if (backlog == NULL) return;
+
+    for (int i = 0; i < TASK_PRIORITY_CLASSES; i++) {
+        if (backlog->classes[i] != NULL) destroy_fair_queue(backlog->classes[i]);
+    }
+    free(backlog);
+}
@@ -0,0 +1,103 @@
+/******************************************************************************
+ *                               WORKER CLAIMS                                *
+ *                                                                            *
+ *   The Worker Claims let the operator write tasks to a worker ahead of      *
+ * time, and still take them back while the worker has not started them.     *
+ *   Every task written to a worker gets a claim in shared memory. The worker *
+ * takes the claim before running the task, and the operator steals it to    *
+ * hand the task to another worker. Both use a single compare-and-swap, so    *
+ * exactly one of them wins, and a worker skips every task it finds stolen.   *
+ *   A claim is only released by the operator, once the worker reported the  *
+ * task as completed or skipped, so a worker never holds more claims than it  *
+ * was given cells for.                                                       *
+ ******************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include "server/claims.h"
+#include "common/error.h"
+#include "common/util/string.h"
+
+/**
+ * @brief Returns the first cell of a worker.
+ */
+static inline _Atomic uint64_t* get_worker_cells(WorkerClaims claims, int worker_id) {
+    return claims->cells + (size_t)worker_id * claims->cells_per_worker;
+}
+
+WorkerClaims create_worker_claims(int num_workers, int cells_per_worker) {
+    #define ERR NULL
+    WorkerClaims claims = malloc(sizeof(WORKER_CLAIMS));
+    if (claims == NULL) return ERR;
+
+    // The new memory is zeroed, which leaves every cell free.
+    size_t size = (size_t)num_workers * cells_per_worker * sizeof(uint64_t);
+    claims->cells = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (claims->cells == MAP_FAILED) {
+        perror(ERROR_STR_HEADER "Unable to map worker claims");
+        free(claims);
+        return ERR;
+    }
+
+    claims->num_workers = num_workers;
+    claims->cells_per_worker = cells_per_worker;
+
+    return claims;
+    #undef ERR
+}
+
+int offer_worker_claim(WorkerClaims claims, int worker_id, int task_id) {
+    _Atomic uint64_t* cells = get_worker_cells(claims, worker_id);
+
+    // Free cells are only ever taken by the operator, so no compare-and-swap is needed.
+    for (int i = 0; i < claims->cells_per_worker; i++) {
+        if (atomic_load(&cells[i]) != WORKER_CLAIM(0, WORKER_CLAIM_FREE)) continue;
+
+        atomic_store(&cells[i], WORKER_CLAIM(task_id, WORKER_CLAIM_QUEUED));
+        return i;
+    }
+
+    return -1;
+}
+
+int take_worker_claim(WorkerClaims claims, int worker_id, int task_id) {
+    _Atomic uint64_t* cells = get_worker_cells(claims, worker_id);
+
+    for (int i = 0; i < claims->cells_per_worker; i++) {
+        uint64_t expected = WORKER_CLAIM(task_id, WORKER_CLAIM_QUEUED);
+        if (atomic_compare_exchange_strong(&cells[i], &expected, WORKER_CLAIM(task_id, WORKER_CLAIM_RUNNING))) return 1;
+    }
+
+    return 0;
+}
+
+int steal_worker_claim(WorkerClaims claims, int worker_id, int cell, int task_id) {
+    _Atomic uint64_t* cells = get_worker_cells(claims, worker_id);
+
+    uint64_t expected = WORKER_CLAIM(task_id, WORKER_CLAIM_QUEUED);
+    return atomic_compare_exchange_strong(&cells[cell], &expected, WORKER_CLAIM(task_id, WORKER_CLAIM_STOLEN));
+}
+
+int find_worker_claim(WorkerClaims claims, int worker_id, int task_id, WorkerClaimState state) {
+    _Atomic uint64_t* cells = get_worker_cells(claims, worker_id);
+
+    for (int i = 0; i < claims->cells_per_worker; i++) {
+        if (atomic_load(&cells[i]) == WORKER_CLAIM(task_id, state)) return i;
+    }
+
+    return -1;
+}
+
+void release_worker_claim(WorkerClaims claims, int worker_id, int cell) {
+    atomic_store(&get_worker_cells(claims, worker_id)[cell], WORKER_CLAIM(0, WORKER_CLAIM_FREE));
+}
+
+void destroy_worker_claims(WorkerClaims claims) {
+    if (claims == NULL) return;
+
+    munmap(claims->cells, (size_t)claims->num_workers * claims->cells_per_worker * sizeof(uint64_t));
+    free(claims);
+}
@@ -0,0 +1,143 @@
+/******************************************************************************
+ *                             CONCURRENCY LIMIT                              *
+ *                                                                            *
+ *   The Concurrency Limit adapts the number of tasks the operator runs at    *
+ * the same time to how much CPU they actually use, so that IO-bound tasks do *
+ * not leave the CPUs idle and CPU-bound tasks do not fight over them.        *
+ *   The limit follows additive increase, multiplicative decrease, like TCP   *
+ * congestion control. Once per interval, the pressure on the CPUs is         *
+ * measured from /proc/pressure/cpu, or from how busy /proc/stat reports them *
+ * if pressure stall information is not available. If they are congested,     *
+ * the limit is cut. If not, and tasks waited on the limit, it grows by about *
+ * one CPU worth of tasks, as measured from the CPU time completed tasks used *
+ * against the time they ran.                                                 *
+ *   The limit never leaves its configured bounds, and starts at the number   *
+ * of CPUs.                                                                   *
+ ******************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "server/concurrency.h"
+
+#define CONCURRENCY_STAT_PATH "/proc/stat"
+#define CONCURRENCY_PRESSURE_PATH "/proc/pressure/cpu"
+
+ConcurrencyLimit create_concurrency_limit(int min_limit, int max_limit) {
+    ConcurrencyLimit limit = calloc(1, sizeof(CONCURRENCY_LIMIT));
+    if (limit == NULL) return NULL;
+
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_cpus < 1) num_cpus = 1;
+
+    limit->min_limit = min_limit;
+    limit->max_limit = max_limit;
+    limit->limit = (num_cpus < min_limit) ? min_limit : (num_cpus > max_limit) ? max_limit : num_cpus;
+    limit->task_cpu = -1;
+    limit->cpu_pressure = -1;
+
+    return limit;
+}
+
+int get_concurrency_limit(ConcurrencyLimit limit) {
+    return (int)limit->limit;
+}
+
+void concurrency_observe_task(ConcurrencyLimit limit, uint32_t cpu_time, uint32_t run_time) {
+    // Tasks too short to measure say nothing about how much CPU the others use.
+    if (run_time == 0) return;
+
+    // Several processes of a pipeline may use more than one CPU, which counts as a single whole one.
+    double share = (double)cpu_time / run_time;
+    if (share > 1) share = 1;
+
+    if (limit->task_cpu < 0) limit->task_cpu = share;
+    else limit->task_cpu += CONCURRENCY_TASK_CPU_ALPHA * (share - limit->task_cpu);
+}
+
+void concurrency_mark_limited(ConcurrencyLimit limit) {
+    limit->limited = 1;
+}
+
+void concurrency_update(ConcurrencyLimit limit, double cpu_busy, double cpu_pressure) {
+    int congested = (cpu_pressure >= 0) ? cpu_pressure > CONCURRENCY_MAX_PRESSURE : cpu_busy > CONCURRENCY_MAX_BUSY;
+
+    if (congested) {
+        limit->limit *= CONCURRENCY_DECREASE;
+    } else if (limit->limited) {
+        // One CPU worth of tasks. Until a task completes, every task is assumed to use a whole CPU.
+        double increase = CONCURRENCY_MAX_INCREASE;
+        if (limit->task_cpu < 0) increase = 1;
+        else if (limit->task_cpu * CONCURRENCY_MAX_INCREASE > 1) increase = 1 / limit->task_cpu;
+
+        limit->limit += increase;
+    }
+
+    if (limit->limit < limit->min_limit) limit->limit = limit->min_limit;
+    if (limit->limit > limit->max_limit) limit->limit = limit->max_limit;
+
+    limit->limited = 0;
+    limit->cpu_busy = cpu_busy;
+    limit->cpu_pressure = cpu_pressure;
+}
+
+/**
+ * @brief Reads the CPU counters from /proc. Pressure stall information is left at 0 if it is not available.
+ *
+ * @return 0 on success, 1 if the CPU times can not be read.
+ */
+static int read_concurrency_sample(ConcurrencySample sample) {
+    FILE* stat = fopen(CONCURRENCY_STAT_PATH, "r");
+    if (stat == NULL) return 1;
+
+    // cpu <user> <nice> <system> <idle> <iowait> <irq> <softirq> <steal>, summed over every CPU.
+    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
+    int matched = fscanf(stat, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+        &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
+    fclose(stat);
+    if (matched != 8) return 1;
+
+    sample->busy = user + nice + system + irq + softirq + steal;
+    sample->total = sample->busy + idle + iowait;
+
+    // some avg10=<%> avg60=<%> avg300=<%> total=<us>
+    sample->stalled = 0;
+    FILE* pressure = fopen(CONCURRENCY_PRESSURE_PATH, "r");
+    if (pressure != NULL) {
+        unsigned long long stalled;
+        int matched = fscanf(pressure, "some avg10=%*f avg60=%*f avg300=%*f total=%llu", &stalled);
+        if (matched == 1) sample->stalled = stalled;
+        fclose(pressure);
+    }
+
+    return 0;
+}
+
+int concurrency_adjust(ConcurrencyLimit limit, int64_t now_ms) {
+    int64_t elapsed = now_ms - limit->sample.time_ms;
+    if (limit->sample.time_ms != 0 && elapsed < CONCURRENCY_INTERVAL) return (int)(CONCURRENCY_INTERVAL - elapsed);
+
+    CONCURRENCY_SAMPLE sample = { .time_ms = now_ms };
+    if (read_concurrency_sample(&sample) != 0) return CONCURRENCY_INTERVAL;
+
+    // The first sample only sets the baseline. So does one taken long after the last, which would blur an idle
+    // stretch into the interval.
+    if (limit->sample.time_ms != 0 && elapsed < 2 * CONCURRENCY_INTERVAL && sample.total > limit->sample.total) {
+        double cpu_busy = (double)(sample.busy - limit->sample.busy) / (sample.total - limit->sample.total);
+        double cpu_pressure = -1;
+        if (sample.stalled != 0) cpu_pressure = (double)(sample.stalled - limit->sample.stalled) / (elapsed * 1000);
+
+        concurrency_update(limit, cpu_busy, cpu_pressure);
+    } else {
+        limit->limited = 0;
+    }
+
+    limit->sample = sample;
+    return CONCURRENCY_INTERVAL;
+}
+
+void destroy_concurrency_limit(ConcurrencyLimit limit) {
+    free(limit);
+}
@@ -0,0 +1,181 @@
+/******************************************************************************
+ *                              SERVER CONFIG                                 *
+ *                                                                            *
+ *   The Server Config module parses the command line of the server process.  *
+ *   The positional arguments are, in order, the output folder, the number    *
+ * of parallel tasks, which is the most workers the pool grows to, and,       *
+ * optionally, the escalation policy. Every other setting is an optional      *
+ * "--name=value" argument, that may appear anywhere on the command line.     *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "server/config.h"
+#include "server/reply.h"
+#include "common/util/alloc.h"
+#include "common/util/string.h"
+
+/**
+ * @brief Checks whether an argument is the option with the given name, and points value to its value if it is.
+ */
+static int match_option(const char* arg, const char* name, const char** value) {
+    size_t name_len = strlen(name);
+    if (!STRING_BEGIN_EQUAL(arg, name, name_len) || arg[name_len] != '=') return 0;
+
+    *value = arg + name_len + 1;
+    return 1;
+}
+
+ServerConfig parse_server_config(int argc, char const* argv[]) {
+    #define ERR NULL
+
+    ServerConfig config = SAFE_ALLOC(ServerConfig, sizeof(SERVER_CONFIG));
+    config->escalation_policy = DEFAULT_ESCALATION_POLICY;
+    config->transport = SERVER_TRANSPORT_BOTH;
+    config->reply_timeout = DEFAULT_REPLY_TIMEOUT;
+    config->aging_rate = DEFAULT_AGING_RATE;
+    config->fair_share_quantum = DEFAULT_FAIR_SHARE_QUANTUM;
+    config->prefetch = DEFAULT_PREFETCH;
+    config->min_workers = -1;
+    config->idle_timeout = DEFAULT_IDLE_TIMEOUT;
+    config->min_concurrency = -1;
+    config->pin_cpus = 0;
+    config->timeout_factor = DEFAULT_TIMEOUT_FACTOR;
+    config->max_backlog = DEFAULT_MAX_BACKLOG;
+    config->max_client_tasks = DEFAULT_MAX_CLIENT_TASKS;
+
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = NULL;
+
+        if (!STRING_BEGIN_EQUAL(arg, "--", 2)) {
+            switch (positional++) {
+                case 0: config->output_folder = (char*)arg; break;
+                case 1: config->parallel_tasks = atoi(arg); break;
+                case 2: config->escalation_policy = (char*)arg; break;
+                default: {
+                    printf("Unexpected argument '%s'.\n", arg);
+                    goto err;
+                }
+            }
+        } else if (match_option(arg, "--transport", &value)) {
+            if (STRING_EQUAL(value, "fifo")) config->transport = SERVER_TRANSPORT_FIFO;
+            else if (STRING_EQUAL(value, "socket")) config->transport = SERVER_TRANSPORT_SOCKET;
+            else if (STRING_EQUAL(value, "both")) config->transport = SERVER_TRANSPORT_BOTH;
+            else {
+                printf("Invalid transport '%s'.\n", value);
+                goto err;
+            }
+        } else if (match_option(arg, "--reply-timeout", &value)) {
+            config->reply_timeout = atoi(value);
+            if (config->reply_timeout <= 0) {
+                printf("The reply timeout must be positive.\n");
+                goto err;
+            }
+        } else if (match_option(arg, "--aging", &value)) {
+            char* end = NULL;
+            config->aging_rate = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || config->aging_rate < 0) {
+                printf("The aging rate must be a non-negative number.\n");
+                goto err;
+            }
+        } else if (match_option(arg, "--fair-share", &value)) {
+            char* end = NULL;
+            config->fair_share_quantum = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || config->fair_share_quantum < 0) {
+                printf("The fair-share quantum must be a non-negative number.\n");
+                goto err;
+            }
+        } else if (match_option(arg, "--prefetch", &value)) {
+            char* end = NULL;
+            config->prefetch = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || config->prefetch < 0 || config->prefetch > MAX_PREFETCH) {
+                printf("The prefetch must be a number between 0 and %d.\n", MAX_PREFETCH);
+                goto err;
+            }
+        } else if (match_option(arg, "--min-workers", &value)) {
+            char* end = NULL;
+            config->min_workers = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || config->min_workers < 0) {
+                printf("The minimum number of workers must be a non-negative number.\n");
+                goto err;
+            }
+        } else if (match_option(arg, "--idle-timeout", &value)) {
+            char* end = NULL;
+            config->idle_timeout = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || config->idle_timeout <= 0) {
+                printf("The idle timeout must be a positive number.\n");
+                goto err;
+            }
+        } else if (match_option(arg, "--affinity", &value)) {
+            if (STRING_EQUAL(value, "none")) config->pin_cpus = 0;
+            else if (STRING_EQUAL(value, "cores")) config->pin_cpus = 1;
+            else {
+                printf("Invalid affinity '%s'.\n", value);
+                goto err;
+            }
+        } else if (match_option(arg, "--min-concurrency", &value)) {
+            char* end = NULL;
+            config->min_concurrency = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || config->min_concurrency <= 0) {
+                printf("The minimum concurrency must be a positive number.\n");
+                goto err;
+            }
+        } else if (match_option(arg, "--timeout", &value)) {
+            char* end = NULL;
+            config->timeout_factor = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || config->timeout_factor < 0) {
+                printf("The timeout must be a non-negative number.\n");
+                goto err;
+            }
+        } else if (match_option(arg, "--max-backlog", &value)) {
+            char* end = NULL;
+            config->max_backlog = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || config->max_backlog < 0) {
+                printf("The maximum backlog must be a non-negative number.\n");
+                goto err;
+            }
+        } else if (match_option(arg, "--max-client-tasks", &value)) {
+            char* end = NULL;
+            config->max_client_tasks = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || config->max_client_tasks < 0) {
+                printf("The maximum tasks per client must be a non-negative number.\n");
+                goto err;
+            }
+        } else {
+            printf("Unknown option '%s'.\n", arg);
+            goto err;
+        }
+    }
+
+    if (positional < 2) goto err;
+    if (config->parallel_tasks <= 0) {
+        printf("The number of parallel tasks must be positive.\n");
+        goto err;
+    }
+
+    // Without a minimum, the pool never shrinks.
+    if (config->min_workers == -1) config->min_workers = config->parallel_tasks;
+    if (config->min_workers > config->parallel_tasks) {
+        printf("The minimum number of workers can not exceed the number of parallel tasks.\n");
+        goto err;
+    }
+
+    // Without a minimum, the concurrency limit is fixed at the number of parallel tasks.
+    if (config->min_concurrency == -1) config->min_concurrency = config->parallel_tasks;
+    if (config->min_concurrency > config->parallel_tasks) {
+        printf("The minimum concurrency can not exceed the number of parallel tasks.\n");
+        goto err;
+    }
+
+    return config;
+
+    err: {
+        printf(SERVER_USAGE);
+        free(config);
+        return ERR;
+    }
+    #undef ERR
+}
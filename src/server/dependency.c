@@ -0,0 +1,130 @@
+/******************************************************************************
+ *                              DEPENDENCY GRAPH                              *
+ *                                                                            *
+ *   The Dependency Graph holds back the tasks that depend on other tasks     *
+ * until every one of them completed successfully, so that multi-step jobs    *
+ * can be queued at once instead of being driven by a script polling status.  *
+ *   Every task that has not completed yet is a node, whether it is held,     *
+ * queued or running. A node counts the parents it still waits for, and lists *
+ * its children, so that completing a task releases its children in time      *
+ * proportional to the number of edges, without ever scanning the graph.      *
+ *   A task that depends on a failed, cancelled or unknown task is cancelled, *
+ * and so is every task depending on it in turn. The ids of failed tasks are  *
+ * kept for the whole life of the graph, so that later tasks can still be     *
+ * told apart from tasks depending on one that succeeded.                     *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include "server/dependency.h"
+
+static void destroy_dependency_node(gpointer data) {
+    DependencyNode node = (DependencyNode)data;
+    if (node->children != NULL) g_array_free(node->children, TRUE);
+    free(node);
+}
+
+DependencyGraph create_dependency_graph() {
+    DependencyGraph graph = calloc(1, sizeof(DEPENDENCY_GRAPH));
+    if (graph == NULL) return NULL;
+
+    graph->nodes = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, destroy_dependency_node);
+    graph->failed = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    return graph;
+}
+
+static inline DependencyNode find_dependency_node(DependencyGraph graph, int id) {
+    return (DependencyNode)g_hash_table_lookup(graph->nodes, GINT_TO_POINTER(id));
+}
+
+static inline void mark_dependency_failed(DependencyGraph graph, int id) {
+    g_hash_table_add(graph->failed, GINT_TO_POINTER(id));
+}
+
+DependencyState dependency_graph_add(DependencyGraph graph, int id, const int* parents, int num_parents, gpointer data) {
+    // Check every parent first, so that a cancelled task leaves no edge behind.
+    for (int i = 0; i < num_parents; i++) {
+        int parent = parents[i];
+        if (
+            parent <= 0
+            || parent >= id
+            || parent > graph->last_id
+            || g_hash_table_contains(graph->failed, GINT_TO_POINTER(parent))
+        ) {
+            if (id > graph->last_id) graph->last_id = id;
+            mark_dependency_failed(graph, id);
+            return DEPENDENCY_CANCELLED;
+        }
+    }
+
+    DependencyNode node = calloc(1, sizeof(DEPENDENCY_NODE));
+    node->id = id;
+
+    // Parents no longer in the graph already completed successfully.
+    for (int i = 0; i < num_parents; i++) {
+        DependencyNode parent = find_dependency_node(graph, parents[i]);
+        if (parent == NULL) continue;
+
+        if (parent->children == NULL) parent->children = g_array_new(FALSE, FALSE, sizeof(int));
+        g_array_append_val(parent->children, id);
+        node->pending++;
+    }
+
+    if (node->pending > 0) {
+        node->data = data;
+        graph->held++;
+    }
+
+    g_hash_table_insert(graph->nodes, GINT_TO_POINTER(id), node);
+    if (id > graph->last_id) graph->last_id = id;
+
+    return (node->pending > 0) ? DEPENDENCY_HELD : DEPENDENCY_READY;
+}
+
+void dependency_graph_complete(DependencyGraph graph, int id, int succeeded, GArray* released, GArray* cancelled) {
+    DependencyNode node = find_dependency_node(graph, id);
+    if (node == NULL) return;
+
+    g_hash_table_steal(graph->nodes, GINT_TO_POINTER(id));
+    if (!succeeded) mark_dependency_failed(graph, id);
+
+    for (guint i = 0; node->children != NULL && i < node->children->len; i++) {
+        // Children cancelled through another parent are already gone.
+        DependencyNode child = find_dependency_node(graph, g_array_index(node->children, int, i));
+        if (child == NULL) continue;
+
+        if (succeeded) {
+            if (--child->pending > 0) continue;
+
+            g_array_append_val(released, child->data);
+            child->data = NULL;
+            graph->held--;
+        } else {
+            // Held children never ran, so their own children are cancelled in turn.
+            g_array_append_val(cancelled, child->data);
+            child->data = NULL;
+            graph->held--;
+            dependency_graph_complete(graph, child->id, 0, released, cancelled);
+        }
+    }
+
+    destroy_dependency_node(node);
+}
+
+void destroy_dependency_graph(DependencyGraph graph, GDestroyNotify destroy) {
+    if (graph == NULL) return;
+
+    if (destroy != NULL) {
+        GHashTableIter iter;
+        gpointer value;
+        g_hash_table_iter_init(&iter, graph->nodes);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+            DependencyNode node = (DependencyNode)value;
+            if (node->data != NULL) destroy(node->data);
+        }
+    }
+
+    g_hash_table_destroy(graph->nodes);
+    g_hash_table_destroy(graph->failed);
+    free(graph);
+}
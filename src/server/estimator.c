@@ -0,0 +1,258 @@
+/******************************************************************************
+ *                             RUNTIME ESTIMATOR                              *
+ *                                                                            *
+ *   The Runtime Estimator learns how long tasks take from the tasks the      *
+ * operator already ran, so that the escalation policies do not have to trust *
+ * the time estimated by the client.                                          *
+ *   Tasks are grouped by the shape of their command: the name of every       *
+ * program, its options, and the kind of every other argument. Each group     *
+ * keeps an exponentially weighted moving average and variance of the time    *
+ * its tasks took, and is only trusted once it has seen enough tasks and the  *
+ * time they took is consistent.                                              *
+ *   The estimates are kept in a file in the output folder, so that they      *
+ * survive restarts of the server.                                            *
+ ******************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "server/estimator.h"
+#include "common/error.h"
+#include "common/util/string.h"
+
+#define ESTIMATOR_SEPARATORS " \t\n"
+
+/**
+ * @brief Loads the estimates saved to a file. Lines that can not be read are skipped.
+ */
+static void load_estimator(Estimator estimator) {
+    FILE* file = fopen(estimator->path, "r");
+    if (file == NULL) return;
+
+    char* line = NULL;
+    size_t line_cap = 0;
+    ssize_t line_len;
+    while ((line_len = getline(&line, &line_cap, file)) != -1) {
+        if (line_len > 0 && line[line_len - 1] == '\n') line[--line_len] = '\0';
+
+        // <samples> <mean> <variance> <key>, where the key is the rest of the line.
+        ESTIMATOR_ENTRY entry = { 0 };
+        int key_offset = 0;
+        if (sscanf(line, "%u %lf %lf %n", &entry.samples, &entry.mean, &entry.variance, &key_offset) != 3) continue;
+        if (key_offset == 0 || line[key_offset] == '\0' || entry.mean < 0 || entry.variance < 0) continue;
+        if (g_hash_table_size(estimator->entries) >= ESTIMATOR_MAX_ENTRIES) break;
+
+        EstimatorEntry stored = malloc(sizeof(ESTIMATOR_ENTRY));
+        char* key = strdup(line + key_offset);
+        if (stored == NULL || key == NULL) {
+            free(stored);
+            free(key);
+            break;
+        }
+
+        *stored = entry;
+        g_hash_table_insert(estimator->entries, key, stored);
+    }
+
+    free(line);
+    fclose(file);
+}
+
+Estimator create_estimator(const char* path) {
+    #define ERR NULL
+    Estimator estimator = malloc(sizeof(ESTIMATOR));
+    if (estimator == NULL) return ERR;
+
+    estimator->entries = g_hash_table_new_full(g_str_hash, g_str_equal, free, free);
+    estimator->path = (path != NULL) ? strdup(path) : NULL;
+    estimator->unsaved = 0;
+    if (path != NULL && estimator->path == NULL) {
+        destroy_estimator(estimator);
+        return ERR;
+    }
+
+    if (estimator->path != NULL) load_estimator(estimator);
+
+    return estimator;
+    #undef ERR
+}
+
+/**
+ * @brief Returns the kind of an argument, as it appears in the key of a group.
+ */
+static const char* get_argument_kind(const char* arg) {
+    const char* digits = arg;
+    if (*digits == '-' || *digits == '+') digits++;
+
+    int numeric = (*digits != '\0');
+    for (const char* c = digits; *c != '\0' && numeric; c++) {
+        if (!isdigit((unsigned char)*c) && *c != '.') numeric = 0;
+    }
+
+    if (numeric) return "#";
+    if (strchr(arg, '/') != NULL) return "/";
+    return "*";
+}
+
+char* get_estimator_key(const char* command, size_t command_len) {
+    #define ERR NULL
+    char* copy = strndup(command, command_len);
+    if (copy == NULL) return ERR;
+
+    StringBuilder sb = create_string_builder(command_len + 1);
+    if (sb == NULL) {
+        free(copy);
+        return ERR;
+    }
+
+    int failed = 0;
+    char* stage_save = NULL;
+    for (
+        char* stage = strtok_r(copy, "|", &stage_save);
+        stage != NULL && !failed;
+        stage = strtok_r(NULL, "|", &stage_save)
+    ) {
+        char* arg_save = NULL;
+        char* program = strtok_r(stage, ESTIMATOR_SEPARATORS, &arg_save);
+        if (program == NULL) continue;
+
+        // The same program is grouped together no matter where it is run from.
+        char* name = strrchr(program, '/');
+        name = (name != NULL && name[1] != '\0') ? name + 1 : program;
+        failed |= string_builder_append(sb, "%s%s", (sb->len > 0) ? " | " : "", name);
+
+        for (
+            char* arg = strtok_r(NULL, ESTIMATOR_SEPARATORS, &arg_save);
+            arg != NULL && !failed;
+            arg = strtok_r(NULL, ESTIMATOR_SEPARATORS, &arg_save)
+        ) {
+            // Options usually change what a program does, so they are kept. Their values are not.
+            if (arg[0] == '-' && arg[1] != '\0' && !STRING_EQUAL(get_argument_kind(arg), "#")) {
+                char* value = strchr(arg, '=');
+                if (value != NULL) *value++ = '\0';
+
+                failed |= string_builder_append(sb, " %s", arg);
+                if (value != NULL) failed |= string_builder_append(sb, "=%s", get_argument_kind(value));
+            } else {
+                failed |= string_builder_append(sb, " %s", get_argument_kind(arg));
+            }
+        }
+    }
+
+    free(copy);
+    char* key = finish_string_builder(sb, NULL);
+    if (failed || key[0] == '\0') {
+        free(key);
+        return ERR;
+    }
+
+    return key;
+    #undef ERR
+}
+
+void estimator_observe(Estimator estimator, const char* command, size_t command_len, uint32_t time) {
+    char* key = get_estimator_key(command, command_len);
+    if (key == NULL) return;
+
+    EstimatorEntry entry = g_hash_table_lookup(estimator->entries, key);
+    if (entry == NULL) {
+        if (g_hash_table_size(estimator->entries) >= ESTIMATOR_MAX_ENTRIES) {
+            free(key);
+            return;
+        }
+
+        entry = malloc(sizeof(ESTIMATOR_ENTRY));
+        if (entry == NULL) {
+            free(key);
+            return;
+        }
+
+        entry->mean = time;
+        entry->variance = 0;
+        entry->samples = 0;
+        g_hash_table_insert(estimator->entries, key, entry);
+    } else {
+        // Incremental form of the exponentially weighted variance, which needs no history of observations.
+        double diff = time - entry->mean;
+        double increment = ESTIMATOR_ALPHA * diff;
+        entry->mean += increment;
+        entry->variance = (1 - ESTIMATOR_ALPHA) * (entry->variance + diff * increment);
+        free(key);
+    }
+
+    if (entry->samples < UINT32_MAX) entry->samples++;
+
+    if (estimator->path != NULL && ++estimator->unsaved >= ESTIMATOR_SAVE_INTERVAL) save_estimator(estimator);
+}
+
+int estimator_predict(Estimator estimator, const char* command, size_t command_len, uint32_t* estimate) {
+    char* key = get_estimator_key(command, command_len);
+    if (key == NULL) return 0;
+
+    EstimatorEntry entry = g_hash_table_lookup(estimator->entries, key);
+    free(key);
+    if (entry == NULL || entry->samples < ESTIMATOR_MIN_SAMPLES) return 0;
+
+    // Compared squared, to avoid taking the square root of the variance.
+    double max_deviation = ESTIMATOR_MAX_DEVIATION * entry->mean + ESTIMATOR_DEVIATION_SLACK;
+    if (entry->variance > max_deviation * max_deviation) return 0;
+
+    *estimate = (uint32_t)(entry->mean + 0.5);
+    return 1;
+}
+
+int save_estimator(Estimator estimator) {
+    #define ERR 1
+    if (estimator->path == NULL) return ERR;
+    estimator->unsaved = 0;
+
+    StringBuilder sb = create_string_builder(64 * (g_hash_table_size(estimator->entries) + 1));
+    if (sb == NULL) return ERR;
+
+    int failed = 0;
+    GHashTableIter iter;
+    gpointer key, value;
+    g_hash_table_iter_init(&iter, estimator->entries);
+    while (g_hash_table_iter_next(&iter, &key, &value) && !failed) {
+        EstimatorEntry entry = (EstimatorEntry)value;
+        failed |= string_builder_append(sb, "%u %.3f %.3f %s\n", entry->samples, entry->mean, entry->variance, (char*)key);
+    }
+
+    size_t len = 0;
+    char* str = finish_string_builder(sb, &len);
+    char* tmp_path = isnprintf("%s.tmp", estimator->path);
+    if (failed || tmp_path == NULL) {
+        free(str);
+        free(tmp_path);
+        return ERR;
+    }
+
+    // Written aside and renamed over the old file, so that a crash never leaves a truncated file behind.
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd != -1) {
+        failed = (write(fd, str, len) != (ssize_t)len);
+        failed |= (close(fd) == -1);
+        if (!failed) failed = (rename(tmp_path, estimator->path) == -1);
+        if (failed) unlink(tmp_path);
+    }
+    if (fd == -1 || failed) {
+        perror(ERROR_STR_HEADER "Unable to save estimates");
+        failed = 1;
+    }
+
+    free(str);
+    free(tmp_path);
+    return failed ? ERR : 0;
+    #undef ERR
+}
+
+void destroy_estimator(Estimator estimator) {
+    g_hash_table_destroy(estimator->entries);
+    free(estimator->path);
+    free(estimator);
+}
@@ -0,0 +1,122 @@
+/******************************************************************************
+ *                                FAIR QUEUE                                  *
+ *                                                                            *
+ *   The Fair Queue shares the workers between the clients that submit        *
+ * tasks, so that a client that submits many tasks at once can not keep every *
+ * other client waiting until they are all done.                              *
+ *   Every tenant gets its own Priority Queue, ordered by the escalation      *
+ * policy, and tenants take turns through deficit round-robin: on its turn, a *
+ * tenant is credited a quantum of time, and its tasks are dispatched while   *
+ * their estimated time fits in its credit. Tenants with no queued tasks are  *
+ * forgotten, along with their credit.                                        *
+ *   With a quantum of 0, every task is queued for the same tenant, and the   *
+ * queue behaves exactly like a single Priority Queue.                        *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include "server/fair_queue.h"
+
+static void destroy_fair_queue_tenant(gpointer data) {
+    FairQueueTenant tenant = (FairQueueTenant)data;
+
+    destroy_priority_queue(tenant->queue);
+    free(tenant);
+}
+
+FairQueue create_fair_queue(uint32_t quantum, FairQueueCostFunc cost, GCompareDataFunc compare, gpointer user_data) {
+    FairQueue queue = malloc(sizeof(FAIR_QUEUE));
+    if (queue == NULL) return NULL;
+
+    queue->tenants = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, destroy_fair_queue_tenant);
+    queue->active = g_queue_new();
+    queue->length = 0;
+    queue->quantum = quantum;
+    queue->cost = cost;
+    queue->compare = compare;
+    queue->user_data = user_data;
+
+    return queue;
+}
+
+int fair_queue_push(FairQueue queue, int tenant_id, gpointer data) {
+    if (queue->quantum == 0) tenant_id = 0;
+
+    FairQueueTenant tenant = g_hash_table_lookup(queue->tenants, GINT_TO_POINTER(tenant_id));
+    if (tenant == NULL) {
+        tenant = malloc(sizeof(FAIR_QUEUE_TENANT));
+        if (tenant == NULL) return 1;
+
+        tenant->queue = create_priority_queue(queue->compare, queue->user_data);
+        if (tenant->queue == NULL) {
+            free(tenant);
+            return 1;
+        }
+
+        tenant->id = tenant_id;
+        tenant->deficit = 0;
+        tenant->in_turn = 0;
+        g_hash_table_insert(queue->tenants, GINT_TO_POINTER(tenant_id), tenant);
+
+        // New tenants wait for their turn behind the tenants already queued.
+        g_queue_push_tail(queue->active, tenant);
+    }
+
+    if (priority_queue_push(tenant->queue, data) != 0) return 1;
+    queue->length++;
+
+    return 0;
+}
+
+/**
+ * @brief Returns the cost of an element, capped so that a tenant can always afford it within a bounded number of turns.
+ */
+static inline int64_t get_fair_queue_cost(FairQueue queue, gconstpointer data) {
+    int64_t cost = queue->cost(data);
+    int64_t max_cost = (int64_t)queue->quantum * FAIR_QUEUE_MAX_COST_QUANTA;
+
+    return (cost < max_cost) ? cost : max_cost;
+}
+
+gpointer fair_queue_pop(FairQueue queue) {
+    if (queue->length == 0) return NULL;
+
+    for (;;) {
+        FairQueueTenant tenant = g_queue_peek_head(queue->active);
+        gpointer data = priority_queue_peek(tenant->queue);
+
+        if (queue->quantum != 0) {
+            if (!tenant->in_turn) {
+                tenant->deficit += queue->quantum;
+                tenant->in_turn = 1;
+            }
+
+            // Out of credit: end the turn, and let the next tenant go.
+            int64_t cost = get_fair_queue_cost(queue, data);
+            if (cost > tenant->deficit) {
+                tenant->in_turn = 0;
+                g_queue_push_tail(queue->active, g_queue_pop_head(queue->active));
+                continue;
+            }
+            tenant->deficit -= cost;
+        }
+
+        priority_queue_pop(tenant->queue);
+        queue->length--;
+
+        // Idle tenants do not keep their credit, or they could later take more than their share.
+        if (tenant->queue->length == 0) {
+            g_queue_pop_head(queue->active);
+            g_hash_table_remove(queue->tenants, GINT_TO_POINTER(tenant->id));
+        }
+
+        return data;
+    }
+}
+
+void destroy_fair_queue(FairQueue queue) {
+    if (queue == NULL) return;
+
+    g_queue_free(queue->active);
+    g_hash_table_destroy(queue->tenants);
+    free(queue);
+}
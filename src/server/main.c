@@ -11,6 +11,7 @@
 
 #define _POSIX_C_SOURCE 199309L
 #define _DEFAULT_SOURCE
+#define _GNU_SOURCE
 #define _CRITICAL
 
 #include <fcntl.h>
@@ -19,19 +20,34 @@
 #include <signal.h>
 #include <sys/wait.h>
 #include <time.h>
+#include <poll.h>
+#include <errno.h>
+#include <stddef.h>
+#include <sys/socket.h>
 
 #include "common/io/io.h"
 #include "common/io/fifo.h"
+#include "common/io/buffer.h"
+#include "common/io/socket.h"
 #include "common/datagram/datagram.h"
 #include "common/datagram/execute.h"
 #include "common/datagram/status.h"
 #include "common/util/string.h"
+#include "server/config.h"
 #include "server/operator.h"
-#include "server/process_mark.h"
+#include "server/admission.h"
+#include "server/ring.h"
+#include "server/reply.h"
+#include "server/snapshot.h"
 
 #define LOG_HEADER "[MAIN] "
 #define SHUTDOWN_TIMEOUT 2000
 #define SHUTDOWN_TIMEOUT_INTERVAL 10
+#define REQUEST_BUFFER_LEN (16 * PIPE_BUF)
+
+#define POLL_FIFO 0
+#define POLL_SOCKET 1
+#define POLL_FIRST_CONNECTION 2
 
 volatile sig_atomic_t shutdown_requested = 0;
 
@@ -41,6 +57,187 @@ void signal_handler_shutdown(int sig) {
     }
 }
 
+/**
+ * @brief Processes a single request datagram, replies to the client that sent it and forwards it to the operator
+ * process.
+ * 
+ * @param datagram      The bytes of the datagram, starting at its header.
+ * @param size          The size of the datagram.
+ * @param replies       The queue the replies to the client go through.
+ * @param reply_target  The client that sent the request.
+ * @param operator_ring The ring of the operator process.
+ * @param snapshot      The status snapshot kept by the operator process.
+ * @param admission     The admission control. Requests it refuses are answered as busy and never forwarded.
+ * @param id            The last task identifier handed out. Updated if a new task is queued.
+ */
+static int process_request(
+    uint8_t* datagram, 
+    size_t size, 
+    ReplyQueue replies, 
+    REPLY_TARGET reply_target, 
+    Ring operator_ring, 
+    Snapshot snapshot, 
+    Admission admission, 
+    int* id
+) {
+    DATAGRAM_HEADER header;
+    memcpy(&header, datagram, sizeof(DATAGRAM_HEADER));
+
+    printf(LOG_HEADER "New request recieved.\n");
+
+    #ifdef DEBUG
+    char* dh_str = datagram_header_to_string(&header, 1);
+    printf(LOG_HEADER "Request Header: %s\n", dh_str);
+    free(dh_str);
+    #endif
+
+    if(header.mode == DATAGRAM_MODE_EXECUTE_REQUEST) {
+        DEBUG_PRINT(LOG_HEADER "Processing Execute Request.\n");
+
+        ExecuteResponseDatagram response = create_execute_response_datagram();
+        response->header.request_id = header.request_id;
+
+        // Refused requests are not given an id, so that ids keep matching the tasks queued.
+        uint32_t retry_after = admission_admit(admission, header.pid, 1);
+        if (retry_after != 0) {
+            response->status = EXECUTE_STATUS_BUSY;
+            response->retry_after = retry_after;
+            send_reply(replies, reply_target, response, sizeof(EXECUTE_RESPONSE_DATAGRAM));
+            printf(LOG_HEADER "Server busy. Client %d told to retry after %ums.\n", header.pid, retry_after);
+
+            free(response);
+            return 0;
+        }
+
+        response->taskid = ++(*id);
+        send_reply(replies, reply_target, response, sizeof(EXECUTE_RESPONSE_DATAGRAM));
+
+        // Forward the request and its id as a single message.
+        struct iovec forward[] = {
+            { .iov_base = datagram, .iov_len = size },
+            { .iov_base = id, .iov_len = sizeof(int) }
+        };
+        if (ring_write(operator_ring, RING_MESSAGE_SERVER, forward, 2) != 0) {
+            printf(LOG_HEADER "Unable to forward request to operator.\n");
+            admission_revoke(admission, header.pid, 1);
+        }
+
+        printf(LOG_HEADER "Task with identifier %d queued.\n", *id);
+
+        free(response);
+
+        DEBUG_PRINT(LOG_HEADER "Execute Request finalized.\n");
+    } else if(header.mode == DATAGRAM_MODE_EXECUTE_BATCH_REQUEST) {
+        DEBUG_PRINT(LOG_HEADER "Processing Execute Batch Request.\n");
+
+        ExecuteBatchResponseDatagram response = create_execute_batch_response_datagram();
+        response->header.request_id = header.request_id;
+        EXECUTE_BATCH_REQUEST_DATAGRAM request;
+        memcpy(&request, datagram, sizeof(EXECUTE_BATCH_REQUEST_DATAGRAM));
+
+        // The operator queues the entries it finds, so ids and admission must be counted from them, not from the header.
+        int num_entries = count_execute_batch_entries(
+            datagram + sizeof(EXECUTE_BATCH_REQUEST_DATAGRAM), 
+            request.payload_len
+        );
+        if (num_entries <= 0 || num_entries != request.num_tasks) {
+            response->status = EXECUTE_STATUS_INVALID;
+            send_reply(replies, reply_target, response, sizeof(EXECUTE_BATCH_RESPONSE_DATAGRAM));
+            printf(LOG_HEADER "Rejected malformed batch from client %d.\n", header.pid);
+
+            free(response);
+            return 0;
+        }
+        response->num_tasks = num_entries;
+
+        // A batch is admitted or refused as a whole, since its tasks may depend on each other.
+        uint32_t retry_after = admission_admit(admission, header.pid, response->num_tasks);
+        if (retry_after != 0) {
+            response->status = EXECUTE_STATUS_BUSY;
+            response->retry_after = retry_after;
+            send_reply(replies, reply_target, response, sizeof(EXECUTE_BATCH_RESPONSE_DATAGRAM));
+            printf(LOG_HEADER "Server busy. Client %d told to retry after %ums.\n", header.pid, retry_after);
+
+            free(response);
+            return 0;
+        }
+
+        response->first_taskid = *id + 1;
+        *id += response->num_tasks;
+        send_reply(replies, reply_target, response, sizeof(EXECUTE_BATCH_RESPONSE_DATAGRAM));
+
+        // Forward the whole batch and its first id as a single message.
+        struct iovec forward[] = {
+            { .iov_base = datagram, .iov_len = size },
+            { .iov_base = &response->first_taskid, .iov_len = sizeof(int) }
+        };
+        if (ring_write(operator_ring, RING_MESSAGE_SERVER, forward, 2) != 0) {
+            printf(LOG_HEADER "Unable to forward request to operator.\n");
+            admission_revoke(admission, header.pid, response->num_tasks);
+        }
+
+        printf(
+            LOG_HEADER "Tasks with identifiers %d to %d queued.\n", 
+            response->first_taskid, 
+            response->first_taskid + response->num_tasks - 1
+        );
+
+        free(response);
+
+        DEBUG_PRINT(LOG_HEADER "Execute Batch Request finalized.\n");
+    } else if(header.mode == DATAGRAM_MODE_STATUS_REQUEST) {
+        DEBUG_PRINT(LOG_HEADER "Processing Status Request.\n");
+
+        STATUS_REQUEST_DATAGRAM request;
+        memcpy(&request, datagram, sizeof(STATUS_REQUEST_DATAGRAM));
+
+        // Answered straight from the snapshot kept by the operator, without a round-trip to it.
+        SNAPSHOT_SHARED copy;
+        read_snapshot(snapshot, &copy);
+
+        size_t report_len = 0;
+        char* report = snapshot_to_string(&copy, request.sections, request.completed_limit, &report_len);
+        if (report == NULL) return 1;
+
+        // The report is streamed in bounded chunks, the last one marked as such.
+        StatusResponseDatagram response = create_status_response_datagram(NULL, STATUS_RESPONSE_DATAGRAM_MAX_PAYLOAD_LEN);
+        response->header.request_id = header.request_id;
+
+        size_t offset = 0;
+        do {
+            size_t chunk_len = report_len - offset;
+            if (chunk_len > STATUS_RESPONSE_DATAGRAM_MAX_PAYLOAD_LEN) chunk_len = STATUS_RESPONSE_DATAGRAM_MAX_PAYLOAD_LEN;
+
+            memcpy(response->payload, report + offset, chunk_len);
+            response->payload_len = chunk_len;
+            offset += chunk_len;
+            response->last = (offset == report_len);
+
+            send_reply(replies, reply_target, response, sizeof(STATUS_RESPONSE_DATAGRAM) + chunk_len);
+        } while (offset < report_len);
+
+        printf(LOG_HEADER "Status request answered.\n");
+
+        free(response);
+        free(report);
+
+        DEBUG_PRINT(LOG_HEADER "Status Request finalized.\n");
+    } else if(header.mode == DATAGRAM_MODE_CLOSE_REQUEST) {
+        DEBUG_PRINT(LOG_HEADER "Processing Close request.\n");
+
+        DATAGRAM_HEADER response = create_datagram_header();
+        response.mode = DATAGRAM_MODE_CLOSE_RESPONSE;
+        response.request_id = header.request_id;
+
+        send_reply(replies, reply_target, &response, sizeof(DATAGRAM_HEADER));
+
+        // Request shutdown and fallthrough.
+        shutdown_requested = 1;
+    }
+
+    return 0;
+}
+
 int main(int argc, char const *argv[]) {
     #define ERR 1
 
@@ -66,11 +263,11 @@ int main(int argc, char const *argv[]) {
 
     pid_t pid = getpid();
 
-    if(argc < 3) {
-        printf("Usage: $ server <output_folder> <number_of_parallel_tasks> [escalation_policy]\n");
+    ServerConfig config = parse_server_config(argc, argv);
+    if(config == NULL) {
         exit(EXIT_FAILURE);
     } else {
-        char* output_folder = (char*) argv[1];
+        char* output_folder = config->output_folder;
         CREATE_DIR(output_folder, 0700);
 
         CRITICAL_START
@@ -78,15 +275,38 @@ int main(int argc, char const *argv[]) {
             int id_fd = SAFE_OPEN(id_file_path, O_RDWR | O_CREAT, 0600);
 
             char* history_file_path = join_paths(2, output_folder, "history");
+            char* estimates_file_path = join_paths(2, output_folder, "estimates");
 
             char* server_fifo_path = join_paths(2, "build/", SERVER_FIFO);
-            SAFE_FIFO_SETUP(server_fifo_path, 0600);
+            if (config->transport & SERVER_TRANSPORT_FIFO) SAFE_FIFO_SETUP(server_fifo_path, 0600);
 
             int id = SETUP_ID(id_fd);
 
             int _main_pid = getpid();
 
-            OPERATOR operator = start_operator(atoi(argv[2]), output_folder, history_file_path, (char*) argv[3]);
+            // Created before the operator is forked, so that both share its counters.
+            Admission admission = create_admission(config->max_backlog, config->max_client_tasks);
+            if (admission == NULL) {
+                printf(LOG_HEADER "Unable to set up admission control. Shutting down.\n");
+                shutdown_requested = 1;
+            }
+
+            OPERATOR operator = start_operator(
+                config->parallel_tasks, 
+                output_folder, 
+                history_file_path, 
+                estimates_file_path, 
+                config->escalation_policy, 
+                config->aging_rate, 
+                config->fair_share_quantum, 
+                config->prefetch, 
+                config->min_workers, 
+                config->idle_timeout, 
+                config->min_concurrency, 
+                config->pin_cpus, 
+                config->timeout_factor, 
+                admission
+            );
             if (operator.pid == 0) {
                 if (_main_pid != getpid()) {
                     _exit(0);
@@ -95,110 +315,153 @@ int main(int argc, char const *argv[]) {
                 printf(LOG_HEADER "Unable to start operator. Shutting down.\n");
                 shutdown_requested = 1;
             }
-            int operator_pd = operator.pd_write;
+            Ring operator_ring = operator.ring;
+
+            // Every connection gets a slot on the poll set, after the FIFO and the listening socket. Disabled
+            // transports keep a negative file descriptor, which poll ignores.
+            nfds_t poll_len = POLL_FIRST_CONNECTION;
+            nfds_t poll_cap = POLL_FIRST_CONNECTION + 16;
+            struct pollfd* poll_fds = SAFE_ALLOC(struct pollfd*, poll_cap * sizeof(struct pollfd));
+            poll_fds[POLL_FIFO] = (struct pollfd){ .fd = -1, .events = POLLIN };
+            poll_fds[POLL_SOCKET] = (struct pollfd){ .fd = -1, .events = POLLIN };
+
+            // Hold the server FIFO open for the whole lifetime of the server. The dummy writer keeps the read end
+            // from ever seeing EOF when the last client closes its end, so the FIFO never needs to be reopened.
+            int server_fifo_dummy_fd = -1;
+            if (config->transport & SERVER_TRANSPORT_FIFO) {
+                poll_fds[POLL_FIFO].fd = SAFE_OPEN(server_fifo_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC, 0600);
+                server_fifo_dummy_fd = SAFE_OPEN(server_fifo_path, O_WRONLY | O_CLOEXEC, 0600);
+            }
+            ReadBuffer request_buffer = create_read_buffer(REQUEST_BUFFER_LEN);
+            ReplyQueue replies = create_reply_queue(config->reply_timeout);
+
+            // A client may go away between opening its FIFO and reading the reply. The write should fail, not kill
+            // the server. Only the main server ignores it, as the operator and its workers are already forked.
+            signal(SIGPIPE, SIG_IGN);
+
+            if (config->transport & SERVER_TRANSPORT_SOCKET) {
+                poll_fds[POLL_SOCKET].fd = create_server_socket();
+                if (poll_fds[POLL_SOCKET].fd == -1) shutdown_requested = 1;
+            }
             
             int MAIN_PID = getpid();
 
-            // int operator_pd = NULL;
             DEBUG_PRINT(LOG_HEADER "Operator PID: %d\n", operator.pid);
-            DEBUG_PRINT(LOG_HEADER "Operator Pipe: %d\n", operator_pd);
         CRITICAL_END
 
         while(!shutdown_requested) {
             DEBUG_PRINT(LOG_HEADER "New cycle.\n");
 
-            // Read incoming requests.
+            // Wait for incoming requests, waking up in time to retry the replies clients were not ready for.
+            int poll_timeout = retry_replies(replies);
             CRITICAL_START
-                int server_fifo_fd = SAFE_OPEN(server_fifo_path, O_RDONLY, 0600);
+                int ready = poll(poll_fds, poll_len, poll_timeout);
             CRITICAL_END
 
             // If kill signal recieved, do not read or process requests
             if (shutdown_requested) break;
-
-            DATAGRAM_HEADER header = read_datagram_header(server_fifo_fd);
-            if (header.version == 0) {
-                // Read 0 bytes, fallback to 0.
-                close(server_fifo_fd);
-                continue;
-            } else if (header.version != DATAGRAM_VERSION) {
-                // Datagram not supported.
-                printf(LOG_HEADER "Recieved unsupported datagram with version %d:\n", header.version);
-
-                drain_fifo(server_fifo_fd);
-                close(server_fifo_fd);
+            if (ready == -1) {
+                if (errno != EINTR) perror(LOG_HEADER "Unable to poll requests");
                 continue;
             }
 
-            printf(LOG_HEADER "New request recieved.\n");
-
-            #ifdef DEBUG
-            char* dh_str = datagram_header_to_string(&header, 1);
-            printf(LOG_HEADER "Request Header: %s\n", dh_str);
-            free(dh_str);
-            #endif
-
-            char* client_fifo_name = isnprintf(CLIENT_FIFO "%d", header.pid);
-            char* client_fifo_path = join_paths(2, "build/", client_fifo_name);
-            int client_fifo_fd = SAFE_OPEN(client_fifo_path, O_WRONLY, 0600);
-
-            if(header.mode == DATAGRAM_MODE_EXECUTE_REQUEST) {
-                DEBUG_PRINT(LOG_HEADER "Processing Execute Request.\n");
-
-                ExecuteRequestDatagram request_execute = read_partial_execute_request_datagram(server_fifo_fd, header);
-
-                ExecuteResponseDatagram response = create_execute_response_datagram();
-                response->taskid = ++id;
-                SAFE_WRITE(client_fifo_fd, response, sizeof(EXECUTE_RESPONSE_DATAGRAM));
-
-                WRITE_PROCESS_MARK(operator_pd, MAIN_SERVER_PROCESS_MARK);
-                // char mark_buf[] = MAIN_SERVER_PROCESS_MARK;
-                // printf(LOG_HEADER "MARK: %d %d\n", mark_buf[0], mark_buf[1]);
-                // SAFE_WRITE(operator_pd, &mark_buf, 2 * sizeof(char));
-
-                SAFE_WRITE(operator_pd, request_execute, sizeof(EXECUTE_REQUEST_DATAGRAM));
-                SAFE_WRITE(operator_pd, &id, sizeof(int));
-
-                printf(LOG_HEADER "Task with identifier %d queued.\n", id);
-
-                // char* task_name = isnprintf(TASK "%d", id);
-                // char* task_path = join_paths(2, output_folder, task_name);
-                // int task_fd = SAFE_OPEN(task_path, O_WRONLY | O_CREAT, 0600);
-
-                // close(task_fd);
-                // free(task_path);
-                // free(task_name);
+            #pragma region ======= FIFO =======
+            if (poll_fds[POLL_FIFO].revents & POLLIN) {
+                // Drain every request currently written to the FIFO in as few reads as possible.
+                if (fill_read_buffer(request_buffer, poll_fds[POLL_FIFO].fd) == -1) {
+                    perror(LOG_HEADER "Unable to read server fifo");
+                }
 
-                DEBUG_PRINT(LOG_HEADER "Execute Request finalized.\n");
-            } else if(header.mode == DATAGRAM_MODE_STATUS_REQUEST) {
-                DEBUG_PRINT(LOG_HEADER "Processing Status Request.\n");
+                ssize_t datagram_size;
+                while (
+                    !shutdown_requested
+                    && (datagram_size = get_request_datagram_size(READ_BUFFER_HEAD(request_buffer), READ_BUFFER_LEN(request_buffer))) > 0
+                    && (size_t)datagram_size <= READ_BUFFER_LEN(request_buffer)
+                ) {
+                    DATAGRAM_HEADER header;
+                    memcpy(&header, READ_BUFFER_HEAD(request_buffer), sizeof(DATAGRAM_HEADER));
+
+                    REPLY_TARGET reply_target = { .pid = header.pid, .fd = -1 };
+                    process_request(
+                        READ_BUFFER_HEAD(request_buffer), 
+                        datagram_size, 
+                        replies, 
+                        reply_target, 
+                        operator_ring, 
+                        operator.snapshot, 
+                        admission, 
+                        &id
+                    );
+                    consume_read_buffer(request_buffer, datagram_size);
+                }
 
-                StatusRequestDatagram request_status = read_partial_status_request_datagram(server_fifo_fd, header);
+                if (datagram_size == -1) {
+                    // Datagram not supported. There is no way to find where the next datagram starts, so drop everything.
+                    DATAGRAM_HEADER header = { 0 };
+                    memcpy(&header, READ_BUFFER_HEAD(request_buffer), sizeof(DATAGRAM_HEADER));
+                    printf(LOG_HEADER "Recieved unsupported datagram with version %d:\n", header.version);
 
-                WRITE_PROCESS_MARK(operator_pd, MAIN_SERVER_PROCESS_MARK);
-                SAFE_WRITE(operator_pd, request_status, sizeof(STATUS_REQUEST_DATAGRAM));
+                    clear_read_buffer(request_buffer);
+                }
+            }
+            #pragma endregion
+
+            #pragma region ======= SOCKET =======
+            if (poll_fds[POLL_SOCKET].revents & POLLIN) {
+                // Accept every pending connection.
+                int connection_fd;
+                while ((connection_fd = accept4(poll_fds[POLL_SOCKET].fd, NULL, NULL, SOCK_CLOEXEC)) != -1) {
+                    if (poll_len == poll_cap) {
+                        poll_cap *= 2;
+                        SAFE_REALLOC(poll_fds, poll_cap * sizeof(struct pollfd));
+                    }
 
-                printf(LOG_HEADER "Status task queued.\n");
+                    poll_fds[poll_len++] = (struct pollfd){ .fd = connection_fd, .events = POLLIN };
+                    DEBUG_PRINT(LOG_HEADER "New connection %d.\n", connection_fd);
+                }
+            }
 
-                DEBUG_PRINT(LOG_HEADER "Status Request finalized.\n");
-            } else if(header.mode == DATAGRAM_MODE_CLOSE_REQUEST) {
-                DEBUG_PRINT(LOG_HEADER "Processing Close request.\n");
+            for (nfds_t i = POLL_FIRST_CONNECTION; i < poll_len && !shutdown_requested; i++) {
+                if (!poll_fds[i].revents) continue;
+
+                // Process every datagram currently sent through the connection. Each message is exactly one datagram.
+                int closed = (poll_fds[i].revents & (POLLHUP | POLLERR)) && !(poll_fds[i].revents & POLLIN);
+                while (!closed && !shutdown_requested) {
+                    uint8_t* datagram = NULL;
+                    ssize_t size = recv_message(poll_fds[i].fd, (void**)&datagram, MSG_DONTWAIT);
+                    if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                    if (size <= 0) {
+                        closed = 1;
+                        break;
+                    }
 
-                CRITICAL_START
-                    DATAGRAM_HEADER response = create_datagram_header();
-                    response.mode = DATAGRAM_MODE_CLOSE_RESPONSE;
+                    if (get_request_datagram_size(datagram, size) == size) {
+                        REPLY_TARGET reply_target = { .pid = 0, .fd = poll_fds[i].fd };
+                        process_request(
+                            datagram, 
+                            size, 
+                            replies, 
+                            reply_target, 
+                            operator_ring, 
+                            operator.snapshot, 
+                            admission, 
+                            &id
+                        );
+                    } else {
+                        printf(LOG_HEADER "Recieved unsupported datagram with version %d:\n", datagram[0]);
+                    }
 
-                    WRITE_PROCESS_MARK(operator_pd, MAIN_SERVER_PROCESS_MARK);
-                    SAFE_WRITE(client_fifo_fd, &response, sizeof(DATAGRAM_HEADER));
-                CRITICAL_END
+                    free(datagram);
+                }
 
-                // Request shutdown and fallthrough.
-                shutdown_requested = 1;
+                if (closed) {
+                    DEBUG_PRINT(LOG_HEADER "Connection %d closed.\n", poll_fds[i].fd);
+                    cancel_replies(replies, poll_fds[i].fd);
+                    close(poll_fds[i].fd);
+                    poll_fds[i--] = poll_fds[--poll_len];
+                }
             }
-
-            close(client_fifo_fd);
-            close(server_fifo_fd);
-            free(client_fifo_path);
-            free(client_fifo_name);
+            #pragma endregion
         }
 
         // Handle server shutdown
@@ -216,9 +479,9 @@ int main(int argc, char const *argv[]) {
                 DEBUG_PRINT(LOG_HEADER "Shutdown Request: %s\n", req_str);
                 #endif
                 
-                // WARN: Do not send a Process Mark when shutting down the Operator process. A SIGINT will interrupt the read.
-                // WRITE_PROCESS_MARK(operator_pd, MAIN_SERVER_PROCESS_MARK);
-                SAFE_WRITE(operator_pd, &shutdown_request, sizeof(DATAGRAM_HEADER));
+                // If the operator was interrupted by a SIGINT, it is already shutting down and never reads this.
+                struct iovec forward = { .iov_base = &shutdown_request, .iov_len = sizeof(DATAGRAM_HEADER) };
+                ring_write(operator_ring, RING_MESSAGE_SERVER, &forward, 1);
 
                 {
                     int status;
@@ -252,12 +515,25 @@ int main(int argc, char const *argv[]) {
                 }
             }
 
+            // Give the replies still pending, such as the one to a close request, a last chance.
+            retry_replies(replies);
+            printf(LOG_HEADER "Replies dropped: %lu\n", replies->dropped);
+            if (admission != NULL) printf(LOG_HEADER "Requests refused as busy: %u\n", admission->rejected);
+
             // Save current ID
             lseek(id_fd, 0, SEEK_SET);
             SAFE_WRITE(id_fd, &id, sizeof(int));
 
             // Close file descriptors
             close(id_fd);
+            for (nfds_t i = 0; i < poll_len; i++) {
+                if (poll_fds[i].fd != -1) close(poll_fds[i].fd);
+            }
+            if (server_fifo_dummy_fd != -1) close(server_fifo_dummy_fd);
+            destroy_read_buffer(request_buffer);
+            destroy_reply_queue(replies);
+            destroy_admission(admission);
+            free(poll_fds);
 
             // Delete server fifo
             unlink(server_fifo_path);
@@ -265,7 +541,9 @@ int main(int argc, char const *argv[]) {
             // Free allocated strings
             free(id_file_path);
             free(history_file_path);
+            free(estimates_file_path);
             free(server_fifo_path);
+            free(config);
 
             printf(LOG_HEADER "Successfully closed server.\n");
             exit(EXIT_SUCCESS);
@@ -3,10 +3,21 @@
  *                                                                            *
  *   The operator process is responsible for controlling and managing the     *
  * various worker processes used to parallelise the workload of the server.   *
- *   It implements an event system through the usage of anonymous pipes used  *
- * to establish a communication channel between the various worker processes  *
- * and the operator process.                                                  *
+ *   It implements an event system through a shared memory ring, written to   *
+ * by the main server and the various worker processes, and read only by the  *
+ * operator process. Tasks are sent to the workers through anonymous pipes.   *
  *   Only one operator process is supposed to be used per server instance.    *
+ *   The workers form an elastic pool: more are started while tasks wait in   *
+ * the backlog, up to the number of parallel tasks, and workers that stay idle *
+ * for too long are retired, down to the minimum. Idle workers are reused most *
+ * recently freed first, so under a light load the same few workers stay busy *
+ * and the rest idle out.                                                     *
+ *   Tasks of a higher priority class are dispatched first. If every slot is  *
+ * taken, the running task of the lowest class below theirs is suspended, and *
+ * its slot lent to them, on a worker started above the pool size if need be. *
+ * Suspended tasks resume once a slot frees up and no more urgent task waits. *
+ *   Tasks depending on other tasks are held out of the backlog until every   *
+ * one of them completed successfully, and cancelled if one of them failed.   *
  ******************************************************************************/
 
 #define _POSIX_C_SOURCE 199309L
@@ -15,10 +26,20 @@
 
 #include <sys/wait.h>
 #include <stdint.h>
+#include <limits.h>
 #include "server/operator.h"
 #include "server/worker.h"
 #include "server/worker_datagrams.h"
-#include "server/process_mark.h"
+#include "server/ring.h"
+#include "server/snapshot.h"
+#include "server/priority_queue.h"
+#include "server/fair_queue.h"
+#include "server/backlog.h"
+#include "server/dependency.h"
+#include "server/claims.h"
+#include "server/estimator.h"
+#include "server/concurrency.h"
+#include "server/topology.h"
 
 #define LOG_HEADER "[OPERATOR] "
 #define SHUTDOWN_TIMEOUT 1000
@@ -31,7 +52,9 @@
 typedef enum {
     WORKER_STATUS_UNKNOWN,
     WORKER_STATUS_IDLE,
-    WORKER_STATUS_BUSY
+    WORKER_STATUS_BUSY,
+    WORKER_STATUS_STOPPED,  // The slot has no worker, either not started yet or retired.
+    WORKER_STATUS_SUSPENDED // The running task of the worker is stopped, and its slot lent to a more urgent task.
 } OperatorStatus;
 
 /**
@@ -40,8 +63,23 @@ typedef enum {
 typedef struct operator_worker_entry {
     Worker worker;
     OperatorStatus status;
+    int id;                     // The index of the worker, which it reports back on completion.
+    GQueue* tasks;              // The tasks written to the worker, in the order it runs them. The first one is running.
+    int stolen;                 // The number of tasks stolen from the worker, that it has not skipped yet.
+    size_t queued_bytes;        // The size of the frames of the tasks of the worker, which may still sit in its pipe.
+    int64_t idle_since_ms;      // The time the worker last became idle at, in milliseconds.
+    int64_t suspended_since_ms; // The time the running task of the worker was last suspended at, in milliseconds.
 } OPERATOR_WORKER_ENTRY, *OperatorWorkerEntry;
 
+/**
+ * @brief Returns the current time, in milliseconds.
+ */
+static inline int64_t get_current_ms() {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (int64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+}
+
 #pragma region ============== SIGNAL HANDLING ==============
 // Yes, this uses a global variable, but the alternative is having the workers be orphaned after the operator dies.
 GArray* _children;
@@ -51,7 +89,8 @@ static void operator_signal_sigsegv(int signum) {
     MAIN_LOG(LOG_HEADER "Segmentation fault. Terminating workers.\n");
 
     for (guint i = 0; i < _children->len; ++i) {
-        kill(g_array_index(_children, OperatorWorkerEntry, i)->worker->pid, SIGKILL);
+        Worker worker = g_array_index(_children, OperatorWorkerEntry, i)->worker;
+        if (worker != NULL) kill(worker->pid, SIGKILL);
     }
 
     _exit(EXIT_FAILURE);
@@ -61,29 +100,50 @@ static void operator_signal_sigsegv(int signum) {
 #pragma region ============== WORKER ARRAY ==============
 typedef GArray* WorkerArray;
 
-OperatorWorkerEntry create_operator_worker_entry(Worker worker) {
+OperatorWorkerEntry create_operator_worker_entry(Worker worker, int id) {
     #define ERR NULL
 
     OperatorWorkerEntry we = SAFE_ALLOC(OperatorWorkerEntry, sizeof(OPERATOR_WORKER_ENTRY));
     we->worker = worker;
-    we->status = WORKER_STATUS_IDLE;
+    we->status = (worker != NULL) ? WORKER_STATUS_IDLE : WORKER_STATUS_STOPPED;
+    we->id = id;
+    we->tasks = g_queue_new();
+    we->stolen = 0;
+    we->queued_bytes = 0;
+    we->idle_since_ms = 0;
+    we->suspended_since_ms = 0;
 
     return we;
 
     #undef ERR
 }
 
-static inline WorkerArray create_workers_array() { // len == num_parallel_tasks + 1 (1 for status)
+static inline WorkerArray create_workers_array() { // len == num_parallel_tasks, including stopped slots
     return g_array_new(FALSE, FALSE, sizeof(OperatorWorkerEntry));
 }
 
-OperatorWorkerEntry get_idle_worker(WorkerArray workers) {
-    for (guint i = 1; i < workers->len; i++) {
-        OperatorWorkerEntry entry = g_array_index(workers, OperatorWorkerEntry, i);
-        if (entry->status == WORKER_STATUS_IDLE) return entry;
-    }
+/**
+ * @brief The idle workers, as a stack. The most recently freed worker is reused first, while its memory is still hot.
+ */
+typedef GArray* IdleWorkerStack;
 
-    return NULL;
+static inline IdleWorkerStack create_idle_worker_stack(guint num_workers) {
+    return g_array_sized_new(FALSE, FALSE, sizeof(OperatorWorkerEntry), num_workers);
+}
+
+static inline void push_idle_worker(IdleWorkerStack idle_workers, OperatorWorkerEntry entry) {
+    entry->status = WORKER_STATUS_IDLE;
+    g_array_append_val(idle_workers, entry);
+}
+
+OperatorWorkerEntry pop_idle_worker(IdleWorkerStack idle_workers) {
+    if (idle_workers->len == 0) return NULL;
+
+    OperatorWorkerEntry entry = g_array_index(idle_workers, OperatorWorkerEntry, idle_workers->len - 1);
+    g_array_set_size(idle_workers, idle_workers->len - 1);
+    entry->status = WORKER_STATUS_BUSY;
+
+    return entry;
 }
 
 static inline OperatorWorkerEntry get_worker_by_id(WorkerArray workers, int worker_id) {
@@ -95,71 +155,143 @@ static inline OperatorWorkerEntry get_worker_by_id(WorkerArray workers, int work
 
 typedef struct operator_task {
     int id_task;
-    short int speculate_time;
+    int speculate_time;      // The time the task is expected to take, learned or estimated by the client.
     WorkerDatagram datagram; // Any Worker Datagram
     int datagram_size;
     struct timeval* start;
+    int snapshot_entry;      // The entry of the task in its section of the status snapshot, or -1 if it is not listed.
+    uint64_t sequence;       // The order the task was queued in. Breaks ties under every policy.
+    int64_t dispatched_ms;   // The time the task started running at, in milliseconds, or 0 if it has not started.
+    int claim_cell;          // The cell of the claim of the task, on the worker it was written to.
+    uint8_t priority;        // The priority class of the task. See TaskPriority.
+    int64_t suspended_ms;    // How long the task spent suspended, in milliseconds.
+    pid_t submitter;         // The client that queued the task, which it takes turns in the backlog as.
 } OPERATOR_TASK, *OperatorTask;
 
-typedef GQueue* RequestQueue;
+/**
+ * @brief The running tasks, indexed by their id.
+ */
+typedef GHashTable* TaskIndex;
 
 #pragma region ======= FUNCTION PREDICATES =======
+/**
+ * @brief Returns the time a task was queued at, in milliseconds.
+ */
+static inline int64_t get_task_queued_ms(OperatorTask task) {
+    return (int64_t)task->start->tv_sec * 1000 + task->start->tv_usec / 1000;
+}
+
+/**
+ * @brief Returns the aged priority of a task, where lower values are dispatched first.
+ * 
+ *   Aging favours a task by aging_rate milliseconds of its policy key for every second it waits. As every queued task
+ * ages at the same pace, ordering by the key aged up to the time the task was queued is the same as ordering by the
+ * key aged up to now, so the priority of a task never changes while it sits in the backlog.
+ * 
+ * @param key       The policy key of the task, in milliseconds, where lower values are dispatched first.
+ * @param task      The task.
+ * @param user_data The aging rate, as passed to the backlog.
+ */
+static inline int64_t get_task_aged_priority(int64_t key, OperatorTask task, gpointer user_data) {
+    return key * 1000 + (int64_t)GPOINTER_TO_INT(user_data) * get_task_queued_ms(task);
+}
+
+/**
+ * @brief Compares two priorities, breaking ties by the order the tasks were queued in.
+ */
+static inline gint compare_task_priorities(int64_t priority_a, int64_t priority_b, OperatorTask task_a, OperatorTask task_b) {
+    if(priority_a < priority_b) return -1;
+    if(priority_a > priority_b) return  1;
+
+    return (task_a->sequence > task_b->sequence) - (task_a->sequence < task_b->sequence);
+}
+
 static inline gint request_queue_compare_fifo(gconstpointer a, gconstpointer b, gpointer user_data) {
     UNUSED(user_data);
-    return ((OperatorTask)a)->start - ((OperatorTask)b)->start;
+    return compare_task_priorities(0, 0, (OperatorTask)a, (OperatorTask)b);
 }
 
 static inline gint request_queue_compare_sjb(gconstpointer a, gconstpointer b, gpointer user_data) {
-    UNUSED(user_data);
-
     OperatorTask task_a = (OperatorTask)a;
     OperatorTask task_b = (OperatorTask)b;
 
-    if(task_a->speculate_time < task_b->speculate_time) return -1;
-    if(task_a->speculate_time > task_b->speculate_time) return  1;
-
-    return 0;
+    return compare_task_priorities(
+        get_task_aged_priority(task_a->speculate_time, task_a, user_data), 
+        get_task_aged_priority(task_b->speculate_time, task_b, user_data), 
+        task_a, 
+        task_b
+    );
 }
 
 static inline gint request_queue_compare_ljb(gconstpointer a, gconstpointer b, gpointer user_data) {
-    UNUSED(user_data);
-
     OperatorTask task_a = (OperatorTask)a;
     OperatorTask task_b = (OperatorTask)b;
 
-    if(task_a->speculate_time < task_b->speculate_time) return  1;
-    if(task_a->speculate_time > task_b->speculate_time) return -1;
-
-    return 0;
+    return compare_task_priorities(
+        get_task_aged_priority(-task_a->speculate_time, task_a, user_data), 
+        get_task_aged_priority(-task_b->speculate_time, task_b, user_data), 
+        task_a, 
+        task_b
+    );
 }
 
 static inline gint request_queue_compare_certain(gconstpointer a, gconstpointer b, gpointer user_data) {
-    UNUSED(user_data);
-
     OperatorTask task_a = (OperatorTask)a;
     OperatorTask task_b = (OperatorTask)b;
 
-    if(abs(TASK_SPECULATE_TIME - task_a->speculate_time) < abs(TASK_SPECULATE_TIME - task_b->speculate_time)) return  -1;
-    if(abs(TASK_SPECULATE_TIME - task_a->speculate_time) > abs(TASK_SPECULATE_TIME - task_b->speculate_time)) return   1;
+    return compare_task_priorities(
+        get_task_aged_priority(abs(TASK_SPECULATE_TIME - task_a->speculate_time), task_a, user_data), 
+        get_task_aged_priority(abs(TASK_SPECULATE_TIME - task_b->speculate_time), task_b, user_data), 
+        task_a, 
+        task_b
+    );
+}
+#pragma endregion
 
-    return 0;
+/**
+ * @brief Returns the time a task is expected to take: the learned estimate if it is trusted, or else the time
+ * estimated by the client.
+ */
+static inline int get_task_speculate_time(Estimator estimator, int client_time, const char* command, size_t command_len) {
+    uint32_t estimate;
+    if (estimator != NULL && estimator_predict(estimator, command, command_len, &estimate)) {
+        DEBUG_PRINT(LOG_HEADER "Using learned estimate of %ums instead of %dms.\n", estimate, client_time);
+        return (estimate <= INT_MAX) ? (int)estimate : INT_MAX;
+    }
+
+    return client_time;
 }
 
-static inline gint find_queue_task_by_id(gconstpointer src, gconstpointer ctrl) {
-    return ((OperatorTask)src)->id_task == *((int*)ctrl);
+/**
+ * @brief Returns the longest a task may run for, as a multiple of the time estimated by its client, or 0 if it may
+ * run for as long as it takes.
+ */
+static inline uint32_t get_task_timeout(int timeout_factor, int client_time) {
+    if (timeout_factor <= 0 || client_time <= 0) return 0;
+
+    uint64_t timeout = (uint64_t)client_time * timeout_factor;
+    return (timeout < UINT32_MAX) ? (uint32_t)timeout : UINT32_MAX;
 }
-#pragma endregion
 
-static inline RequestQueue create_request_queue() {
-    return g_queue_new();
+static inline TaskIndex create_task_index() {
+    return g_hash_table_new(g_direct_hash, g_direct_equal);
 }
 
 OperatorTask create_task(int id_task, int speculate_time, WorkerDatagram datagram, int datagram_size) {
+    // Monotonic across the whole life of the operator, unlike the wall clock time the task was queued at.
+    static uint64_t next_sequence = 0;
+
     OperatorTask execute_task = malloc(sizeof(OPERATOR_TASK));
+    execute_task->sequence = next_sequence++;
     execute_task->id_task = id_task;
     execute_task->speculate_time = speculate_time;
     execute_task->datagram = datagram;
     execute_task->datagram_size = datagram_size;
+    execute_task->snapshot_entry = -1;
+    execute_task->dispatched_ms = 0;
+    execute_task->priority = TASK_PRIORITY_NORMAL;
+    execute_task->suspended_ms = 0;
+    execute_task->submitter = 0;
     execute_task->start = malloc(sizeof(struct timeval));
     if(gettimeofday(execute_task->start, NULL) == -1) {
         perror("Unable to setup start time.");
@@ -169,35 +301,175 @@ OperatorTask create_task(int id_task, int speculate_time, WorkerDatagram datagra
     return execute_task;
 }
 
-static inline OperatorTask get_next_task(RequestQueue request_waiting_queue) {
-    return (OperatorTask)g_queue_pop_head(request_waiting_queue);
+void destroy_task(OperatorTask task) {
+    free(task->datagram);
+    free(task->start);
+    free(task);
 }
 
-static inline void add_task_to_backlog(RequestQueue request_waiting_queue, GCompareDataFunc comparator, OperatorTask task) {
-    g_queue_insert_sorted(request_waiting_queue, task, comparator, NULL);
+/**
+ * @brief Returns the share of its submitter's turn a task takes, which is the time it is expected to take.
+ */
+static uint32_t get_task_cost(gconstpointer data) {
+    OperatorTask task = (OperatorTask)data;
+    return (task->speculate_time > 0) ? (uint32_t)task->speculate_time : 1;
+}
+
+static inline OperatorTask get_next_task(Backlog request_waiting_queue) {
+    return (OperatorTask)backlog_pop(request_waiting_queue);
+}
+
+/**
+ * @brief Queues a task behind the other tasks of the same submitter and priority class.
+ */
+static inline void add_task_to_backlog(Backlog request_waiting_queue, OperatorTask task) {
+    if (backlog_push(request_waiting_queue, task->priority, task->submitter, task) != 0) {
+        perror("Unable to grow backlog.");
+        exit(1);
+    }
 }
 
-OperatorTask prepare_task_from_queue(RequestQueue request_waiting_queue, RequestQueue active_request_queue) {
+/**
+ * @brief Queues a newly received task, unless it has to wait for the tasks it depends on, or will never run as one of
+ * them failed, in which case it is left for the caller to cancel.
+ */
+static void submit_task(
+    DependencyGraph dependencies, 
+    Backlog request_waiting_queue, 
+    GArray* cancelled_tasks, 
+    OperatorTask task, 
+    const int* parents, 
+    int num_parents
+) {
+    switch (dependency_graph_add(dependencies, task->id_task, parents, num_parents, task)) {
+        case DEPENDENCY_READY: {
+            add_task_to_backlog(request_waiting_queue, task);
+            break;
+        }
+        case DEPENDENCY_HELD: {
+            MAIN_LOG(LOG_HEADER "Holding task %d until the tasks it depends on complete.\n", task->id_task);
+            break;
+        }
+        case DEPENDENCY_CANCELLED: {
+            g_array_append_val(cancelled_tasks, task);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief The largest frame a task may be written to a worker as.
+ */
+#define OPERATOR_MAX_TASK_FRAME (sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM) + EXECUTE_REQUEST_DATAGRAM_MAX_PAYLOAD_LEN)
+
+/**
+ * @brief Checks whether another task may be written to a worker, which holds at most one running task and prefetch
+ * queued tasks. Stolen tasks the worker has not skipped yet still hold their claim.
+ *
+ * A busy worker only reads its pipe between tasks, so a task is only prefetched if the largest frame still fits in
+ * the pipe, behind every frame that may not have been read yet. Otherwise, writing it would block the operator until
+ * the worker finished its running task. The frames of stolen tasks are no longer known, and are taken as the largest.
+ */
+static inline int has_worker_credit(OperatorWorkerEntry worker, int prefetch) {
+    if ((int)worker->tasks->length + worker->stolen >= 1 + prefetch) return 0;
+    if (worker->tasks->length == 0) return 1;
+
+    size_t unread = worker->queued_bytes + (size_t)worker->stolen * OPERATOR_MAX_TASK_FRAME;
+    return unread + OPERATOR_MAX_TASK_FRAME <= worker->worker->pipe_capacity;
+}
+
+/**
+ * @brief Queues a task on a worker, which must have credit for it, before it is written to the worker.
+ */
+static inline void assign_task_to_worker(WorkerClaims claims, OperatorWorkerEntry worker, OperatorTask task) {
+    task->claim_cell = offer_worker_claim(claims, worker->id, task->id_task);
+    g_queue_push_tail(worker->tasks, task);
+    worker->queued_bytes += task->datagram_size;
+}
+
+OperatorTask prepare_task_from_queue(
+    Backlog request_waiting_queue, 
+    TaskIndex running_tasks, 
+    WorkerClaims claims, 
+    OperatorWorkerEntry worker
+) {
     OperatorTask next_task = get_next_task(request_waiting_queue);
-    g_queue_push_tail(active_request_queue, next_task);
+    g_hash_table_insert(running_tasks, GINT_TO_POINTER(next_task->id_task), next_task);
+    assign_task_to_worker(claims, worker, next_task);
     
     return next_task;
 }
 
-void complete_task_from_queue(RequestQueue active_request_queue, int task_id) {
-    GList* task = g_queue_find_custom(active_request_queue, &task_id, find_queue_task_by_id);
+/**
+ * @brief Takes the last prefetched task of the worker with the most prefetched tasks, and queues it on an idle worker.
+ *
+ * @return The stolen task, or NULL if there is none, or its worker already started it.
+ */
+static OperatorTask steal_task_for_worker(WorkerArray workers, WorkerClaims claims, OperatorWorkerEntry thief) {
+    OperatorWorkerEntry victim = NULL;
+    for (guint i = 0; i < workers->len; i++) {
+        OperatorWorkerEntry entry = g_array_index(workers, OperatorWorkerEntry, i);
+        if (entry->tasks->length >= 2 && (victim == NULL || entry->tasks->length > victim->tasks->length)) {
+            victim = entry;
+        }
+    }
+    if (victim == NULL) return NULL;
 
-    if (task != NULL) {
-        int ind = g_queue_index(active_request_queue, task->data);
-        OperatorTask task = g_queue_peek_nth(active_request_queue, ind);
-        struct timeval end; 
-        gettimeofday(&end, NULL);
-        time_t time_took = (end.tv_sec*1000 + end.tv_usec/1000) - (task->start->tv_sec*1000 + task->start->tv_usec/1000);
-        DEBUG_PRINT(LOG_HEADER "CTFQ Index: %d\n", ind);
-        DEBUG_PRINT(LOG_HEADER "Time elapsed: %ld\n", time_took);
-
-        g_queue_pop_nth(active_request_queue, ind);
+    // The last task would wait the longest on the victim. If it already started, so did every task before it, and
+    // the completions are simply still on their way.
+    OperatorTask task = g_queue_peek_tail(victim->tasks);
+    if (!steal_worker_claim(claims, victim->id, task->claim_cell, task->id_task)) return NULL;
+
+    g_queue_pop_tail(victim->tasks);
+    victim->queued_bytes -= task->datagram_size;
+    victim->stolen++;
+    assign_task_to_worker(claims, thief, task);
+
+    return task;
+}
+
+/**
+ * @brief Reports the first task of a worker as running, if it was not yet. Prefetched tasks only start running, and
+ * stop waiting, once every task before them on their worker completed.
+ */
+static void start_worker_task(Snapshot snapshot, OperatorWorkerEntry worker) {
+    OperatorTask task = g_queue_peek_head(worker->tasks);
+    if (task == NULL || task->dispatched_ms != 0) return;
+
+    task->dispatched_ms = get_current_ms();
+    int64_t waited = task->dispatched_ms - get_task_queued_ms(task);
+    snapshot_record_wait(snapshot, (waited > 0) ? waited : 0);
+
+    WorkerExecuteRequestDatagram execute = (WorkerExecuteRequestDatagram)task->datagram;
+    task->snapshot_entry = snapshot_dispatch(
+        snapshot, 
+        task->snapshot_entry, 
+        task->id_task, 
+        execute->data, 
+        execute->data_len
+    );
+}
+
+static inline OperatorTask find_running_task(TaskIndex running_tasks, int task_id) {
+    return (OperatorTask)g_hash_table_lookup(running_tasks, GINT_TO_POINTER(task_id));
+}
+
+/**
+ * @brief Removes the task a worker completed from the running tasks, and returns it, or NULL if it is unknown.
+ */
+OperatorTask complete_task_from_worker(TaskIndex running_tasks, WorkerClaims claims, OperatorWorkerEntry worker, int task_id) {
+    // The worker reports the task it ran, which should always be its first task.
+    OperatorTask task = g_queue_peek_head(worker->tasks);
+    if (task == NULL || task->id_task != task_id) task = find_running_task(running_tasks, task_id);
+    if (task == NULL) return NULL;
+
+    g_hash_table_remove(running_tasks, GINT_TO_POINTER(task_id));
+    if (g_queue_remove(worker->tasks, task)) {
+        worker->queued_bytes -= task->datagram_size;
+        release_worker_claim(claims, worker->id, task->claim_cell);
     }
+
+    return task;
 }
 
 void execute_task(OperatorWorkerEntry worker, OperatorTask task) {
@@ -212,24 +484,233 @@ void execute_task(OperatorWorkerEntry worker, OperatorTask task) {
 }
 #pragma endregion
 
-void printer(RequestQueue queue) {
+#pragma region ============== ELASTIC POOL ==============
+/**
+ * @brief Starts a worker in the first stopped slot of the pool, so that worker ids stay as low as possible.
+ *
+ * @return The slot of the new worker, which is not idle yet, or NULL if every slot is taken or the worker failed.
+ */
+static OperatorWorkerEntry start_pool_worker(
+    WorkerArray workers, 
+    Ring ring, 
+    WorkerClaims claims, 
+    CpuPlacement placement, 
+    char* output_dir
+) {
+    for (guint i = 0; i < workers->len; i++) {
+        OperatorWorkerEntry entry = get_worker_by_id(workers, i);
+        if (entry->status != WORKER_STATUS_STOPPED) continue;
+
+        // Slots above the number of parallel tasks, only taken while tasks are suspended, share the cores below them.
+        CpuList cpus = (placement != NULL) ? &placement->workers[entry->id % placement->num_workers] : NULL;
+        entry->worker = start_worker(ring, claims, entry->id, output_dir, cpus);
+        if (entry->worker == NULL) return NULL;
+
+        entry->status = WORKER_STATUS_UNKNOWN;
+        entry->idle_since_ms = get_current_ms();
+        MAIN_LOG(LOG_HEADER "Started worker #%d with PID %d.\n", entry->id, entry->worker->pid);
+
+        return entry;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Asks an idle worker to exit, and frees its slot. The worker is only reaped later, once it exited.
+ */
+static void stop_pool_worker(OperatorWorkerEntry entry, GArray* retiring) {
+    MAIN_LOG(LOG_HEADER "Retiring idle worker #%d @ %d\n", entry->id, entry->worker->pid);
+
+    WorkerShutdownRequestDatagram request = create_worker_shutdown_request_datagram();
+    if (request == NULL || write(entry->worker->pipe_write, request, sizeof(WORKER_SHUTDOWN_REQUEST_DATAGRAM)) == -1) {
+        // Later workers inherited the pipe, so closing it would not be noticed either.
+        kill(entry->worker->pid, SIGKILL);
+    }
+    free(request);
+
+    close(entry->worker->pipe_write);
+    g_array_append_val(retiring, entry->worker->pid);
+
+    free(entry->worker);
+    entry->worker = NULL;
+    entry->status = WORKER_STATUS_STOPPED;
+}
+
+/**
+ * @brief Retires the idle workers that stayed idle for the whole idle timeout, while the pool is above its minimum.
+ * The bottom of the idle stack is the worker idle for the longest, so only it needs to be checked. Workers above the
+ * maximum, started while tasks were suspended, are retired right away.
+ *
+ * @return How long until the next idle worker may be retired, in milliseconds, or -1 if none may be.
+ */
+static int shrink_worker_pool(
+    IdleWorkerStack idle_workers, 
+    GArray* retiring, 
+    int* num_workers, 
+    int min_workers, 
+    int max_workers, 
+    int idle_timeout
+) {
+    while (*num_workers > min_workers && idle_workers->len > 0) {
+        OperatorWorkerEntry entry = g_array_index(idle_workers, OperatorWorkerEntry, 0);
+
+        // Stolen tasks still hold a claim on the worker. Skipping them wakes the operator again.
+        if (entry->stolen > 0) return -1;
+
+        int64_t idle_for = get_current_ms() - entry->idle_since_ms;
+        if (*num_workers <= max_workers && idle_for < idle_timeout) return (int)(idle_timeout - idle_for);
+
+        g_array_remove_index(idle_workers, 0);
+        stop_pool_worker(entry, retiring);
+        (*num_workers)--;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Reaps the retired workers that already exited.
+ */
+static void reap_retired_workers(GArray* retiring) {
+    for (guint i = retiring->len; i > 0; i--) {
+        if (waitpid(g_array_index(retiring, pid_t, i - 1), NULL, WNOHANG) != 0) {
+            g_array_remove_index_fast(retiring, i - 1);
+        }
+    }
+}
+#pragma endregion
+
+#pragma region ============== PREEMPTION ==============
+/**
+ * @brief Returns the worker running the task of the lowest class below a priority class, or NULL if there is none.
+ * Among tasks of the same class, the one that started last is chosen, as it is the furthest from completing.
+ */
+static OperatorWorkerEntry find_preemption_victim(WorkerArray workers, int priority) {
+    OperatorWorkerEntry victim = NULL;
+    OperatorTask victim_task = NULL;
+    for (guint i = 0; i < workers->len; i++) {
+        OperatorWorkerEntry entry = get_worker_by_id(workers, i);
+        if (entry->status != WORKER_STATUS_BUSY) continue;
+
+        OperatorTask task = g_queue_peek_head(entry->tasks);
+        if (task == NULL || task->dispatched_ms == 0 || task->priority >= priority) continue;
+
+        if (
+            victim == NULL 
+            || task->priority < victim_task->priority 
+            || (task->priority == victim_task->priority && task->dispatched_ms > victim_task->dispatched_ms)
+        ) {
+            victim = entry;
+            victim_task = task;
+        }
+    }
+
+    return victim;
+}
+
+/**
+ * @brief Returns the suspended worker whose task has the highest class, suspended first among equals, or NULL.
+ */
+static OperatorWorkerEntry find_resumable_worker(WorkerArray workers) {
+    OperatorWorkerEntry resumed = NULL;
+    int resumed_priority = -1;
+    for (guint i = 0; i < workers->len; i++) {
+        OperatorWorkerEntry entry = get_worker_by_id(workers, i);
+        if (entry->status != WORKER_STATUS_SUSPENDED) continue;
+
+        OperatorTask task = g_queue_peek_head(entry->tasks);
+        int priority = (task != NULL) ? task->priority : TASK_PRIORITY_CLASSES;
+        if (
+            resumed == NULL 
+            || priority > resumed_priority 
+            || (priority == resumed_priority && entry->suspended_since_ms < resumed->suspended_since_ms)
+        ) {
+            resumed = entry;
+            resumed_priority = priority;
+        }
+    }
+
+    return resumed;
+}
+
+/**
+ * @brief Stops the running task of a worker, so that its slot can be lent to a more urgent task.
+ */
+static void suspend_worker_task(OperatorWorkerEntry entry) {
+    OperatorTask task = g_queue_peek_head(entry->tasks);
+    MAIN_LOG(LOG_HEADER "Suspending task %d on worker #%d.\n", task->id_task, entry->id);
+
+    kill(entry->worker->pid, WORKER_SIGNAL_SUSPEND);
+    entry->status = WORKER_STATUS_SUSPENDED;
+    entry->suspended_since_ms = get_current_ms();
+}
+
+/**
+ * @brief Continues the suspended task of a worker. The time it spent suspended does not count as running.
+ */
+static void resume_worker_task(OperatorWorkerEntry entry) {
+    kill(entry->worker->pid, WORKER_SIGNAL_RESUME);
+    entry->status = WORKER_STATUS_BUSY;
+
+    OperatorTask task = g_queue_peek_head(entry->tasks);
+    if (task != NULL) {
+        MAIN_LOG(LOG_HEADER "Resuming task %d on worker #%d.\n", task->id_task, entry->id);
+        task->suspended_ms += get_current_ms() - entry->suspended_since_ms;
+    }
+}
+#pragma endregion
+
+void printer(PriorityQueue queue) {
     for(guint i = 0 ; i < queue->length ; i++) {
-        OperatorTask task = g_queue_peek_nth(queue, i);
+        OperatorTask task = queue->entries[i].data;
         DEBUG_PRINT("[Task %d] Time: %d\n", i, task->speculate_time);
     }
 }
 
-OPERATOR start_operator(int num_parallel_tasks, char* output_dir, char* history_file_path, char* escalation_policy) {
+OPERATOR start_operator(
+    int num_parallel_tasks, 
+    char* output_dir, 
+    char* history_file_path, 
+    char* estimates_path, 
+    char* escalation_policy, 
+    int aging_rate, 
+    int fair_share_quantum, 
+    int prefetch, 
+    int min_workers, 
+    int idle_timeout, 
+    int min_concurrency, 
+    int pin_cpus, 
+    int timeout_factor, 
+    Admission admission
+) {
     #define ERR (OPERATOR){ 0 }
 
-    int pd[2];
-    pipe(pd); 
+    // The ring must be created before forking, so that it is shared by the server, the operator and the workers.
+    Ring ring = create_ring();
+    if (ring == NULL) return ERR;
+
+    // Unknown policies fall back to certain, which the snapshot reports under its own name.
+    GCompareDataFunc escalation_policy_comparator = request_queue_compare_certain;
+    char* escalation_policy_name = "certain";
+    if(!strcmp(escalation_policy, "fifo")) {
+        escalation_policy_comparator = request_queue_compare_fifo;
+        escalation_policy_name = "fifo";
+    } else if(!strcmp(escalation_policy, "sjb")) {
+        escalation_policy_comparator = request_queue_compare_sjb;
+        escalation_policy_name = "sjb";
+    } else if(!strcmp(escalation_policy, "ljb")) {
+        escalation_policy_comparator = request_queue_compare_ljb;
+        escalation_policy_name = "ljb";
+    }
+
+    // The snapshot must also be created before forking, as the operator writes it and the server reads it.
+    Snapshot snapshot = create_snapshot(escalation_policy_name);
+    if (snapshot == NULL) {
+        destroy_ring(ring);
+        return ERR;
+    }
 
-    void* escalation_policy_comparator;
-    if(!strcmp(escalation_policy, "fifo")) escalation_policy_comparator = request_queue_compare_fifo;
-    else if(!strcmp(escalation_policy, "sjb")) escalation_policy_comparator = request_queue_compare_sjb;
-    else if(!strcmp(escalation_policy, "ljb")) escalation_policy_comparator = request_queue_compare_ljb;
-    else escalation_policy_comparator = request_queue_compare_certain;
 
     INIT_CRITICAL_MARK
     #define CRITICAL_START SET_CRITICAL_MARK(1);
@@ -245,31 +726,91 @@ OPERATOR start_operator(int num_parallel_tasks, char* output_dir, char* history_
     pid_t pid = fork();
     if(pid == 0) {
         MAIN_LOG(LOG_HEADER "Operator started.\n");
-        // close(pd[1]);
         
         #pragma region ======= WORKER INITIALIZATION =======
-        MAIN_LOG(LOG_HEADER "Stating %d Worker Processes.\n", num_parallel_tasks + 1);
+        MAIN_LOG(LOG_HEADER "Stating %d of up to %d Worker Processes.\n", min_workers, num_parallel_tasks);
         
         WorkerArray worker_array = create_workers_array();
-        int workers_busy = 0;
-
-        for(int i = 0 ; i < num_parallel_tasks + 1 ; i++) {
-            Worker worker = start_worker(pd[1], i, output_dir, history_file_path);
+        IdleWorkerStack idle_workers = create_idle_worker_stack(num_parallel_tasks);
+
+        // The workers retired, until they exit.
+        GArray* retiring = g_array_new(FALSE, FALSE, sizeof(pid_t));
+
+        // Every class but the lowest may suspend a running task of each slot, and take a slot of its own for its task.
+        int num_slots = num_parallel_tasks * TASK_PRIORITY_CLASSES;
+
+        // Every worker holds its running task and its prefetched tasks.
+        WorkerClaims claims = create_worker_claims(num_slots, 1 + prefetch);
+        if (claims == NULL) _exit(1);
+
+        // Workers are placed by their slot, so that a restarted worker gets the same cores.
+        CpuPlacement placement = NULL;
+        if (pin_cpus) {
+            placement = create_cpu_placement(num_parallel_tasks);
+            if (placement == NULL || pin_to_cpus(&placement->housekeeping) != 0) {
+                MAIN_LOG(LOG_HEADER "Unable to place workers by the CPU topology. Leaving them unpinned.\n");
+                destroy_cpu_placement(placement);
+                placement = NULL;
+            }
+        }
 
-            OperatorWorkerEntry entry = create_operator_worker_entry(worker);
+        // Every slot of the pool exists from the start, but only the minimum is started.
+        for(int i = 0 ; i < num_slots ; i++) {
+            OperatorWorkerEntry entry = create_operator_worker_entry(NULL, i);
             g_array_insert_val(worker_array, i, entry);
+        }
+
+        int num_workers = 0;
+        int num_suspended = 0;
+        while (num_workers < min_workers && start_pool_worker(worker_array, ring, claims, placement, output_dir) != NULL) {
+            num_workers++;
+        }
+
+        // Pushed in reverse, so that the first tasks go to the first workers.
+        for(int i = num_workers - 1 ; i >= 0 ; i--) {
+            push_idle_worker(idle_workers, g_array_index(worker_array, OperatorWorkerEntry, i));
+        }
+        snapshot_set_pool(snapshot, num_workers, min_workers, num_parallel_tasks);
 
-            MAIN_LOG(LOG_HEADER "Started worker #%d with PID %d.\n", i, worker->pid);
+        // Without a lower bound below the most workers, every worker may always run a task.
+        ConcurrencyLimit concurrency = NULL;
+        if (min_concurrency < num_parallel_tasks) {
+            concurrency = create_concurrency_limit(min_concurrency, num_parallel_tasks);
+            if (concurrency == NULL) MAIN_LOG(LOG_HEADER "Unable to adapt concurrency. Running every worker.\n");
         }
+        int task_limit = (concurrency != NULL) ? get_concurrency_limit(concurrency) : num_parallel_tasks;
+        int next_adjustment = -1;
+        if (concurrency != NULL) snapshot_set_concurrency(snapshot, task_limit, min_concurrency, 0, -1, -1);
 
         // Set global variable for SIGSEGV handling.
         _children = worker_array;
         #pragma endregion
 
         #pragma region ======= WORKER REQUEST QUEUE INITIALIZATION =======
-        RequestQueue active_request_queue = create_request_queue();
-        RequestQueue request_waiting_queue = create_request_queue();
-        RequestQueue status_request_queue = create_request_queue();
+        TaskIndex running_tasks = create_task_index();
+        Backlog request_waiting_queue = create_backlog(
+            fair_share_quantum, 
+            get_task_cost, 
+            escalation_policy_comparator, 
+            GINT_TO_POINTER(aging_rate)
+        );
+        if (request_waiting_queue == NULL) {
+            perror("Unable to setup backlog.");
+            _exit(1);
+        }
+
+        // Tasks waiting for the tasks they depend on are held out of the backlog.
+        DependencyGraph dependencies = create_dependency_graph();
+        if (dependencies == NULL) {
+            perror("Unable to setup dependency graph.");
+            _exit(1);
+        }
+        GArray* released_tasks = g_array_new(FALSE, FALSE, sizeof(OperatorTask));
+        GArray* cancelled_tasks = g_array_new(FALSE, FALSE, sizeof(OperatorTask));
+
+        // Without an estimator, tasks are simply ordered by the time estimated by the client.
+        Estimator estimator = create_estimator(estimates_path);
+        if (estimator == NULL) MAIN_LOG(LOG_HEADER "Unable to load task time estimates. Using client estimates.\n");
         #pragma endregion
 
 
@@ -277,330 +818,522 @@ OPERATOR start_operator(int num_parallel_tasks, char* output_dir, char* history_
         signal(SIGSEGV, operator_signal_sigsegv);
         volatile sig_atomic_t shutdown_requested = 0;
 
+        // Every message is copied out of the ring into this buffer before being processed.
+        uint8_t* message = SAFE_ALLOC(uint8_t*, RING_MAX_MESSAGE_SIZE);
+
+        // How long to wait for messages before retiring the next idle worker, or -1 to wait for messages only.
+        int wait_timeout = -1;
+
         // Read data from both the main server and worker
         while(!shutdown_requested) {
             DEBUG_PRINT(LOG_HEADER "New cycle.\n");
 
-            // Read and discriminate process mark.
-            char* mark = read_process_mark(pd[0]);
-            if (shutdown_requested) break;
+            // Wait for messages. A signal interrupts the wait, which shuts down the operator.
+            if (ring_wait_timeout(ring, wait_timeout) == -1) {
+                shutdown_requested = 1;
+                break;
+            }
 
-            DEBUG_PRINT(LOG_HEADER "Mark: %d %d\n", mark[0], mark[1]);
+            // Consume every message currently in the ring before attempting to dispatch.
+            uint16_t type;
+            ssize_t message_len;
+            while (!shutdown_requested && (message_len = ring_read(ring, &type, message)) != -1) {
+                DEBUG_PRINT(LOG_HEADER "Message: type %d, %ld bytes\n", type, message_len);
 
-            switch (PROCESS_MARK_SOLVER(mark)) {
-                case 0: {
-                    shutdown_requested = 1;
-                    break;
-                }
-                case MAIN_SERVER_PROCESS_MARK_DISCRIMINATOR: {
-                    MAIN_LOG(LOG_HEADER "Received message from Main Server Process.\n");
-                    CRITICAL_START
-                        DATAGRAM_HEADER header = read_datagram_header(pd[0]);
-                    CRITICAL_END
-
-                    if (header.version == 0) {
-                        // Read fuck all. Ignore it.
-                        continue;
-                    } else if (header.version != DATAGRAM_VERSION) {
-                        // Datagram not supported.
-                        MAIN_LOG(LOG_HEADER "Received unsupported datagram with version %d:\n", header.version);
+                switch (type) {
+                    case RING_MESSAGE_SERVER: {
+                        MAIN_LOG(LOG_HEADER "Received message from Main Server Process.\n");
 
-                        drain_fifo(pd[0]);
-                        continue;
-                    }
+                        DATAGRAM_HEADER header = { 0 };
+                        if ((size_t)message_len >= sizeof(DATAGRAM_HEADER)) memcpy(&header, message, sizeof(DATAGRAM_HEADER));
 
-                    switch (header.mode) {
-                        case DATAGRAM_MODE_EXECUTE_REQUEST: {
-                            ExecuteRequestDatagram request = read_partial_execute_request_datagram(pd[0], header);
+                        if (header.version == 0) {
+                            // Read fuck all. Ignore it.
+                            continue;
+                        } else if (header.version != DATAGRAM_VERSION) {
+                            // Datagram not supported.
+                            MAIN_LOG(LOG_HEADER "Received unsupported datagram with version %d:\n", header.version);
+                            continue;
+                        }
 
-                            int id = 0;
-                            SAFE_READ(pd[0], &id, sizeof(int));
+                        switch (header.mode) {
+                            case DATAGRAM_MODE_EXECUTE_REQUEST: {
+                                ExecuteRequestDatagram request = (ExecuteRequestDatagram)message;
+                                if (
+                                    (size_t)message_len < sizeof(EXECUTE_REQUEST_DATAGRAM) + sizeof(int)
+                                    || EXECUTE_REQUEST_DATAGRAM_SIZE(request) + sizeof(int) != (size_t)message_len
+                                ) {
+                                    MAIN_LOG(LOG_HEADER "Received malformed execute request.\n");
+                                    continue;
+                                }
 
-                            char* req_str = execute_request_datagram_to_string(request, 1, 1);
-                            MAIN_LOG(LOG_HEADER "Received execute request: %s\n", req_str);
-                            MAIN_LOG(LOG_HEADER "Task id: %d\n", id);
-                            free(req_str);
+                                int id = 0;
+                                memcpy(&id, message + EXECUTE_REQUEST_DATAGRAM_SIZE(request), sizeof(int));
+                                char* req_str = execute_request_datagram_to_string(request, 1, 1);
+                                MAIN_LOG(LOG_HEADER "Received execute request: %s\n", req_str);
+                                MAIN_LOG(LOG_HEADER "Task id: %d\n", id);
+                                free(req_str);
                             
-                            WorkerExecuteRequestDatagram dg = create_worker_execute_request_datagram();
-                            dg->header.task_id = id;
-                            memcpy(dg->data, request->data, EXECUTE_REQUEST_DATAGRAM_PAYLOAD_LEN);
-
-                            OperatorTask task = create_task(
-                                id, 
-                                request->time, 
-                                (WorkerDatagram)dg, 
-                                sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM)
-                            );
-
-                            add_task_to_backlog(
-                                request_waiting_queue, 
-                                escalation_policy_comparator,
-                                task
-                            );
-                            break;
-                        }
-                        case DATAGRAM_MODE_STATUS_REQUEST: {
-                            StatusRequestDatagram request = read_partial_status_request_datagram(pd[0], header);
-
-                            char* req_str = status_request_datagram_to_string(request, 1);
-                            MAIN_LOG(LOG_HEADER "Received status request: %s\n", req_str);
-                            free(req_str);
-
-                            // FUCK OFF GCC, I'M NOT FUCKING TRYING TO CAST A VOID* TO INT, YOU USELESS FUCK
-                            pid_t* req_pid = (pid_t*)calloc(sizeof(pid_t), 1);
-                            *req_pid = request->header.pid;
-
-                            OperatorTask task = create_task(
-                                0,
-                                0,
-                                (void*)(&req_pid),
-                                sizeof(WORKER_STATUS_REQUEST_DATAGRAM)
-                            );
-
-                            add_task_to_backlog(
-                                status_request_queue,
-                                request_queue_compare_fifo,
-                                task
-                            );
-                            break;
-                        }
-                        case DATAGRAM_MODE_CLOSE_REQUEST: {
-                            MAIN_LOG(LOG_HEADER "Received shutdown request.\n");
-                            shutdown_requested = 1;
-                            break;
-                        }
-                        default: {
-                            // Tf is this datagram? Idk and idc.
-                            // Do nothing.
+                                WorkerExecuteRequestDatagram dg = create_worker_execute_request_datagram(
+                                    request->data, 
+                                    request->data_len
+                                );
+                                dg->header.task_id = id;
+                                dg->timeout = get_task_timeout(timeout_factor, request->time);
+
+                                OperatorTask task = create_task(
+                                    id, 
+                                    get_task_speculate_time(estimator, request->time, request->data, request->data_len), 
+                                    (WorkerDatagram)dg, 
+                                    WORKER_EXECUTE_REQUEST_DATAGRAM_SIZE(dg)
+                                );
+                                task->snapshot_entry = snapshot_enqueue(snapshot, id, dg->data, dg->data_len);
+                                task->priority = (request->priority < TASK_PRIORITY_CLASSES) 
+                                    ? request->priority 
+                                    : TASK_PRIORITY_NORMAL;
+                                task->submitter = request->header.pid;
+
+                                submit_task(dependencies, request_waiting_queue, cancelled_tasks, task, NULL, 0);
+                                break;
+                            }
+                            case DATAGRAM_MODE_EXECUTE_BATCH_REQUEST: {
+                                ExecuteBatchRequestDatagram request = (ExecuteBatchRequestDatagram)message;
+                                if (
+                                    (size_t)message_len < sizeof(EXECUTE_BATCH_REQUEST_DATAGRAM) + sizeof(int)
+                                    || EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(request) + sizeof(int) != (size_t)message_len
+                                ) {
+                                    MAIN_LOG(LOG_HEADER "Received malformed execute batch request.\n");
+                                    continue;
+                                }
+
+                                int first_id = 0;
+                                memcpy(&first_id, message + EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(request), sizeof(int));
+
+                                MAIN_LOG(
+                                    LOG_HEADER "Received execute batch request: Task ids %d to %d\n", 
+                                    first_id, 
+                                    first_id + request->num_tasks - 1
+                                );
+
+                                // An entry can not depend on more tasks than fit in a batch.
+                                int parents[EXECUTE_BATCH_REQUEST_DATAGRAM_MAX_SIZE / sizeof(int32_t)];
+                                int id = first_id;
+                                for (
+                                    ExecuteBatchEntry entry = next_execute_batch_entry(request, NULL); 
+                                    entry != NULL; 
+                                    entry = next_execute_batch_entry(request, entry), id++
+                                ) {
+                                    WorkerExecuteRequestDatagram dg = create_worker_execute_request_datagram(
+                                        entry->data, 
+                                        entry->data_len
+                                    );
+                                    dg->header.task_id = id;
+                                    dg->timeout = get_task_timeout(timeout_factor, entry->time);
+
+                                    OperatorTask task = create_task(
+                                        id, 
+                                        get_task_speculate_time(estimator, entry->time, entry->data, entry->data_len), 
+                                        (WorkerDatagram)dg, 
+                                        WORKER_EXECUTE_REQUEST_DATAGRAM_SIZE(dg)
+                                    );
+                                    task->snapshot_entry = snapshot_enqueue(snapshot, id, dg->data, dg->data_len);
+                                    task->priority = (entry->priority < TASK_PRIORITY_CLASSES) 
+                                        ? entry->priority 
+                                        : TASK_PRIORITY_NORMAL;
+                                    task->submitter = request->header.pid;
+
+                                    // Negative dependencies count entries back within the batch. Those reaching past
+                                    // its start are left invalid, which cancels the task.
+                                    for (int i = 0; i < entry->num_dependencies; i++) {
+                                        int dependency = get_execute_batch_entry_dependency(entry, i);
+                                        if (dependency < 0) dependency = (id + dependency >= first_id) ? id + dependency : 0;
+                                        parents[i] = dependency;
+                                    }
+
+                                    submit_task(
+                                        dependencies, 
+                                        request_waiting_queue, 
+                                        cancelled_tasks, 
+                                        task, 
+                                        parents, 
+                                        entry->num_dependencies
+                                    );
+                                }
+                                break;
+                            }
+                            case DATAGRAM_MODE_CLOSE_REQUEST: {
+                                MAIN_LOG(LOG_HEADER "Received shutdown request.\n");
+                                shutdown_requested = 1;
+                                break;
+                            }
+                            default: {
+                                // Tf is this datagram? Idk and idc.
+                                // Do nothing.
+                            }
                         }
+                        break;
                     }
-                    break;
-                }
-                case WORKER_PROCESS_MARK_DISCRIMINATOR: {
-                    MAIN_LOG(LOG_HEADER "Received message from Worker Process.\n");
+                    case RING_MESSAGE_WORKER: {
+                        MAIN_LOG(LOG_HEADER "Received message from Worker Process.\n");
 
-                    CRITICAL_START
-                        WORKER_DATAGRAM_HEADER header = read_worker_datagram_header(pd[0]);
-                    CRITICAL_END
+                        WORKER_DATAGRAM_HEADER header = { 0 };
+                        if ((size_t)message_len >= sizeof(WORKER_DATAGRAM_HEADER)) {
+                            memcpy(&header, message, sizeof(WORKER_DATAGRAM_HEADER));
+                        }
 
-                    if (header.mode == WORKER_DATAGRAM_MODE_NONE) {
-                        // Read fuck all. Ignore it.
-                        continue;
-                    }
+                        if (header.mode == WORKER_DATAGRAM_MODE_NONE) {
+                            // Read fuck all. Ignore it.
+                            continue;
+                        }
 
-                    switch (header.mode) {
-                        case WORKER_DATAGRAM_MODE_COMPLETION_RESPONSE: {
-                            WorkerCompletionResponseDatagram res = read_partial_worker_completion_response_datagram(
-                                pd[0], 
-                                header
-                            );
-
-                            MAIN_LOG(LOG_HEADER "Received Completion Response from Worker #%d.\n", res->worker_id);
-
-                            if(res->worker_id != 0) {
-                                DEBUG_PRINT(LOG_HEADER "0a\n");
-                                OperatorWorkerEntry entry = get_worker_by_id(worker_array, res->worker_id);
-                                // complete_task_from_queue(active_request_queue, res->header.task_id);
-                                
-                                // DEBUG_PRINT(LOG_HEADER "0b %p\n", res->header.task_id);
-                                // GList* task = g_queue_find_custom(active_request_queue, &res->header.task_id, find_queue_task_by_id);
-
-                                // DEBUG_PRINT(LOG_HEADER "0c %p\n", task);
-                                // if(task != NULL) {
-                                //     DEBUG_PRINT(LOG_HEADER "1\n");
-                                //     // Get task
-                                //     int ind = g_queue_index(active_request_queue, task->data);
-                                //     OperatorTask task = g_queue_peek_nth(active_request_queue, ind);
-
-                                //     DEBUG_PRINT(LOG_HEADER "2\n");
-                                //     // Get time of execution
-                                //     struct timeval end; 
-                                //     gettimeofday(&end, NULL);
-                                //     time_t time_took = (end.tv_sec*1000 + end.tv_usec/1000) - (task->start->tv_sec*1000 + task->start->tv_usec/1000);
-                                //     DEBUG_PRINT(LOG_HEADER "3\n");
-
-                                //     // Write to history
-                                //     WorkerExecuteRequestDatagram execute = (WorkerExecuteRequestDatagram)task->datagram;
-                                //     char* res = isnprintf("%d %s %dms\n", task->id_task, execute->data, time_took);
-                                    
-                                //     DEBUG_PRINT(LOG_HEADER "4\n");
-                                //     DEBUG_PRINT(LOG_HEADER "RES: %s\n", res);
-
-                                //     SAFE_WRITE(write_to_history_fd, res, strlen(res));
-                                //     free(res);
-
-                                //     DEBUG_PRINT(LOG_HEADER "CTFQ Index: %d\n", ind);
-
-                                //     g_queue_pop_nth(active_request_queue, ind);
-                                // }
-
-                                GList* task = g_queue_find_custom(active_request_queue, &(res->header.task_id), find_queue_task_by_id);
-                                if (task != NULL) {
-                                    // Get task
-                                    int ind = g_queue_index(active_request_queue, task->data);
-                                    OperatorTask task = g_queue_peek_nth(active_request_queue, ind);
-                                    
-                                    // Get time of execution
-                                    struct timeval end; 
-                                    gettimeofday(&end, NULL);
-                                    time_t time_took = (end.tv_sec*1000 + end.tv_usec/1000) - (task->start->tv_sec*1000 + task->start->tv_usec/1000);
-
-                                    // Write to history
-                                    WorkerExecuteRequestDatagram execute = (WorkerExecuteRequestDatagram)task->datagram;
-                                    char* res = isnprintf("%d %s %dms\n", task->id_task, execute->data, time_took);
-
-                                    CRITICAL_START
-                                        SAFE_WRITE(write_to_history_fd, res, strlen(res));
-                                    CRITICAL_END
-                                    free(res);
-
-                                    DEBUG_PRINT(LOG_HEADER "CTFQ Index: %d\n", ind);
-                                    DEBUG_PRINT(LOG_HEADER "Time elapsed: %ld\n", time_took);
-
-                                    g_queue_pop_nth(active_request_queue, ind);
+                        switch (header.mode) {
+                            case WORKER_DATAGRAM_MODE_COMPLETION_RESPONSE: {
+                                WorkerCompletionResponseDatagram res = (WorkerCompletionResponseDatagram)message;
+
+                                MAIN_LOG(LOG_HEADER "Received Completion Response from Worker #%d.\n", res->worker_id);
+
+                                if(res->worker_id >= 0 && (guint)res->worker_id < worker_array->len) {
+                                    OperatorWorkerEntry entry = get_worker_by_id(worker_array, res->worker_id);
+
+                                    // The task completed before it could be suspended. The signal may have stopped the
+                                    // next task of the worker instead.
+                                    if (entry->status == WORKER_STATUS_SUSPENDED) {
+                                        resume_worker_task(entry);
+                                        num_suspended--;
+                                    }
+
+                                    OperatorTask task = complete_task_from_worker(
+                                        running_tasks, 
+                                        claims, 
+                                        entry, 
+                                        res->header.task_id
+                                    );
+                                    if (task != NULL) {
+                                        uint32_t cpu_time = res->cpu_time;
+                                        uint8_t timed_out = res->timed_out;
+                                        int32_t exit_status = res->exit_status;
+
+                                        // Get time of execution
+                                        struct timeval end; 
+                                        gettimeofday(&end, NULL);
+                                        time_t time_took = (end.tv_sec*1000 + end.tv_usec/1000) - (task->start->tv_sec*1000 + task->start->tv_usec/1000);
+
+                                        // Write to history
+                                        WorkerExecuteRequestDatagram execute = (WorkerExecuteRequestDatagram)task->datagram;
+                                        char* exit_note = (!timed_out && exit_status != 0) 
+                                            ? isnprintf(" (exit %d)", exit_status) 
+                                            : NULL;
+                                        char* res = isnprintf(
+                                            "%d %s %dms%s%s\n", 
+                                            task->id_task, 
+                                            execute->data, 
+                                            time_took, 
+                                            timed_out ? " (timed out)" : "", 
+                                            (exit_note != NULL) ? exit_note : ""
+                                        );
+                                        free(exit_note);
+
+                                        CRITICAL_START
+                                            SAFE_WRITE(write_to_history_fd, res, strlen(res));
+                                        CRITICAL_END
+                                        free(res);
+
+                                        snapshot_complete(
+                                            snapshot, 
+                                            task->snapshot_entry, 
+                                            task->id_task, 
+                                            execute->data, 
+                                            execute->data_len, 
+                                            time_took
+                                        );
+
+                                        admission_release(admission, task->submitter);
+
+                                        // Tasks killed for running past their timeout, or exiting with a non-zero status,
+                                        // did not complete successfully.
+                                        dependency_graph_complete(
+                                            dependencies, 
+                                            task->id_task, 
+                                            !timed_out && exit_status == 0, 
+                                            released_tasks, 
+                                            cancelled_tasks
+                                        );
+
+                                        if (timed_out) {
+                                            MAIN_LOG(
+                                                LOG_HEADER "Task %d was killed after running past its timeout of %ums.\n", 
+                                                task->id_task, 
+                                                execute->timeout
+                                            );
+                                        }
+
+                                        // Only the time spent running is learned, not the time spent in the backlog or
+                                        // suspended. Tasks that were killed or failed did not do their usual work, so
+                                        // their time says nothing.
+                                        int64_t time_ran = (int64_t)end.tv_sec * 1000 + end.tv_usec / 1000 
+                                            - task->dispatched_ms - task->suspended_ms;
+                                        if (estimator != NULL && time_ran >= 0 && !timed_out && exit_status == 0) {
+                                            estimator_observe(estimator, execute->data, execute->data_len, time_ran);
+                                        }
+                                        if (concurrency != NULL && time_ran >= 0) {
+                                            concurrency_observe_task(concurrency, cpu_time, time_ran);
+                                        }
+
+                                        DEBUG_PRINT(LOG_HEADER "Time elapsed: %ld\n", time_took);
+
+                                        destroy_task(task);
+                                    }
+
+                                    // The worker went straight on to its next prefetched task, if it had one.
+                                    start_worker_task(snapshot, entry);
+
+                                    // Reset worker. A worker that is already idle must not be pushed twice.
+                                    if (entry->tasks->length == 0 && entry->status == WORKER_STATUS_BUSY) {
+                                        entry->idle_since_ms = get_current_ms();
+                                        push_idle_worker(idle_workers, entry);
+                                    }
+
+                                    MAIN_LOG(LOG_HEADER "Worker #%d (@%d) finished.\n", res->worker_id, entry->worker->pid);
                                 }
-
-                                // Reset worker
-                                entry->status = WORKER_STATUS_IDLE;
-                                workers_busy--;
-
-                                MAIN_LOG(LOG_HEADER "Worker #%d (@%d) finished.\n", res->worker_id, entry->worker->pid);
+                                break;
+                            }
+                            case WORKER_DATAGRAM_MODE_SKIPPED_RESPONSE: {
+                                WorkerCompletionResponseDatagram res = (WorkerCompletionResponseDatagram)message;
+
+                                // The task was stolen and already runs elsewhere. Only its claim is left to release.
+                                if(res->worker_id >= 0 && (guint)res->worker_id < worker_array->len) {
+                                    OperatorWorkerEntry entry = get_worker_by_id(worker_array, res->worker_id);
+                                    int cell = find_worker_claim(claims, entry->id, res->header.task_id, WORKER_CLAIM_STOLEN);
+                                    if (cell != -1) {
+                                        release_worker_claim(claims, entry->id, cell);
+                                        entry->stolen--;
+                                    }
+                                }
+                                break;
+                            }
+                            default: {
+                                // We should never recieved any requests from the workers.
+                                // If we recieve one, we should ignore them.
+                                continue;
                             }
-                            break;
-                        }
-                        default: {
-                            // We should never recieved any requests from the workers.
-                            // If we recieve one, we should ignore them.
-                            drain_fifo(pd[0]);
-                            continue;
                         }
+                        break;
+                    }
+                    default: {
+                        // Unknown message. The ring keeps the framing, so just skip it.
+                        continue;
                     }
-                    break;
                 }
             }
 
+            // Tasks whose dependencies all completed join the backlog.
+            for (guint i = 0; i < released_tasks->len; i++) {
+                OperatorTask task = g_array_index(released_tasks, OperatorTask, i);
+                MAIN_LOG(LOG_HEADER "Releasing task %d, as the tasks it depends on completed.\n", task->id_task);
+                add_task_to_backlog(request_waiting_queue, task);
+            }
+            g_array_set_size(released_tasks, 0);
+
+            // Tasks depending on a failed task never run, and are only recorded in the history.
+            for (guint i = 0; i < cancelled_tasks->len; i++) {
+                OperatorTask task = g_array_index(cancelled_tasks, OperatorTask, i);
+                WorkerExecuteRequestDatagram execute = (WorkerExecuteRequestDatagram)task->datagram;
+                MAIN_LOG(LOG_HEADER "Cancelling task %d, as a task it depends on failed.\n", task->id_task);
+
+                char* res = isnprintf("%d %s 0ms (cancelled)\n", task->id_task, execute->data);
+                CRITICAL_START
+                    SAFE_WRITE(write_to_history_fd, res, strlen(res));
+                CRITICAL_END
+                free(res);
+
+                snapshot_cancel(snapshot, task->snapshot_entry);
+                admission_release(admission, task->submitter);
+                destroy_task(task);
+            }
+            g_array_set_size(cancelled_tasks, 0);
+
             // Take cycle opportunity to attempt to execute queued requests.
             MAIN_LOG(LOG_HEADER "Attempting to dispatch queued tasks.\n");
 
             DEBUG_PRINT(
                 LOG_HEADER "Tasks in backlog: %d | Tasks in execution: %d\n", 
                 request_waiting_queue->length, 
-                active_request_queue->length
+                g_hash_table_size(running_tasks)
             );
 
-            DEBUG_PRINT(LOG_HEADER "Workers available: %d/%d\n", num_parallel_tasks - workers_busy, num_parallel_tasks);
+            // Adapt the number of running tasks to the CPU load, before dispatching under the new limit.
+            if (concurrency != NULL) {
+                int64_t last_sample_ms = concurrency->sample.time_ms;
+                next_adjustment = concurrency_adjust(concurrency, get_current_ms());
+                task_limit = get_concurrency_limit(concurrency);
+
+                if (concurrency->sample.time_ms != last_sample_ms) {
+                    snapshot_set_concurrency(
+                        snapshot, 
+                        task_limit, 
+                        min_concurrency, 
+                        concurrency->cpu_busy, 
+                        concurrency->cpu_pressure, 
+                        concurrency->task_cpu
+                    );
+                }
+            }
+
+            // Suspended tasks take back the slots freed since, unless a more urgent task is queued for them.
+            while (num_suspended > 0 && num_workers - (int)idle_workers->len - num_suspended < task_limit) {
+                OperatorWorkerEntry entry = find_resumable_worker(worker_array);
+                if (entry == NULL) break;
+
+                OperatorTask task = g_queue_peek_head(entry->tasks);
+                if (task != NULL && task->priority < get_backlog_priority(request_waiting_queue)) break;
+
+                resume_worker_task(entry);
+                num_suspended--;
+            }
+
+            // Grow the pool while more tasks are queued than there are idle workers to take them. Suspended workers do
+            // not count against its size.
+            int pool_size = num_workers;
+            while (
+                request_waiting_queue->length > idle_workers->len 
+                && num_workers - num_suspended < num_parallel_tasks 
+                && num_workers - num_suspended < task_limit
+            ) {
+                OperatorWorkerEntry entry = start_pool_worker(worker_array, ring, claims, placement, output_dir);
+                if (entry == NULL) break;
+
+                push_idle_worker(idle_workers, entry);
+                num_workers++;
+            }
+
+            DEBUG_PRINT(LOG_HEADER "Workers available: %d/%d\n", idle_workers->len, num_workers);
             if (request_waiting_queue->length > 0) {
 
-                if (workers_busy == num_parallel_tasks) {
-                    MAIN_LOG(LOG_HEADER "Unable to dispatch tasks: All workers are busy.\n");
-                    continue;
+                if (idle_workers->len == 0) {
+                    MAIN_LOG(LOG_HEADER "All workers are busy. Prefetching queued tasks.\n");
                 }
 
-                OperatorWorkerEntry entry = get_idle_worker(worker_array);
-                OperatorTask task = prepare_task_from_queue(request_waiting_queue, active_request_queue);
+                // A single cycle may consume several submissions, so dispatch until every worker is busy.
+                while (
+                    request_waiting_queue->length > 0 
+                    && idle_workers->len > 0 
+                    && num_workers - (int)idle_workers->len - num_suspended < task_limit
+                ) {
+                    OperatorWorkerEntry entry = pop_idle_worker(idle_workers);
+                    OperatorTask task = prepare_task_from_queue(request_waiting_queue, running_tasks, claims, entry);
+
+                    execute_task(entry, task);
+                    start_worker_task(snapshot, entry);
+                }
 
-                execute_task(entry, task);
-                entry->status = WORKER_STATUS_BUSY;
-                workers_busy++;
-            } else {
-                DEBUG_PRINT(LOG_HEADER "No execute tasks queued.\n");
-            }
+                // Queued tasks of a higher class than a running task do not wait for it. It is suspended, and its slot
+                // lent to them, on an idle worker, or on a new one above the pool size.
+                while (request_waiting_queue->length > 0) {
+                    int priority = get_backlog_priority(request_waiting_queue);
+                    OperatorWorkerEntry victim = find_preemption_victim(worker_array, priority);
+                    if (victim == NULL) break;
 
-            // if(status_request_queue->length > 0) {
-            if (0) {
-                OperatorWorkerEntry entry = g_array_index(worker_array, OperatorWorkerEntry, 0);
-                if(entry->status == WORKER_STATUS_IDLE) {
-                    OperatorTask task = get_next_task(status_request_queue);
-                    int num_clients = status_request_queue->length;
-                    int* clients = SAFE_ALLOC(int*, sizeof(int) * num_clients);
-
-                    UNUSED(task);
-                    
-                    for(int i = 0 ; i < num_clients ; i++) {
-                        OperatorTask task = g_queue_peek_nth(status_request_queue, i);
-                        clients[i] = (uintptr_t)(task->datagram);
-                    }
+                    OperatorWorkerEntry entry = pop_idle_worker(idle_workers);
+                    if (entry == NULL) {
+                        entry = start_pool_worker(worker_array, ring, claims, placement, output_dir);
+                        if (entry == NULL) break;
 
-                    int num_tasks = request_waiting_queue->length + active_request_queue->length;
-                    WorkerStatusPayload* tasks = SAFE_ALLOC(WorkerStatusPayload*, sizeof(WorkerStatusPayload) * num_tasks);
-                    for(int i = 0 ; request_waiting_queue->length ; i++) {
-                        OperatorTask task = g_queue_peek_nth(request_waiting_queue, i);
-                        tasks[i]->task_id = task->id_task;
-                        WorkerExecuteRequestDatagram execute = (WorkerExecuteRequestDatagram)task->datagram;
-                        memcpy(tasks[i]->data, execute->data, sizeof(EXECUTE_REQUEST_DATAGRAM_PAYLOAD_LEN + 1));
-                    }
-                    for(int i = request_waiting_queue->length, j = 0 ; i < num_tasks ; i++, j++) {
-                        OperatorTask task = g_queue_peek_nth(active_request_queue, j);
-                        tasks[i]->task_id = task->id_task;
-                        WorkerExecuteRequestDatagram execute = (WorkerExecuteRequestDatagram)task->datagram;
-                        memcpy(tasks[i]->data, execute->data, sizeof(EXECUTE_REQUEST_DATAGRAM_PAYLOAD_LEN + 1));
+                        entry->status = WORKER_STATUS_BUSY;
+                        num_workers++;
                     }
 
-                    WorkerStatusRequestDatagram req = create_worker_status_request_datagram(
-                        num_clients, 
-                        clients, 
-                        request_waiting_queue->length,
-                        num_tasks,
-                        tasks
-                    );
+                    suspend_worker_task(victim);
+                    num_suspended++;
 
-                    // Write Worker Status Request Datagram
-                    {
-                        uint8_t* dg = SAFE_ALLOC(
-                            uint8_t*, 
-                            sizeof(WORKER_DATAGRAM_HEADER) 
-                            + sizeof(int) + sizeof(int) * req->num_clients
-                            + sizeof(int) + sizeof(WorkerStatusPayload) * req->num_tasks
-                        );
-
-                        // Copy header
-                        memcpy(dg, &(req->header), sizeof(WORKER_DATAGRAM_HEADER));
-
-                        // Copy clients
-                        memcpy((((void*)(dg)) + sizeof(WORKER_DATAGRAM_HEADER)), &(req->num_clients), sizeof(int));
-                        memcpy((((void*)(dg)) + sizeof(WORKER_DATAGRAM_HEADER) + sizeof(int)), req->clients, req->num_clients * sizeof(int));
-
-                        // Copy tasks
-                        memcpy(
-                            (((void*)(dg)) + sizeof(WORKER_DATAGRAM_HEADER) + sizeof(int) + req->num_clients * sizeof(int)), 
-                            &(req->num_tasks_queued), 
-                            sizeof(int)
-                        );
-                        memcpy(
-                            (((void*)(dg)) + sizeof(WORKER_DATAGRAM_HEADER) + sizeof(int) + req->num_clients * sizeof(int) + sizeof(int)), 
-                            &(req->num_tasks), 
-                            sizeof(int)
-                        );
-                        memcpy(
-                            (((void*)(dg)) + sizeof(WORKER_DATAGRAM_HEADER) + sizeof(int) + req->num_clients * sizeof(int) + sizeof(int) + sizeof(int)), 
-                            req->tasks, 
-                            req->num_clients * sizeof(WorkerStatusPayload)
-                        );
-
-                        SAFE_WRITE(
-                            entry->worker->pipe_write, 
-                            dg, 
-                            sizeof(WORKER_DATAGRAM_HEADER) 
-                                + sizeof(int) 
-                                + req->num_clients * sizeof(int) 
-                                + sizeof(int) 
-                                + sizeof(int) 
-                                + req->num_clients * sizeof(WorkerStatusPayload)
-                        );
-                    }
+                    OperatorTask task = prepare_task_from_queue(request_waiting_queue, running_tasks, claims, entry);
+                    execute_task(entry, task);
+                    start_worker_task(snapshot, entry);
+                }
+
+                // Then give busy workers their next tasks ahead of time, so that they do not wait on the operator
+                // between tasks. Workers with the fewest tasks are topped up first.
+                for (int depth = 1; depth <= prefetch && request_waiting_queue->length > 0; depth++) {
+                    for (guint i = 0; i < worker_array->len && request_waiting_queue->length > 0; i++) {
+                        OperatorWorkerEntry entry = get_worker_by_id(worker_array, i);
+                        if ((int)entry->tasks->length != depth || !has_worker_credit(entry, prefetch)) continue;
+                        if (entry->status == WORKER_STATUS_SUSPENDED) continue;
 
+                        OperatorTask task = prepare_task_from_queue(request_waiting_queue, running_tasks, claims, entry);
+                        execute_task(entry, task);
+                    }
                 }
             } else {
-                DEBUG_PRINT(LOG_HEADER "No status tasks queued.\n");
+                DEBUG_PRINT(LOG_HEADER "No execute tasks queued.\n");
+            }
+
+            // Tasks still queued once the limit is reached wait only on the limit, which may then grow.
+            if (
+                concurrency != NULL 
+                && request_waiting_queue->length > 0 
+                && num_workers - (int)idle_workers->len - num_suspended >= task_limit
+            ) {
+                concurrency_mark_limited(concurrency);
+            }
+
+            // With the backlog empty, idle workers steal the tasks prefetched by busy workers.
+            while (
+                request_waiting_queue->length == 0 
+                && idle_workers->len > 0 
+                && num_workers - (int)idle_workers->len - num_suspended < task_limit
+            ) {
+                OperatorWorkerEntry entry = pop_idle_worker(idle_workers);
+                OperatorTask task = steal_task_for_worker(worker_array, claims, entry);
+                if (task == NULL) {
+                    push_idle_worker(idle_workers, entry);
+                    break;
+                }
+
+                MAIN_LOG(LOG_HEADER "Worker #%d stole task %d.\n", entry->id, task->id_task);
+                execute_task(entry, task);
+                start_worker_task(snapshot, entry);
+            }
+
+            // Shrink the pool once the workers it grew by are no longer needed.
+            wait_timeout = shrink_worker_pool(
+                idle_workers, 
+                retiring, 
+                &num_workers, 
+                min_workers, 
+                num_parallel_tasks + num_suspended, 
+                idle_timeout
+            );
+            reap_retired_workers(retiring);
+            if (retiring->len > 0 && (wait_timeout == -1 || wait_timeout > SHUTDOWN_TIMEOUT_INTERVAL)) {
+                // Retired workers exit right away. Come back shortly to reap them.
+                wait_timeout = SHUTDOWN_TIMEOUT_INTERVAL;
+            }
+
+            // Tasks waiting on the limit need it adjusted, even if no message comes in meanwhile.
+            if (
+                concurrency != NULL 
+                && request_waiting_queue->length > 0 
+                && (wait_timeout == -1 || next_adjustment < wait_timeout)
+            ) {
+                wait_timeout = next_adjustment;
             }
+            if (num_workers != pool_size) snapshot_set_pool(snapshot, num_workers, min_workers, num_parallel_tasks);
         }
 
         // Handle graceful shutdown.
         #pragma region ======= GRACEFUL SHUTDOWN =======
         MAIN_LOG(LOG_HEADER "Shutting down operator...\n");
 
+        // Suspended tasks would never complete, and keep their workers from shutting down.
+        for (guint i = 0; i < worker_array->len; i++) {
+            OperatorWorkerEntry entry = g_array_index(worker_array, OperatorWorkerEntry, i);
+            if (entry->status == WORKER_STATUS_SUSPENDED) resume_worker_task(entry);
+        }
+
+        // Every live worker is asked to shut down first, so that they finish their tasks side by side.
         for (guint i = 0; i < worker_array->len; i++) {
             OperatorWorkerEntry entry = g_array_index(worker_array, OperatorWorkerEntry, i);
+            if (entry->status == WORKER_STATUS_STOPPED) continue;
+
             MAIN_LOG(
                 LOG_HEADER "Shutting down worker #%d @ %d\n", 
                 i, 
@@ -609,35 +1342,45 @@ OPERATOR start_operator(int num_parallel_tasks, char* output_dir, char* history_
 
             WorkerShutdownRequestDatagram request = create_worker_shutdown_request_datagram();
             SAFE_WRITE(entry->worker->pipe_write, request, sizeof(WORKER_SHUTDOWN_REQUEST_DATAGRAM));
+            free(request);
+        }
+
+        // The whole pool shares a single timeout, however many slots it has.
+        int elapsed = 0;
+        for (guint i = 0; i < worker_array->len; i++) {
+            OperatorWorkerEntry entry = g_array_index(worker_array, OperatorWorkerEntry, i);
+            if (entry->status == WORKER_STATUS_STOPPED) continue;
 
             int status;
-            int elapsed = 0;
             int shutdown = 0;
             int wret = 0;
-            while ((elapsed += SHUTDOWN_TIMEOUT_INTERVAL) < SHUTDOWN_TIMEOUT / (int)(worker_array->len)) {
+            for (;;) {
                 wret = waitpid(entry->worker->pid, &status, WNOHANG);
                 if (wret == -1) {
                     _exit(1);
                 }
 
-                usleep(SHUTDOWN_TIMEOUT_INTERVAL * 1000);
-            
-                if (wret && WIFEXITED(status)) {
+                if (wret) {
                     DEBUG_PRINT(
                         LOG_HEADER "Worker #%d @ %d exited with code %d\n", 
                         i, 
                         entry->worker->pid, 
-                        WEXITSTATUS(status)
+                        WIFEXITED(status) ? WEXITSTATUS(status) : -1
                     );
                     shutdown = 1;
                     break;
                 }
+
+                if (elapsed >= SHUTDOWN_TIMEOUT) break;
+                usleep(SHUTDOWN_TIMEOUT_INTERVAL * 1000);
+                elapsed += SHUTDOWN_TIMEOUT_INTERVAL;
             }
 
             // Worker refuses to shutdown, suicide it.
             if (!shutdown) {
                 MAIN_LOG(LOG_HEADER "Worker has not closed within the acceptable timeout. Forcefully killing process.\n");
                 kill(entry->worker->pid, SIGKILL);
+                waitpid(entry->worker->pid, NULL, 0);
             }
 
             MAIN_LOG(
@@ -647,8 +1390,30 @@ OPERATOR start_operator(int num_parallel_tasks, char* output_dir, char* history_
             );
         }
         
+        // Retired workers were idle, and exit right away.
+        for (guint i = 0; i < retiring->len; i++) {
+            waitpid(g_array_index(retiring, pid_t, i), NULL, 0);
+        }
+        g_array_free(retiring, TRUE);
+
         close(write_to_history_fd);
-        close(pd[0]);
+        close_ring(ring);
+        destroy_ring(ring);
+        destroy_snapshot(snapshot);
+        destroy_backlog(request_waiting_queue);
+        destroy_dependency_graph(dependencies, (GDestroyNotify)destroy_task);
+        g_array_free(released_tasks, TRUE);
+        g_array_free(cancelled_tasks, TRUE);
+        destroy_worker_claims(claims);
+        if (estimator != NULL) {
+            save_estimator(estimator);
+            destroy_estimator(estimator);
+        }
+        destroy_concurrency_limit(concurrency);
+        destroy_cpu_placement(placement);
+        g_hash_table_destroy(running_tasks);
+        g_array_free(idle_workers, TRUE);
+        free(message);
 
         MAIN_LOG(LOG_HEADER "Successfully closed operator.\n");
         _exit(0);
@@ -658,7 +1423,8 @@ OPERATOR start_operator(int num_parallel_tasks, char* output_dir, char* history_
 
         OPERATOR op = (OPERATOR){
             .pid = pid,
-            .pd_write = pd[1]
+            .ring = ring,
+            .snapshot = snapshot
         };
 
         return op;
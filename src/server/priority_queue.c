@@ -0,0 +1,99 @@
+/******************************************************************************
+ *                              PRIORITY QUEUE                                *
+ *                                                                            *
+ *   The Priority Queue holds the backlog of the operator process. It is an   *
+ * array-backed binary heap, ordered by the comparator of the escalation      *
+ * policy, with O(log n) insertion and removal of the first task.             *
+ *   Elements that compare as equal leave the queue in the order they were   *
+ * inserted, like they did when the backlog was a sorted list.                *
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include "server/priority_queue.h"
+
+PriorityQueue create_priority_queue(GCompareDataFunc compare, gpointer user_data) {
+    PriorityQueue queue = malloc(sizeof(PRIORITY_QUEUE));
+    if (queue == NULL) return NULL;
+
+    queue->entries = malloc(PRIORITY_QUEUE_INITIAL_CAPACITY * sizeof(PRIORITY_QUEUE_ENTRY));
+    if (queue->entries == NULL) {
+        free(queue);
+        return NULL;
+    }
+
+    queue->length = 0;
+    queue->capacity = PRIORITY_QUEUE_INITIAL_CAPACITY;
+    queue->next_order = 0;
+    queue->compare = compare;
+    queue->user_data = user_data;
+
+    return queue;
+}
+
+/**
+ * @brief Checks whether an entry should leave the queue before another.
+ */
+static inline int priority_queue_before(PriorityQueue queue, PriorityQueueEntry a, PriorityQueueEntry b) {
+    gint cmp = queue->compare(a->data, b->data, queue->user_data);
+    return (cmp != 0) ? (cmp < 0) : (a->order < b->order);
+}
+
+int priority_queue_push(PriorityQueue queue, gpointer data) {
+    if (queue->length == queue->capacity) {
+        PriorityQueueEntry entries = realloc(queue->entries, 2 * queue->capacity * sizeof(PRIORITY_QUEUE_ENTRY));
+        if (entries == NULL) return 1;
+
+        queue->entries = entries;
+        queue->capacity *= 2;
+    }
+
+    PRIORITY_QUEUE_ENTRY entry = { .data = data, .order = queue->next_order++ };
+
+    // Sift up: move the parents down until the new entry fits.
+    guint i = queue->length++;
+    while (i > 0) {
+        guint parent = (i - 1) / 2;
+        if (!priority_queue_before(queue, &entry, &queue->entries[parent])) break;
+
+        queue->entries[i] = queue->entries[parent];
+        i = parent;
+    }
+    queue->entries[i] = entry;
+
+    return 0;
+}
+
+gpointer priority_queue_peek(PriorityQueue queue) {
+    return (queue->length > 0) ? queue->entries[0].data : NULL;
+}
+
+gpointer priority_queue_pop(PriorityQueue queue) {
+    if (queue->length == 0) return NULL;
+
+    gpointer data = queue->entries[0].data;
+    PRIORITY_QUEUE_ENTRY last = queue->entries[--queue->length];
+
+    // Sift down: move the earliest child up until the last entry fits.
+    guint i = 0;
+    for (;;) {
+        guint child = 2 * i + 1;
+        if (child >= queue->length) break;
+        if (child + 1 < queue->length && priority_queue_before(queue, &queue->entries[child + 1], &queue->entries[child])) {
+            child++;
+        }
+        if (!priority_queue_before(queue, &queue->entries[child], &last)) break;
+
+        queue->entries[i] = queue->entries[child];
+        i = child;
+    }
+    if (queue->length > 0) queue->entries[i] = last;
+
+    return data;
+}
+
+void destroy_priority_queue(PriorityQueue queue) {
+    if (queue == NULL) return;
+
+    free(queue->entries);
+    free(queue);
+}
@@ -0,0 +1,253 @@
+/******************************************************************************
+ *                                REPLY QUEUE                                 *
+ *                                                                            *
+ *   The Reply Queue delivers the replies of the main server to its clients   *
+ * without ever blocking the event loop.                                      *
+ *   A reply is first attempted right away, through a non-blocking open of    *
+ * the FIFO of the client, or a non-blocking send on its connection. If the   *
+ * client is not ready to receive it, the reply is kept pending and retried   *
+ * on every cycle of the event loop, until it is delivered or its timeout     *
+ * runs out, in which case it is dropped and counted.                         *
+ *   Replies to the same client are always delivered in order. Each client    *
+ * has its own queue of pending replies, and only the first one is retried.   *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <sys/socket.h>
+#include <errno.h>
+#include <time.h>
+#include "server/reply.h"
+#include "common/io/io.h"
+#include "common/io/fifo.h"
+#include "common/util/alloc.h"
+
+#define LOG_HEADER "[MAIN] "
+
+#define REPLY_DELIVERED 1
+#define REPLY_NOT_READY 0
+#define REPLY_CLIENT_GONE -1
+
+/**
+ * @brief Returns the current time of the monotonic clock, in milliseconds.
+ */
+static uint64_t reply_clock() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Attempts to deliver the remainder of a reply without blocking.
+ *
+ * @param target  The client the reply is for.
+ * @param fifo_fd The FIFO of the client, if already opened, or -1. Updated if the FIFO is opened but the reply is not
+ *                fully written.
+ * @param data    The reply.
+ * @param size    The size of the reply.
+ * @param offset  The number of bytes already written. Updated with the bytes written.
+ *
+ * @return REPLY_DELIVERED, REPLY_NOT_READY if it should be retried later, or REPLY_CLIENT_GONE.
+ */
+static int try_reply(REPLY_TARGET target, int* fifo_fd, const uint8_t* data, size_t size, size_t* offset) {
+    if (target.fd != -1) {
+        // Sequenced packets are sent whole or not at all.
+        ssize_t sent;
+        do {
+            sent = send(target.fd, data, size, MSG_NOSIGNAL | MSG_DONTWAIT);
+        } while (sent == -1 && errno == EINTR);
+
+        if (sent == -1) return (errno == EAGAIN || errno == EWOULDBLOCK) ? REPLY_NOT_READY : REPLY_CLIENT_GONE;
+
+        *offset = size;
+        return REPLY_DELIVERED;
+    }
+
+    if (*fifo_fd == -1) {
+        char* client_fifo_name = isnprintf(CLIENT_FIFO "%d", target.pid);
+        char* client_fifo_path = join_paths(2, "build/", client_fifo_name);
+
+        // Fails with ENXIO until the client opens its end, instead of waiting for it.
+        *fifo_fd = open(client_fifo_path, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        int open_errno = errno;
+
+        free(client_fifo_path);
+        free(client_fifo_name);
+
+        if (*fifo_fd == -1) return (open_errno == ENXIO || open_errno == EINTR) ? REPLY_NOT_READY : REPLY_CLIENT_GONE;
+    }
+
+    while (*offset < size) {
+        ssize_t written = write(*fifo_fd, data + *offset, size - *offset);
+        if (written == -1) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return REPLY_NOT_READY;
+
+            close(*fifo_fd);
+            *fifo_fd = -1;
+            return REPLY_CLIENT_GONE;
+        }
+
+        *offset += written;
+    }
+
+    close(*fifo_fd);
+    *fifo_fd = -1;
+    return REPLY_DELIVERED;
+}
+
+/**
+ * @brief Returns the key of the pending replies of a client. Connections and FIFOs never share a key.
+ */
+static inline gpointer get_reply_client_key(REPLY_TARGET target) {
+    return (target.fd != -1) ? GINT_TO_POINTER(target.fd + 1) : GINT_TO_POINTER(-target.pid);
+}
+
+/**
+ * @brief Logs a dropped reply.
+ */
+static void log_dropped_reply(REPLY_TARGET target, const char* reason) {
+    if (target.fd != -1) {
+        printf(LOG_HEADER "Reply to connection %d dropped: %s.\n", target.fd, reason);
+    } else {
+        printf(LOG_HEADER "Reply to client %d dropped: %s.\n", target.pid, reason);
+    }
+}
+
+/**
+ * @brief Drops the first pending reply of a client, counting it.
+ */
+static void drop_reply(ReplyQueue queue, GQueue* client, const char* reason) {
+    PendingReply reply = g_queue_pop_head(client);
+    log_dropped_reply(reply->target, reason);
+
+    if (reply->fifo_fd != -1) close(reply->fifo_fd);
+    free(reply);
+
+    queue->dropped++;
+}
+
+/**
+ * @brief Frees the queue of a client that has no pending replies left. It must no longer be waiting.
+ */
+static void remove_reply_client(ReplyQueue queue, GQueue* client, gpointer key) {
+    g_hash_table_remove(queue->clients, key);
+    g_queue_free(client);
+}
+
+ReplyQueue create_reply_queue(int timeout) {
+    #define ERR NULL
+
+    ReplyQueue queue = SAFE_ALLOC(ReplyQueue, sizeof(REPLY_QUEUE));
+    queue->clients = g_hash_table_new(g_direct_hash, g_direct_equal);
+    queue->waiting = g_queue_new();
+    queue->timeout = timeout;
+    queue->dropped = 0;
+
+    return queue;
+    #undef ERR
+}
+
+void send_reply(ReplyQueue queue, REPLY_TARGET target, const void* data, size_t size) {
+    #define ERR
+    int fifo_fd = -1;
+    size_t offset = 0;
+
+    // Replies queued for the same client go first, so only try right away if there are none.
+    GQueue* client = g_hash_table_lookup(queue->clients, get_reply_client_key(target));
+
+    if (client == NULL) {
+        int status = try_reply(target, &fifo_fd, data, size, &offset);
+        if (status == REPLY_DELIVERED) return;
+
+        if (status == REPLY_CLIENT_GONE) {
+            log_dropped_reply(target, "client is gone");
+            queue->dropped++;
+            return;
+        }
+    }
+
+    PendingReply reply = SAFE_ALLOC(PendingReply, sizeof(PENDING_REPLY) + size);
+    reply->target = target;
+    reply->fifo_fd = fifo_fd;
+    reply->deadline = reply_clock() + queue->timeout;
+    reply->size = size;
+    reply->offset = offset;
+    memcpy(reply->data, data, size);
+
+    if (client == NULL) {
+        client = g_queue_new();
+        g_hash_table_insert(queue->clients, get_reply_client_key(target), client);
+        g_queue_push_tail(queue->waiting, client);
+    }
+    g_queue_push_tail(client, reply);
+    #undef ERR
+}
+
+int retry_replies(ReplyQueue queue) {
+    if (g_queue_is_empty(queue->waiting)) return -1;
+
+    uint64_t now = reply_clock();
+
+    // Every client is taken off the waiting list, and put back if it still has pending replies.
+    for (guint remaining = queue->waiting->length; remaining > 0; remaining--) {
+        GQueue* client = g_queue_pop_head(queue->waiting);
+        gpointer key = get_reply_client_key(((PendingReply)g_queue_peek_head(client))->target);
+
+        // Only the first reply is retried, as every other one waits for it. Once it is delivered, the next one goes.
+        PendingReply reply;
+        while ((reply = g_queue_peek_head(client)) != NULL) {
+            int status = try_reply(reply->target, &reply->fifo_fd, reply->data, reply->size, &reply->offset);
+            if (status == REPLY_NOT_READY) break;
+
+            if (status == REPLY_DELIVERED) {
+                g_queue_pop_head(client);
+                free(reply);
+            } else {
+                drop_reply(queue, client, "client is gone");
+            }
+        }
+
+        // Replies to a client all wait as long, so the ones that timed out are always the first.
+        while ((reply = g_queue_peek_head(client)) != NULL && now >= reply->deadline) {
+            drop_reply(queue, client, "timed out");
+        }
+
+        if (g_queue_is_empty(client)) remove_reply_client(queue, client, key);
+        else g_queue_push_tail(queue->waiting, client);
+    }
+
+    return g_queue_is_empty(queue->waiting) ? -1 : REPLY_RETRY_INTERVAL;
+}
+
+void cancel_replies(ReplyQueue queue, int fd) {
+    REPLY_TARGET target = { .pid = 0, .fd = fd };
+    gpointer key = get_reply_client_key(target);
+
+    GQueue* client = g_hash_table_lookup(queue->clients, key);
+    if (client == NULL) return;
+
+    while (!g_queue_is_empty(client)) drop_reply(queue, client, "connection closed");
+
+    g_queue_remove(queue->waiting, client);
+    remove_reply_client(queue, client, key);
+}
+
+void destroy_reply_queue(ReplyQueue queue) {
+    if (queue == NULL) return;
+
+    GQueue* client;
+    while ((client = g_queue_pop_head(queue->waiting)) != NULL) {
+        PendingReply reply;
+        while ((reply = g_queue_pop_head(client)) != NULL) {
+            if (reply->fifo_fd != -1) close(reply->fifo_fd);
+            free(reply);
+        }
+
+        g_queue_free(client);
+    }
+
+    g_hash_table_destroy(queue->clients);
+    g_queue_free(queue->waiting);
+    free(queue);
+}
@@ -0,0 +1,227 @@
+/******************************************************************************
+ *                               MESSAGE RING                                 *
+ *                                                                            *
+ *   The Message Ring is the event channel of the operator process. It is a   *
+ * bounded multi-producer, single-consumer queue living in shared memory,     *
+ * written to by the main server and by every worker, and read only by the   *
+ * operator.                                                                  *
+ *   The ring is split into fixed-size slots. A message takes as many        *
+ * consecutive slots as it needs, and the first slot holds its type and      *
+ * length, which replaces the process marks previously written before every  *
+ * message on the operator pipe.                                              *
+ *   Producers claim slots with a compare-and-swap on the tail of the ring,   *
+ * and publish a message by updating the sequence number of its first slot.  *
+ * The consumer only sleeps when the ring is empty, in which case producers   *
+ * ring an eventfd doorbell to wake it up.                                    *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <sched.h>
+#include <errno.h>
+#include <time.h>
+#include "server/ring.h"
+#include "common/io/io.h"
+#include "common/util/alloc.h"
+
+#define RING_MASK (RING_NUM_SLOTS - 1)
+#define RING_SPAN(length) (((length) + RING_SLOT_SIZE - 1) / RING_SLOT_SIZE + ((length) == 0))
+#define RING_FULL_SPINS 64
+#define RING_FULL_SLEEP_NS 50000
+
+Ring create_ring() {
+    #define ERR NULL
+    Ring ring = SAFE_ALLOC(Ring, sizeof(RING));
+
+    // The memfd is only needed to back the mapping. It can be closed as soon as it is mapped.
+    int memfd = memfd_create("orchestrator-ring", MFD_CLOEXEC);
+    if (memfd == -1) {
+        perror(ERROR_STR_HEADER "Unable to create ring memory");
+        free(ring);
+        return ERR;
+    }
+
+    if (ftruncate(memfd, sizeof(RING_SHARED)) == -1) {
+        perror(ERROR_STR_HEADER "Unable to size ring memory");
+        close(memfd);
+        free(ring);
+        return ERR;
+    }
+
+    ring->shared = mmap(NULL, sizeof(RING_SHARED), PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    close(memfd);
+    if (ring->shared == MAP_FAILED) {
+        perror(ERROR_STR_HEADER "Unable to map ring memory");
+        free(ring);
+        return ERR;
+    }
+
+    ring->doorbell = eventfd(0, EFD_CLOEXEC);
+    if (ring->doorbell == -1) {
+        perror(ERROR_STR_HEADER "Unable to create ring doorbell");
+        munmap(ring->shared, sizeof(RING_SHARED));
+        free(ring);
+        return ERR;
+    }
+
+    // Every slot starts free for its own position on the first lap.
+    for (uint64_t i = 0; i < RING_NUM_SLOTS; i++) {
+        atomic_init(&ring->shared->slots[i].sequence, i);
+    }
+
+    return ring;
+    #undef ERR
+}
+
+/**
+ * @brief Copies bytes into the data of the ring, wrapping around its end.
+ */
+static inline void ring_copy_in(Ring ring, size_t offset, const void* src, size_t len) {
+    size_t first = sizeof(ring->shared->data) - offset;
+    if (first > len) first = len;
+
+    memcpy(ring->shared->data + offset, src, first);
+    memcpy(ring->shared->data, (const uint8_t*)src + first, len - first);
+}
+
+/**
+ * @brief Copies bytes out of the data of the ring, wrapping around its end.
+ */
+static inline void ring_copy_out(Ring ring, size_t offset, void* dst, size_t len) {
+    size_t first = sizeof(ring->shared->data) - offset;
+    if (first > len) first = len;
+
+    memcpy(dst, ring->shared->data + offset, first);
+    memcpy((uint8_t*)dst + first, ring->shared->data, len - first);
+}
+
+int ring_write(Ring ring, uint16_t type, const struct iovec* iov, int iovcnt) {
+    size_t length = 0;
+    for (int i = 0; i < iovcnt; i++) length += iov[i].iov_len;
+    if (length > RING_MAX_MESSAGE_SIZE) return 1;
+
+    RingShared shared = ring->shared;
+    uint64_t span = RING_SPAN(length);
+    uint64_t pos = atomic_load_explicit(&shared->tail, memory_order_relaxed);
+    int spins = 0;
+
+    // Claim span consecutive slots. The consumer frees slots in order, so if the last slot of the span is free for
+    // this lap, so is every slot before it.
+    for (;;) {
+        uint64_t last = pos + span - 1;
+        uint64_t sequence = atomic_load_explicit(&shared->slots[last & RING_MASK].sequence, memory_order_acquire);
+        int64_t diff = (int64_t)(sequence - last);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                &shared->tail, &pos, pos + span, memory_order_relaxed, memory_order_relaxed
+            )) break;
+        } else if (diff < 0) {
+            // The ring is full. Wait for the consumer to free some slots.
+            if (atomic_load_explicit(&shared->closed, memory_order_relaxed)) return 1;
+
+            if (++spins < RING_FULL_SPINS) {
+                sched_yield();
+            } else {
+                nanosleep(&(struct timespec){ .tv_nsec = RING_FULL_SLEEP_NS }, NULL);
+            }
+            pos = atomic_load_explicit(&shared->tail, memory_order_relaxed);
+        } else {
+            // Another producer claimed these slots first.
+            pos = atomic_load_explicit(&shared->tail, memory_order_relaxed);
+        }
+    }
+
+    size_t offset = (pos & RING_MASK) * RING_SLOT_SIZE;
+    for (int i = 0; i < iovcnt; i++) {
+        ring_copy_in(ring, offset, iov[i].iov_base, iov[i].iov_len);
+        offset = (offset + iov[i].iov_len) % sizeof(shared->data);
+    }
+
+    RingSlot slot = &shared->slots[pos & RING_MASK];
+    slot->type = type;
+    slot->length = length;
+    atomic_store(&slot->sequence, pos + 1);
+
+    // Only pay for the doorbell if the consumer is actually asleep.
+    if (atomic_load(&shared->waiting)) {
+        uint64_t one = 1;
+        while (write(ring->doorbell, &one, sizeof(uint64_t)) == -1 && errno == EINTR);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Checks whether the message at the head of the ring has been published.
+ */
+static inline int ring_ready(Ring ring) {
+    return atomic_load(&ring->shared->slots[ring->head & RING_MASK].sequence) == ring->head + 1;
+}
+
+ssize_t ring_read(Ring ring, uint16_t* type, void* buf) {
+    if (!ring_ready(ring)) return -1;
+
+    RingShared shared = ring->shared;
+    RingSlot slot = &shared->slots[ring->head & RING_MASK];
+    size_t length = slot->length;
+    uint64_t span = RING_SPAN(length);
+
+    *type = slot->type;
+    ring_copy_out(ring, (ring->head & RING_MASK) * RING_SLOT_SIZE, buf, length);
+
+    // Free every slot of the message for the next lap, in order, so that no producer sees the last slot of its span
+    // free before the ones preceding it.
+    for (uint64_t i = 0; i < span; i++) {
+        uint64_t pos = ring->head + i;
+        atomic_store_explicit(&shared->slots[pos & RING_MASK].sequence, pos + RING_NUM_SLOTS, memory_order_release);
+    }
+    ring->head += span;
+
+    return length;
+}
+
+int ring_wait(Ring ring) {
+    return ring_wait_timeout(ring, -1);
+}
+
+int ring_wait_timeout(Ring ring, int timeout) {
+    while (!ring_ready(ring)) {
+        atomic_store(&ring->shared->waiting, 1);
+
+        // A producer may have published between the first check and raising the flag.
+        if (ring_ready(ring)) {
+            atomic_store(&ring->shared->waiting, 0);
+            break;
+        }
+
+        // Polled first, so that the wait can time out. Once the doorbell rang, reading it never blocks.
+        struct pollfd doorbell = { .fd = ring->doorbell, .events = POLLIN };
+        int ready = poll(&doorbell, 1, timeout);
+        if (ready > 0) {
+            uint64_t count;
+            if (read(ring->doorbell, &count, sizeof(uint64_t)) == -1 && errno == EINTR) ready = -1;
+        }
+        atomic_store(&ring->shared->waiting, 0);
+
+        if (ready == -1 && errno == EINTR) return -1;
+        if (ready == 0) return ring_ready(ring) ? 0 : 1;
+    }
+
+    return 0;
+}
+
+void close_ring(Ring ring) {
+    atomic_store(&ring->shared->closed, 1);
+}
+
+void destroy_ring(Ring ring) {
+    if (ring == NULL) return;
+
+    munmap(ring->shared, sizeof(RING_SHARED));
+    close(ring->doorbell);
+    free(ring);
+}
@@ -0,0 +1,397 @@
+/******************************************************************************
+ *                              STATUS SNAPSHOT                               *
+ *                                                                            *
+ *   The Status Snapshot is a compact view of the queued, running and         *
+ * recently completed tasks, living in shared memory. It is written only by   *
+ * the operator process, which updates it incrementally as tasks are queued,  *
+ * dispatched and completed, and read by the main server to answer status     *
+ * requests without a round-trip to the operator or its workers.              *
+ *   Updates are published through a sequence lock: the sequence number is    *
+ * odd while an update is in progress, and readers copy the snapshot and      *
+ * retry if the sequence number changed meanwhile. The operator never waits   *
+ * for readers.                                                               *
+ *   Only a bounded number of tasks is listed in each section. Queued and     *
+ * running tasks beyond that are counted, but not listed.                     *
+ *   The time every dispatched task waited in the backlog is kept in a        *
+ * log-linear histogram, from which the wait time percentiles of the          *
+ * escalation policy are reported.                                            *
+ *   The size of the worker pool, and how often it grew and shrank, is kept   *
+ * along with the tasks, and so is the adaptive concurrency limit, with the   *
+ * CPU load it was last adjusted from.                                        *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <sys/mman.h>
+#include <sched.h>
+#include "server/snapshot.h"
+#include "common/io/io.h"
+#include "common/util/alloc.h"
+#include "common/util/string.h"
+
+/**
+ * @brief The number of bits of a wait time, after its most significant one, that select its bucket.
+ */
+#define SNAPSHOT_WAIT_SUB_BITS __builtin_ctz(SNAPSHOT_WAIT_SUB_BUCKETS)
+
+Snapshot create_snapshot(const char* policy) {
+    #define ERR NULL
+    Snapshot snapshot = SAFE_ALLOC(Snapshot, sizeof(SNAPSHOT));
+
+    // The memfd is only needed to back the mapping. It can be closed as soon as it is mapped.
+    int memfd = memfd_create("orchestrator-snapshot", MFD_CLOEXEC);
+    if (memfd == -1) {
+        perror(ERROR_STR_HEADER "Unable to create snapshot memory");
+        free(snapshot);
+        return ERR;
+    }
+
+    // The new memory is zeroed, which leaves every entry free.
+    if (ftruncate(memfd, sizeof(SNAPSHOT_SHARED)) == -1) {
+        perror(ERROR_STR_HEADER "Unable to size snapshot memory");
+        close(memfd);
+        free(snapshot);
+        return ERR;
+    }
+
+    snapshot->shared = mmap(NULL, sizeof(SNAPSHOT_SHARED), PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    close(memfd);
+    if (snapshot->shared == MAP_FAILED) {
+        perror(ERROR_STR_HEADER "Unable to map snapshot memory");
+        free(snapshot);
+        return ERR;
+    }
+
+    for (int i = 0; i < SNAPSHOT_MAX_QUEUED; i++) {
+        snapshot->free_queued[i] = SNAPSHOT_MAX_QUEUED - 1 - i;
+    }
+    snapshot->num_free_queued = SNAPSHOT_MAX_QUEUED;
+
+    for (int i = 0; i < SNAPSHOT_MAX_RUNNING; i++) {
+        snapshot->free_running[i] = SNAPSHOT_MAX_RUNNING - 1 - i;
+    }
+    snapshot->num_free_running = SNAPSHOT_MAX_RUNNING;
+
+    strncpy(snapshot->shared->policy, policy, SNAPSHOT_POLICY_LEN);
+
+    return snapshot;
+    #undef ERR
+}
+
+#pragma region ======= WRITER =======
+/**
+ * @brief Marks the start of an update, making readers retry until it ends.
+ */
+static inline void snapshot_write_begin(SnapshotShared shared) {
+    uint64_t sequence = atomic_load_explicit(&shared->sequence, memory_order_relaxed);
+    atomic_store_explicit(&shared->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief Marks the end of an update, publishing it to readers.
+ */
+static inline void snapshot_write_end(SnapshotShared shared) {
+    uint64_t sequence = atomic_load_explicit(&shared->sequence, memory_order_relaxed);
+    atomic_store_explicit(&shared->sequence, sequence + 1, memory_order_release);
+}
+
+/**
+ * @brief Fills an entry with a task.
+ */
+static inline void set_snapshot_task(SnapshotTask task, int task_id, uint32_t time, const char* command, size_t len) {
+    if (len > SNAPSHOT_COMMAND_LEN) len = SNAPSHOT_COMMAND_LEN;
+
+    task->task_id = task_id;
+    task->time = time;
+    memcpy(task->command, command, len);
+    task->command[len] = '\0';
+}
+
+int snapshot_enqueue(Snapshot snapshot, int task_id, const char* command, size_t command_len) {
+    SnapshotShared shared = snapshot->shared;
+    int entry = (snapshot->num_free_queued > 0) ? snapshot->free_queued[--snapshot->num_free_queued] : -1;
+
+    snapshot_write_begin(shared);
+    shared->num_queued++;
+    if (entry != -1) set_snapshot_task(&shared->queued[entry], task_id, 0, command, command_len);
+    snapshot_write_end(shared);
+
+    return entry;
+}
+
+int snapshot_dispatch(Snapshot snapshot, int entry, int task_id, const char* command, size_t command_len) {
+    SnapshotShared shared = snapshot->shared;
+    int running = (snapshot->num_free_running > 0) ? snapshot->free_running[--snapshot->num_free_running] : -1;
+
+    snapshot_write_begin(shared);
+    if (shared->num_queued > 0) shared->num_queued--;
+    if (entry != -1) shared->queued[entry].task_id = 0;
+
+    shared->num_running++;
+    if (running != -1) set_snapshot_task(&shared->running[running], task_id, 0, command, command_len);
+    snapshot_write_end(shared);
+
+    if (entry != -1) snapshot->free_queued[snapshot->num_free_queued++] = entry;
+
+    return running;
+}
+
+void snapshot_cancel(Snapshot snapshot, int entry) {
+    SnapshotShared shared = snapshot->shared;
+
+    snapshot_write_begin(shared);
+    if (shared->num_queued > 0) shared->num_queued--;
+    if (entry != -1) shared->queued[entry].task_id = 0;
+    snapshot_write_end(shared);
+
+    if (entry != -1) snapshot->free_queued[snapshot->num_free_queued++] = entry;
+}
+
+void snapshot_complete(Snapshot snapshot, int entry, int task_id, const char* command, size_t command_len, uint32_t time) {
+    SnapshotShared shared = snapshot->shared;
+
+    snapshot_write_begin(shared);
+    if (shared->num_running > 0) shared->num_running--;
+    if (entry != -1) shared->running[entry].task_id = 0;
+
+    SnapshotTask completed = &shared->completed[shared->num_completed % SNAPSHOT_MAX_COMPLETED];
+    set_snapshot_task(completed, task_id, time, command, command_len);
+    shared->num_completed++;
+    snapshot_write_end(shared);
+
+    if (entry != -1) snapshot->free_running[snapshot->num_free_running++] = entry;
+}
+/**
+ * @brief Returns the histogram bucket of a wait time.
+ */
+static inline int get_wait_bucket(uint32_t wait) {
+    if (wait < SNAPSHOT_WAIT_SUB_BUCKETS) return wait;
+
+    int shift = (31 - __builtin_clz(wait)) - SNAPSHOT_WAIT_SUB_BITS;
+    return SNAPSHOT_WAIT_SUB_BUCKETS * (shift + 1) + ((wait >> shift) & (SNAPSHOT_WAIT_SUB_BUCKETS - 1));
+}
+
+void snapshot_record_wait(Snapshot snapshot, uint32_t wait) {
+    SnapshotShared shared = snapshot->shared;
+
+    snapshot_write_begin(shared);
+    shared->wait_buckets[get_wait_bucket(wait)]++;
+    shared->num_waits++;
+    if (wait > shared->max_wait) shared->max_wait = wait;
+    snapshot_write_end(shared);
+}
+
+void snapshot_set_pool(Snapshot snapshot, uint32_t num_workers, uint32_t min_workers, uint32_t max_workers) {
+    SnapshotShared shared = snapshot->shared;
+
+    snapshot_write_begin(shared);
+    if (num_workers > shared->num_workers) shared->num_started += num_workers - shared->num_workers;
+    if (num_workers < shared->num_workers) shared->num_retired += shared->num_workers - num_workers;
+    shared->num_workers = num_workers;
+    shared->min_workers = min_workers;
+    shared->max_workers = max_workers;
+    snapshot_write_end(shared);
+}
+
+void snapshot_set_concurrency(
+    Snapshot snapshot, 
+    uint32_t limit, 
+    uint32_t min_limit, 
+    double cpu_busy, 
+    double cpu_pressure, 
+    double task_cpu
+) {
+    SnapshotShared shared = snapshot->shared;
+
+    snapshot_write_begin(shared);
+    shared->concurrency_limit = limit;
+    shared->min_concurrency = min_limit;
+    shared->cpu_busy = cpu_busy;
+    shared->cpu_pressure = cpu_pressure;
+    shared->task_cpu = task_cpu;
+    snapshot_write_end(shared);
+}
+#pragma endregion
+
+#pragma region ======= READER =======
+void read_snapshot(Snapshot snapshot, SnapshotShared copy) {
+    SnapshotShared shared = snapshot->shared;
+
+    for (;;) {
+        uint64_t before = atomic_load_explicit(&shared->sequence, memory_order_acquire);
+        if (before & 1) {
+            // An update is in progress. They are short, so just let the operator finish it.
+            sched_yield();
+            continue;
+        }
+
+        memcpy(copy, shared, sizeof(SNAPSHOT_SHARED));
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&shared->sequence, memory_order_relaxed) == before) return;
+    }
+}
+
+/**
+ * @brief Returns the largest wait time that falls in a histogram bucket.
+ */
+static inline uint64_t get_wait_bucket_upper_bound(int bucket) {
+    if (bucket < SNAPSHOT_WAIT_SUB_BUCKETS) return bucket;
+
+    int shift = bucket / SNAPSHOT_WAIT_SUB_BUCKETS - 1;
+    uint64_t lower = (uint64_t)(SNAPSHOT_WAIT_SUB_BUCKETS + bucket % SNAPSHOT_WAIT_SUB_BUCKETS) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+uint32_t get_snapshot_wait_percentile(SnapshotShared copy, double percentile) {
+    if (copy->num_waits == 0) return 0;
+
+    // The rank of the percentile, counting from 1.
+    uint64_t rank = (uint64_t)(percentile / 100.0 * copy->num_waits + 0.999999);
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < SNAPSHOT_WAIT_BUCKETS; i++) {
+        seen += copy->wait_buckets[i];
+        if (seen < rank) continue;
+
+        // The bucket may extend past the longest wait, which is known exactly.
+        uint64_t bound = get_wait_bucket_upper_bound(i);
+        return (bound < copy->max_wait) ? bound : copy->max_wait;
+    }
+
+    return copy->max_wait;
+}
+
+/**
+ * @brief Orders listed tasks by id, which is the order they were queued in.
+ */
+static int compare_snapshot_tasks(const void* a, const void* b) {
+    return (*(SnapshotTask*)a)->task_id - (*(SnapshotTask*)b)->task_id;
+}
+
+char* snapshot_to_string(SnapshotShared copy, uint8_t sections, uint32_t completed_limit, size_t* len) {
+    #define ERR NULL
+    if (sections == 0) sections = STATUS_SECTION_ALL;
+
+    StringBuilder sb = create_string_builder(4096);
+    if (sb == NULL) return ERR;
+
+    int failed = 0;
+    int separate = 0;
+
+    if (sections & STATUS_SECTION_QUEUED) {
+        SnapshotTask queued[SNAPSHOT_MAX_QUEUED];
+        int num_listed = 0;
+        for (int i = 0; i < SNAPSHOT_MAX_QUEUED; i++) {
+            if (copy->queued[i].task_id != 0) queued[num_listed++] = &copy->queued[i];
+        }
+        qsort(queued, num_listed, sizeof(SnapshotTask), compare_snapshot_tasks);
+
+        failed |= string_builder_append(sb, "Scheduled tasks (%u):\n", copy->num_queued);
+        for (int i = 0; i < num_listed; i++) {
+            failed |= string_builder_append(sb, "%d %s\n", queued[i]->task_id, queued[i]->command);
+        }
+        if (copy->num_queued > (uint32_t)num_listed) {
+            failed |= string_builder_append(sb, "... and %u more.\n", copy->num_queued - num_listed);
+        }
+        separate = 1;
+    }
+
+    if (sections & STATUS_SECTION_RUNNING) {
+        SnapshotTask running[SNAPSHOT_MAX_RUNNING];
+        int num_listed = 0;
+        for (int i = 0; i < SNAPSHOT_MAX_RUNNING; i++) {
+            if (copy->running[i].task_id != 0) running[num_listed++] = &copy->running[i];
+        }
+        qsort(running, num_listed, sizeof(SnapshotTask), compare_snapshot_tasks);
+
+        failed |= string_builder_append(sb, "%sExecuting tasks (%u):\n", separate ? "\n" : "", copy->num_running);
+        for (int i = 0; i < num_listed; i++) {
+            failed |= string_builder_append(sb, "%d %s\n", running[i]->task_id, running[i]->command);
+        }
+        if (copy->num_running > (uint32_t)num_listed) {
+            failed |= string_builder_append(sb, "... and %u more.\n", copy->num_running - num_listed);
+        }
+        separate = 1;
+    }
+
+    if (sections & STATUS_SECTION_COMPLETED) {
+        failed |= string_builder_append(sb, "%sCompleted tasks (%lu):\n", separate ? "\n" : "", copy->num_completed);
+
+        uint64_t listed = (copy->num_completed > SNAPSHOT_MAX_COMPLETED) ? SNAPSHOT_MAX_COMPLETED : copy->num_completed;
+        if (completed_limit > 0 && completed_limit < listed) listed = completed_limit;
+
+        for (uint64_t i = copy->num_completed - listed; i < copy->num_completed; i++) {
+            SnapshotTask task = &copy->completed[i % SNAPSHOT_MAX_COMPLETED];
+            if (task->task_id == 0) continue;
+            failed |= string_builder_append(sb, "%d %s %ums\n", task->task_id, task->command, task->time);
+        }
+        separate = 1;
+    }
+
+    if (sections & STATUS_SECTION_WAIT_TIMES) {
+        failed |= string_builder_append(
+            sb, 
+            "%sWait times (%s, %lu tasks): p50 %ums, p90 %ums, p99 %ums, max %ums\n", 
+            separate ? "\n" : "", 
+            copy->policy, 
+            copy->num_waits, 
+            get_snapshot_wait_percentile(copy, 50), 
+            get_snapshot_wait_percentile(copy, 90), 
+            get_snapshot_wait_percentile(copy, 99), 
+            copy->max_wait
+        );
+        separate = 1;
+    }
+
+    if (sections & STATUS_SECTION_WORKERS) {
+        failed |= string_builder_append(
+            sb, 
+            "%sWorkers (%u of %u-%u): %lu started, %lu retired\n", 
+            separate ? "\n" : "", 
+            copy->num_workers, 
+            copy->min_workers, 
+            copy->max_workers, 
+            copy->num_started, 
+            copy->num_retired
+        );
+
+        // A fixed limit is simply the size of the pool.
+        if (copy->min_concurrency != 0) {
+            failed |= string_builder_append(
+                sb, 
+                "Concurrency limit %u (%u-%u): CPUs %.0f%% busy", 
+                copy->concurrency_limit, 
+                copy->min_concurrency, 
+                copy->max_workers, 
+                100 * copy->cpu_busy
+            );
+            if (copy->cpu_pressure >= 0) {
+                failed |= string_builder_append(sb, ", %.0f%% stalled", 100 * copy->cpu_pressure);
+            }
+            if (copy->task_cpu >= 0) {
+                failed |= string_builder_append(sb, ", tasks use %.0f%% of a CPU", 100 * copy->task_cpu);
+            }
+            failed |= string_builder_append(sb, "\n");
+        }
+    }
+
+    char* str = finish_string_builder(sb, len);
+    if (failed) {
+        free(str);
+        return ERR;
+    }
+
+    return str;
+    #undef ERR
+}
+#pragma endregion
+
+void destroy_snapshot(Snapshot snapshot) {
+    if (snapshot == NULL) return;
+
+    munmap(snapshot->shared, sizeof(SNAPSHOT_SHARED));
+    free(snapshot);
+}
@@ -0,0 +1,193 @@
+/******************************************************************************
+ *                               CPU TOPOLOGY                                 *
+ *                                                                            *
+ *   The CPU Topology module places the operator and its workers on the CPUs  *
+ * the server may run on, as read from /sys/devices/system/cpu, so that they  *
+ * stop migrating between CPUs and sockets.                                   *
+ *   The CPUs are ordered so that those sharing a socket, a last level cache  *
+ * and a core end up next to each other, and are grouped into cores. The      *
+ * first core is kept for the operator, as housekeeping, and the others are   *
+ * split between the workers in that order, so that the cores of a worker     *
+ * share their caches. A worker and every process it spawns stay on its       *
+ * cores, and the stages of a pipeline are spread over them, so that stages   *
+ * feeding each other run side by side on CPUs that share a cache.            *
+ *   With more workers than cores, neighbouring workers share a core.         *
+ ******************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include "server/topology.h"
+#include "common/util/string.h"
+
+/**
+ * @brief The most cache levels looked at for the last level cache of a CPU.
+ */
+#define CPU_TOPOLOGY_MAX_CACHES 8
+
+/**
+ * @brief Orders CPUs by socket, then last level cache, then core, so that CPUs sharing more end up closer.
+ */
+static int compare_cpu_topology_entries(const void* a, const void* b) {
+    CpuTopologyEntry cpu_a = (CpuTopologyEntry)a;
+    CpuTopologyEntry cpu_b = (CpuTopologyEntry)b;
+
+    if (cpu_a->package != cpu_b->package) return cpu_a->package - cpu_b->package;
+    if (cpu_a->cache != cpu_b->cache) return cpu_a->cache - cpu_b->cache;
+    if (cpu_a->core != cpu_b->core) return cpu_a->core - cpu_b->core;
+    return cpu_a->cpu - cpu_b->cpu;
+}
+
+/**
+ * @brief Copies a range of CPUs into a list.
+ *
+ * @return 0 on success, 1 if it fails.
+ */
+static int set_cpu_list(CpuList list, CpuTopologyEntry cpus, int first, int len) {
+    list->cpus = malloc(len * sizeof(int));
+    if (list->cpus == NULL) return 1;
+
+    for (int i = 0; i < len; i++) list->cpus[i] = cpus[first + i].cpu;
+    list->len = len;
+
+    return 0;
+}
+
+CpuPlacement plan_cpu_placement(CpuTopologyEntry cpus, int num_cpus, int num_workers) {
+    #define ERR NULL
+    if (num_cpus <= 0 || num_workers <= 0) return ERR;
+
+    CpuPlacement placement = calloc(1, sizeof(CPU_PLACEMENT));
+    int* cores = malloc((num_cpus + 1) * sizeof(int));
+    if (placement == NULL || cores == NULL) goto err;
+
+    placement->workers = calloc(num_workers, sizeof(CPU_LIST));
+    if (placement->workers == NULL) goto err;
+    placement->num_workers = num_workers;
+
+    qsort(cpus, num_cpus, sizeof(CPU_TOPOLOGY_ENTRY), compare_cpu_topology_entries);
+
+    // The first CPU of every core, and one past the last CPU.
+    int num_cores = 0;
+    for (int i = 0; i < num_cpus; i++) {
+        if (i == 0 || cpus[i].package != cpus[i - 1].package || cpus[i].core != cpus[i - 1].core) {
+            cores[num_cores++] = i;
+        }
+    }
+    cores[num_cores] = num_cpus;
+
+    // A single core is shared by everyone.
+    int first_worker_core = (num_cores > 1) ? 1 : 0;
+    if (set_cpu_list(&placement->housekeeping, cpus, 0, cores[1]) != 0) goto err;
+
+    int num_worker_cores = num_cores - first_worker_core;
+    for (int i = 0; i < num_workers; i++) {
+        int first = first_worker_core + (int)((long)i * num_worker_cores / num_workers);
+        int last = first_worker_core + (int)((long)(i + 1) * num_worker_cores / num_workers);
+        if (last == first) last = first + 1;
+
+        if (set_cpu_list(&placement->workers[i], cpus, cores[first], cores[last] - cores[first]) != 0) goto err;
+    }
+
+    free(cores);
+    return placement;
+
+    err: {
+        free(cores);
+        destroy_cpu_placement(placement);
+        return ERR;
+    }
+    #undef ERR
+}
+
+/**
+ * @brief Reads the number at the start of a file, or returns a fallback if it can not be read.
+ */
+static int read_cpu_topology_value(const char* path, int fallback) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return fallback;
+
+    int value;
+    if (fscanf(file, "%d", &value) != 1) value = fallback;
+    fclose(file);
+
+    return value;
+}
+
+/**
+ * @brief Reads the topology of a CPU. Anything missing is left as if the CPU had a core and cache of its own.
+ */
+static void read_cpu_topology_entry(int cpu, CpuTopologyEntry entry) {
+    entry->cpu = cpu;
+
+    char* path = isnprintf(CPU_TOPOLOGY_PATH "/cpu%d/topology/physical_package_id", cpu);
+    entry->package = read_cpu_topology_value(path, 0);
+    free(path);
+
+    path = isnprintf(CPU_TOPOLOGY_PATH "/cpu%d/topology/core_id", cpu);
+    entry->core = read_cpu_topology_value(path, cpu);
+    free(path);
+
+    // The list of CPUs sharing a cache starts with the lowest numbered one, which names the cache.
+    entry->cache = cpu;
+    int last_level = 0;
+    for (int i = 0; i < CPU_TOPOLOGY_MAX_CACHES; i++) {
+        path = isnprintf(CPU_TOPOLOGY_PATH "/cpu%d/cache/index%d/level", cpu, i);
+        int level = read_cpu_topology_value(path, -1);
+        free(path);
+        if (level == -1) break;
+        if (level <= last_level) continue;
+
+        path = isnprintf(CPU_TOPOLOGY_PATH "/cpu%d/cache/index%d/shared_cpu_list", cpu, i);
+        entry->cache = read_cpu_topology_value(path, cpu);
+        free(path);
+        last_level = level;
+    }
+}
+
+CpuPlacement create_cpu_placement(int num_workers) {
+    #define ERR NULL
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == -1) return ERR;
+
+    int num_cpus = CPU_COUNT(&allowed);
+    CpuTopologyEntry cpus = malloc(num_cpus * sizeof(CPU_TOPOLOGY_ENTRY));
+    if (cpus == NULL) return ERR;
+
+    int len = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE && len < num_cpus; cpu++) {
+        if (CPU_ISSET(cpu, &allowed)) read_cpu_topology_entry(cpu, &cpus[len++]);
+    }
+
+    CpuPlacement placement = plan_cpu_placement(cpus, len, num_workers);
+    free(cpus);
+
+    return placement;
+    #undef ERR
+}
+
+int pin_to_cpus(CpuList cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int i = 0; i < cpus->len; i++) CPU_SET(cpus->cpus[i], &set);
+
+    return sched_setaffinity(0, sizeof(cpu_set_t), &set) == -1;
+}
+
+int get_pipeline_stage_cpu(CpuList worker, int stage, int num_stages) {
+    if (num_stages < 2 || worker->len < num_stages) return -1;
+    return worker->cpus[stage];
+}
+
+void destroy_cpu_placement(CpuPlacement placement) {
+    if (placement == NULL) return;
+
+    if (placement->workers != NULL) {
+        for (int i = 0; i < placement->num_workers; i++) free(placement->workers[i].cpus);
+    }
+    free(placement->workers);
+    free(placement->housekeeping.cpus);
+    free(placement);
+}
@@ -7,13 +7,22 @@
  * upon which the operator process shall distribute tasks as they arrive.     *
  *   The amount of worker processes to be created depends on the server input *
  * parallel_tasks.                                                            *
+ *   Every task runs in a process group of its own, which the operator may    *
+ * suspend to lend the slot of the worker to a more urgent task, and resume   *
+ * later. A task given a timeout is killed once it runs past it, not counting *
+ * the time it spent suspended: SIGTERM first, then SIGKILL after a grace     *
+ * period, so that a hung task frees its worker within its timeout and that   *
+ * period.                                                                    *
+ *   Each stage of a task is a single process, spawned straight from the      *
+ * worker with its pipes and output already in place, without a copy of the   *
+ * worker in between. A task exits with the status of its last stage, as in a *
+ * shell, which decides whether the tasks depending on it may run.            *
  ******************************************************************************/
  
-#define _XOPEN_SOURCE 500
+#define _GNU_SOURCE
 
 #include "server/worker.h"
 #include "server/worker_datagrams.h"
-#include "server/process_mark.h"
 #include "common/util/alloc.h"
 #include "common/util/string.h"
 #include "common/util/parser.h"
@@ -21,19 +30,29 @@
 #include "common/error.h"
 #include "common/io/fifo.h"
 #include "common/io/io.h"
+#include "common/io/buffer.h"
 #include "common/util/string.h"
 #include <stdio.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <unistd.h>
+#include <spawn.h>
 #include <signal.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
 
 #define LOG_HEADER "[WORKER] "
 #define LOG_HEADER_PID "[WORKER@%d] "
 #define READ 0
 #define WRITE 1
 
+extern char** environ;
+
 void worker_signal_sigsegv(int signum) {
     if (signum != SIGSEGV) return;
 
@@ -43,91 +62,260 @@ void worker_signal_sigsegv(int signum) {
     _exit(1);
 }
 
-int run_task(char* input, char* output_file) {
-    int pid = getpid();
-    DEBUG_PRINT(LOG_HEADER_PID "Running command '%s'\n                 - Outputting to %s\n", pid, input, output_file);
-
-    Tokens cmds = tokenize_char_delim(input, 16, "|");
-    pid_t pids[cmds->len];
+// The process group of the running task, or 0 between tasks, for the preemption signal handler.
+static volatile sig_atomic_t task_pgid = 0;
+// Whether the running task is suspended, and whether it was at any point since its timeout was last checked.
+static volatile sig_atomic_t task_suspended = 0;
+static volatile sig_atomic_t task_was_suspended = 0;
+
+static void worker_signal_preempt(int signum) {
+    // Between tasks, there is nothing to suspend, and the next task must not be charged for it.
+    if (task_pgid == 0) return;
+
+    if (signum == WORKER_SIGNAL_SUSPEND) {
+        task_suspended = 1;
+        task_was_suspended = 1;
+        kill(-task_pgid, SIGSTOP);
+    } else if (signum == WORKER_SIGNAL_RESUME) {
+        task_suspended = 0;
+        kill(-task_pgid, SIGCONT);
+    }
+}
 
-    // Backup STDOUT and STDERR
-    int old_stdout = dup(STDOUT_FILENO);
-    int old_stderr = dup(STDERR_FILENO);
+/**
+ * @brief Returns the CPU time in a resource usage, user and system, in milliseconds.
+ */
+static inline uint64_t get_cpu_time_ms(struct rusage* usage) {
+    return (uint64_t)(usage->ru_utime.tv_sec + usage->ru_stime.tv_sec) * 1000 
+        + (usage->ru_utime.tv_usec + usage->ru_stime.tv_usec) / 1000;
+}
 
-    // Create and open the output file
-    int task_fd = SAFE_OPEN(output_file, O_WRONLY | O_CREAT, 0644);
+/**
+ * @brief Returns the time on a clock that never jumps, in milliseconds.
+ */
+static inline int64_t get_monotonic_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
 
-    // Redirect STDOUT and STDERR to output file.
-    dup2(task_fd, STDOUT_FILENO);
-    dup2(task_fd, STDERR_FILENO);
+/**
+ * @brief Opens a file descriptor that becomes readable once a process exits, or returns -1 if it is not supported.
+ */
+static int open_pidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    return -1;
+#endif
+}
 
-    int pfds[cmds->len][2];
-    for (int i = 0; i < cmds->len; i++) {
-        char* tcmd = trim(cmds->data[i]);
+/**
+ * @brief Waits for every stage of a pipeline, summing the CPU time they used. Once the pipeline runs past its timeout,
+ * its process group is sent SIGTERM, and SIGKILL if it is still running TASK_KILL_GRACE later.
+ *
+ * @param pids        The stages of the pipeline, or 0 for stages that could not be started. Each is set to 0 once
+ *                    reaped.
+ * @param num_stages  The number of stages.
+ * @param pgid        The process group of the pipeline.
+ * @param timeout     The longest the pipeline may run for, in milliseconds, or 0 to wait for as long as it takes.
+ * @param cpu_ms      Incremented by the CPU time the stages used, in milliseconds.
+ * @param exit_status Set to the exit status of the last stage, if it was started.
+ *
+ * @return 1 if the pipeline was killed, 0 otherwise.
+ */
+static int wait_pipeline(pid_t* pids, int num_stages, pid_t pgid, uint32_t timeout, uint64_t* cpu_ms, int* exit_status) {
+    int pidfds[num_stages];
+    int remaining = 0;
+    for (int i = 0; i < num_stages; i++) {
+        pidfds[i] = (timeout != 0 && pids[i] != 0) ? open_pidfd(pids[i]) : -1;
+        remaining += (pids[i] != 0);
+    }
 
-        int pfd[2];
-        if (i != cmds->len - 1) {
-            if (pipe(pfd) != 0) {
-                perror("pipe");
-                return 1;
-            }
+    int signals_sent = 0;
+    int64_t last_ms = get_monotonic_ms();
+    int64_t deadline = last_ms + timeout;
+    while (remaining > 0) {
+        // Without a timeout, or once the pipeline was sent SIGKILL, its stages are simply waited for.
+        int blocking = (timeout == 0 || signals_sent == 2);
 
-            pfds[i][0] = pfd[0];
-            pfds[i][1] = pfd[1];
-        }
+        for (int i = 0; i < num_stages; i++) {
+            if (pids[i] == 0) continue;
 
-        int pid = fork();
-        if (pid == 0) {
-            if (i == 0) {
-                close(pfd[0]);
+            int status = 0;
+            struct rusage usage;
+            pid_t reaped = wait4(pids[i], &status, blocking ? 0 : WNOHANG, &usage);
+            if (reaped == 0 || (reaped == -1 && errno == EINTR)) continue;
+            if (reaped > 0) *cpu_ms += get_cpu_time_ms(&usage);
 
-                dup2(pfd[1], STDOUT_FILENO);
-                close(pfd[1]);
-            } else if (i == cmds->len - 1) {
-                dup2(pfds[i - 1][0], STDIN_FILENO);
-                close(pfds[i - 1][0]);
-            } else {
-                close(pfds[i][0]);
+            // Like shells, a pipeline exits with the status of its last stage.
+            if (reaped > 0 && i == num_stages - 1) *exit_status = get_exit_status(status);
 
-                dup2(pfds[i - 1][0], STDIN_FILENO);
-                dup2(pfds[i][1], STDOUT_FILENO);
-                close(pfds[i - 1][0]);
-                close(pfds[i][1]);
-            }
+            if (pidfds[i] != -1) close(pidfds[i]);
+            pids[i] = 0;
+            remaining--;
+        }
+        if (remaining == 0 || blocking) continue;
+
+        // Time spent suspended does not count towards the timeout.
+        int64_t now = get_monotonic_ms();
+        if (task_suspended || task_was_suspended) deadline += now - last_ms;
+        task_was_suspended = task_suspended;
+        last_ms = now;
+
+        if (now >= deadline) {
+            kill(-pgid, (signals_sent == 0) ? SIGTERM : SIGKILL);
+            signals_sent++;
+            deadline = now + TASK_KILL_GRACE;
+            continue;
+        }
 
-            mysystem(tcmd);
-            _exit(0);
-        } else {
-            pids[i] = pid;
+        // Stages that can not be watched through a pidfd are polled for instead.
+        struct pollfd watched[num_stages];
+        int num_watched = 0;
+        int64_t wait_ms = deadline - now;
+        for (int i = 0; i < num_stages; i++) {
+            if (pids[i] == 0) continue;
 
-            if (i == 0) {
-                close(pfd[1]);
-            } else if (i == cmds->len - 1) {
-                close(pfds[i - 1][0]);
+            if (pidfds[i] == -1) {
+                if (wait_ms > TASK_POLL_INTERVAL) wait_ms = TASK_POLL_INTERVAL;
             } else {
-                close(pfds[i - 1][0]);
-                close(pfds[i][1]);
+                watched[num_watched++] = (struct pollfd){ .fd = pidfds[i], .events = POLLIN };
             }
         }
+        poll(watched, num_watched, (wait_ms < INT32_MAX) ? (int)wait_ms : INT32_MAX);
+    }
+
+    // Processes the stages spawned, that ignored SIGTERM, may outlive them.
+    if (signals_sent != 0) kill(-pgid, SIGKILL);
+
+    return signals_sent != 0;
+}
+
+/**
+ * @brief Starts a single stage of a pipeline in a process of its own, with its standard streams already in place.
+ *
+ * @param command The command of the stage.
+ * @param actions The file actions that set up the standard streams of the stage.
+ * @param attr    The attributes of the stage, with its process group and signal mask.
+ * @param output  The file the errors of the stage are reported to.
+ *
+ * @return The pid of the stage, or 0 if it could not be started.
+ */
+static pid_t spawn_pipeline_stage(
+    const char* command, 
+    posix_spawn_file_actions_t* actions, 
+    posix_spawnattr_t* attr, 
+    int output
+) {
+    char** args = parse_command_args(command);
+    if (args == NULL || args[0] == NULL) {
+        dprintf(output, "Unable to execute an empty command.\n");
+        destroy_command_args(args);
+        return 0;
+    }
+
+    pid_t pid = 0;
+    int err = posix_spawnp(&pid, args[0], actions, attr, args, environ);
+    if (err != 0) {
+        dprintf(output, "Unable to execute command '%s': %s\n", args[0], strerror(err));
+        pid = 0;
     }
 
+    destroy_command_args(args);
+    return pid;
+}
+
+int run_task(char* input, char* output_file, uint32_t timeout, uint32_t* cpu_time, uint8_t* timed_out, CpuList cpus) {
+    int pid = getpid();
+    DEBUG_PRINT(LOG_HEADER_PID "Running command '%s'\n                 - Outputting to %s\n", pid, input, output_file);
+
+    // The terminator is counted, so that an empty task is never read past its bounds.
+    Tokens cmds = tokenize_char_delim(input, strlen(input) + 1, "|");
+    pid_t pids[cmds->len];
+
+    // The output file and the pipes are opened close-on-exec, so that stages only get the ends duplicated onto their
+    // standard streams, and a stage never holds the write end of a pipe it reads from.
+    int task_fd = SAFE_OPEN(output_file, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+
+    // The pipeline may only be suspended once every stage joined its process group.
+    sigset_t preempt_signals, old_mask;
+    sigemptyset(&preempt_signals);
+    sigaddset(&preempt_signals, WORKER_SIGNAL_SUSPEND);
+    sigaddset(&preempt_signals, WORKER_SIGNAL_RESUME);
+    sigprocmask(SIG_BLOCK, &preempt_signals, &old_mask);
+
+    // The whole pipeline, and every process it spawns, shares a process group, so that it can be suspended and killed
+    // at once. Stages are started straight from the worker, without a copy of it in between, and the signals blocked
+    // here are unblocked in them.
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK);
+    posix_spawnattr_setsigmask(&attr, &old_mask);
+
+    pid_t pgid = 0;
+    int stage_in = -1;
+    int pinned = 0;
     for (int i = 0; i < cmds->len; i++) {
-        int status = 0;
-        waitpid(pids[i], &status, 0);
+        // A single command has no pipe.
+        int pfd[2] = { -1, -1 };
+        if (i != cmds->len - 1 && pipe2(pfd, O_CLOEXEC) != 0) {
+            dprintf(task_fd, "Unable to create pipe: %s\n", strerror(errno));
+        }
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, (pfd[WRITE] != -1) ? pfd[WRITE] : task_fd, STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, task_fd, STDERR_FILENO);
+        if (stage_in != -1) posix_spawn_file_actions_adddup2(&actions, stage_in, STDIN_FILENO);
+
+        // The first stage to start leads the process group.
+        posix_spawnattr_setpgroup(&attr, pgid);
+
+        // Stages feeding each other run side by side, on CPUs that share a cache. Spawned processes inherit the CPUs of
+        // the worker, which are restored once every stage started.
+        int cpu = (cpus != NULL) ? get_pipeline_stage_cpu(cpus, i, cmds->len) : -1;
+        if (cpu != -1) pinned = (pin_to_cpus(&(CPU_LIST){ .cpus = &cpu, .len = 1 }) == 0) || pinned;
+
+        pids[i] = spawn_pipeline_stage(cmds->data[i], &actions, &attr, task_fd);
+        if (pids[i] != 0 && pgid == 0) pgid = pids[i];
+
+        posix_spawn_file_actions_destroy(&actions);
+
+        // Stages that failed to start leave the next one reading an empty input.
+        if (stage_in != -1) close(stage_in);
+        if (pfd[WRITE] != -1) close(pfd[WRITE]);
+        stage_in = pfd[READ];
     }
+    if (stage_in != -1) close(stage_in);
+    if (pinned) pin_to_cpus(cpus);
+    posix_spawnattr_destroy(&attr);
+
+    // The usage of every process of the pipeline includes the processes it waited for in turn.
+    // A suspension requested while the pipeline started is delivered now. Every task starts running, whatever
+    // happened to the task before it.
+    task_suspended = 0;
+    task_was_suspended = 0;
+    task_pgid = pgid;
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+
+    uint64_t cpu_ms = 0;
+    int exit_status = MYSYSTEM_EXIT_NOT_RUN;
+    *timed_out = wait_pipeline(pids, cmds->len, pgid, timeout, &cpu_ms, &exit_status);
+    task_pgid = 0;
+    *cpu_time = (cpu_ms < UINT32_MAX) ? (uint32_t)cpu_ms : UINT32_MAX;
+
+    if (*timed_out) dprintf(task_fd, "Task killed after running past its timeout of %ums.\n", timeout);
     
-    // Close output file and restore STDOUT and STDERR
     close(task_fd);
-    dup2(old_stdout, STDOUT_FILENO);
-    dup2(old_stderr, STDERR_FILENO);
-    close(old_stdout);
-    close(old_stderr);
+    destroy_tokens(cmds);
 
-    DEBUG_PRINT(LOG_HEADER_PID "Finished running command '%s'\n", pid, input);
-    return 0;
+    DEBUG_PRINT(LOG_HEADER_PID "Finished running command '%s' with status %d\n", pid, input, exit_status);
+    return exit_status;
 }
 
-Worker start_worker(int operator_pd, int worker_id, char* output_dir, char* history_file_path) {
+Worker start_worker(Ring operator_ring, WorkerClaims claims, int worker_id, char* output_dir, CpuList cpus) {
     #define ERR NULL
     ERROR_HEADER
     int _err_pid = 0;
@@ -145,44 +333,66 @@ Worker start_worker(int operator_pd, int worker_id, char* output_dir, char* hist
 
         volatile sig_atomic_t shutdown_requested = 0;
 
-        MAIN_LOG(LOG_HEADER_PID "Ready.\n", pid);
+        // Every process the worker spawns inherits its CPUs.
+        if (cpus != NULL && pin_to_cpus(cpus) != 0) MAIN_LOG(LOG_HEADER_PID "Unable to pin to its CPUs.\n", pid);
 
-        while (!shutdown_requested) {
-            WORKER_DATAGRAM_HEADER dh = read_worker_datagram_header(pfd[READ]);
+        // The operator suspends the running task to lend the slot of the worker to a more urgent one.
+        struct sigaction preempt = { .sa_handler = worker_signal_preempt, .sa_flags = SA_RESTART };
+        sigemptyset(&preempt.sa_mask);
+        sigaction(WORKER_SIGNAL_SUSPEND, &preempt, NULL);
+        sigaction(WORKER_SIGNAL_RESUME, &preempt, NULL);
 
-            switch (dh.mode) {
-                case WORKER_DATAGRAM_MODE_STATUS_REQUEST: {
-                    WorkerStatusRequestDatagram req = read_partial_worker_status_request_datagram(pfd[READ], dh);
-                    MAIN_LOG(LOG_HEADER_PID "Received status request.\n", pid);
-
-                    int history_fd = SAFE_OPEN(history_file_path, O_RDONLY, 0644);
-
-                    char* res = NULL;
-                    res = strdup("Scheduled tasks:\n");
-                    for(int i = 0 ; i < req->num_tasks_queued ; i++) {
-                        char* _res = res;
-                        res = isnprintf("%s%d %s\n", res, req->tasks[i]->task_id, req->tasks[i]->data);
-                        free(_res);
-                    }
+        // Datagrams are framed by their header, so a single read may deliver several of them.
+        ReadBuffer datagrams = create_read_buffer(WORKER_READ_BUFFER_SIZE);
+        if (datagrams == NULL) _exit(1);
 
-                    char* _back = res;
-                    res = isnprintf("%s\nExecuting tasks:\n", res);
-                    free(_back);
-                    for(int i = req->num_tasks_queued ; i < req->num_tasks ; i++) {
-                        char* _res = res;
-                        res = isnprintf("%s%d %s\n", res, req->tasks[i]->task_id, req->tasks[i]->data);
-                        free(_res);
-                    }
+        MAIN_LOG(LOG_HEADER_PID "Ready.\n", pid);
 
-                    _back = res;
-                    res = isnprintf("%s\nCompleted tasks:\n", res);
-                    free(_back);
+        while (!shutdown_requested) {
+            ssize_t size = get_worker_datagram_size(READ_BUFFER_HEAD(datagrams), READ_BUFFER_LEN(datagrams));
+            if (size == -1 || (size_t)size > datagrams->cap) {
+                // Only the operator writes to this pipe, so the stream can not be resynchronized.
+                MAIN_LOG(LOG_HEADER_PID "Received malformed datagram. Shutting down.\n", pid);
+                break;
+            }
 
+            if (size == 0 || (size_t)size > READ_BUFFER_LEN(datagrams)) {
+                if (read_once_read_buffer(datagrams, pfd[READ]) <= 0) {
+                    MAIN_LOG(LOG_HEADER_PID "Lost connection to the operator. Shutting down.\n", pid);
                     break;
                 }
+                continue;
+            }
+
+            uint8_t* frame = READ_BUFFER_HEAD(datagrams);
+            WORKER_DATAGRAM_HEADER dh;
+            memcpy(&dh, frame, sizeof(WORKER_DATAGRAM_HEADER));
+
+            switch (dh.mode) {
                 case WORKER_DATAGRAM_MODE_EXECUTE_REQUEST: {
-                    WorkerExecuteRequestDatagram req = read_partial_worker_execute_request_datagram(pfd[READ], dh);
+                    WorkerExecuteRequestDatagram req = unpack_worker_execute_request_datagram(frame, size);
+                    if (req == NULL) {
+                        MAIN_LOG(LOG_HEADER_PID "Received malformed execute request.\n", pid);
+                        break;
+                    }
                     MAIN_LOG(LOG_HEADER_PID "Received execute request.\n", pid);
+
+                    // The operator may have handed a prefetched task to another worker. Report it, so that the
+                    // operator can reuse its claim.
+                    if (!take_worker_claim(claims, worker_id, req->header.task_id)) {
+                        MAIN_LOG(LOG_HEADER_PID "Skipping stolen task %d.\n", pid, req->header.task_id);
+
+                        WorkerCompletionResponseDatagram res = create_worker_completion_response_datagram();
+                        res->header.mode = WORKER_DATAGRAM_MODE_SKIPPED_RESPONSE;
+                        res->header.task_id = req->header.task_id;
+                        res->worker_id = worker_id;
+
+                        struct iovec iov = { .iov_base = res, .iov_len = sizeof(WORKER_COMPLETION_RESPONSE_DATAGRAM) };
+                        ring_write(operator_ring, RING_MESSAGE_WORKER, &iov, 1);
+                        free(res);
+                        free(req);
+                        break;
+                    }
                     DEBUG_PRINT(
                         LOG_HEADER_PID "Mode: %d, Type: %d, Id: %d, Data: '%s'\n", 
                         pid,
@@ -201,7 +411,9 @@ Worker start_worker(int operator_pd, int worker_id, char* output_dir, char* hist
                     char* task_name = isnprintf(TASK "%d", req->header.task_id);
                     char* task_path = join_paths(2, output_dir, task_name);
 
-                    run_task(req->data, task_path);
+                    uint32_t cpu_time = 0;
+                    uint8_t timed_out = 0;
+                    int exit_status = run_task(req->data, task_path, req->timeout, &cpu_time, &timed_out, cpus);
 
                     free(task_path);
                     free(task_name);
@@ -209,25 +421,30 @@ Worker start_worker(int operator_pd, int worker_id, char* output_dir, char* hist
                     WorkerCompletionResponseDatagram res = create_worker_completion_response_datagram();
                     res->header.task_id = req->header.task_id;
                     res->worker_id = worker_id;
-
-                    WRITE_PROCESS_MARK(operator_pd, WORKER_PROCESS_MARK);
-                    SAFE_WRITE(operator_pd, res, sizeof(WORKER_COMPLETION_RESPONSE_DATAGRAM));
+                    res->cpu_time = cpu_time;
+                    res->timed_out = timed_out;
+                    res->exit_status = exit_status;
+
+                    struct iovec iov = { .iov_base = res, .iov_len = sizeof(WORKER_COMPLETION_RESPONSE_DATAGRAM) };
+                    ring_write(operator_ring, RING_MESSAGE_WORKER, &iov, 1);
+                    free(res);
+                    free(req);
                     break;
                 }
                 case WORKER_DATAGRAM_MODE_SHUTDOWN_REQUEST: {
-                    WorkerShutdownRequestDatagram req = read_partial_worker_shutdown_request_datagram(pfd[READ], dh);
-                    UNUSED(req);
-
                     MAIN_LOG(LOG_HEADER_PID "Received shutdown request.\n", pid);
                     shutdown_requested = 1;
                     break;
                 }
             }
+
+            consume_read_buffer(datagrams, size);
         }
 
         // Shutdown worker
         MAIN_LOG(LOG_HEADER_PID "Shutting down...\n", pid);
 
+        destroy_read_buffer(datagrams);
         close(pfd[0]);
         close(pfd[1]);
 
@@ -238,6 +455,10 @@ Worker start_worker(int operator_pd, int worker_id, char* output_dir, char* hist
     close(pfd[0]);
     ret->pid = pid;
     ret->pipe_write = pfd[1];
+
+    // The worker only reads its pipe between tasks, so this is all that may be written to it ahead of time.
+    int pipe_size = fcntl(pfd[1], F_GETPIPE_SZ);
+    ret->pipe_capacity = (pipe_size > 0) ? (size_t)pipe_size : PIPE_BUF;
     
     return ret;
 
@@ -7,12 +7,23 @@ WORKER_DATAGRAM_HEADER create_worker_datagram_header() {
     WORKER_DATAGRAM_HEADER dh = {
         .mode = WORKER_DATAGRAM_MODE_NONE,
         .type = DATAGRAM_TYPE_NONE,
-        .task_id = 0
+        .task_id = 0,
+        .length = sizeof(WORKER_DATAGRAM_HEADER)
     };
 
     return dh;
 }
 
+ssize_t get_worker_datagram_size(const void* buf, size_t len) {
+    if (len < sizeof(WORKER_DATAGRAM_HEADER)) return 0;
+
+    WORKER_DATAGRAM_HEADER header;
+    memcpy(&header, buf, sizeof(WORKER_DATAGRAM_HEADER));
+    if (header.length < sizeof(WORKER_DATAGRAM_HEADER)) return -1;
+
+    return header.length;
+}
+
 WORKER_DATAGRAM_HEADER read_worker_datagram_header(int fd) {
     #define ERR ((WORKER_DATAGRAM_HEADER){ 0 })
     
@@ -25,105 +36,75 @@ WORKER_DATAGRAM_HEADER read_worker_datagram_header(int fd) {
 #pragma endregion
 
 
-#pragma region ======= STATUS REQUEST =======
-WorkerStatusRequestDatagram create_worker_status_request_datagram(int num_clients, int* clients, int num_tasks_queued, int num_tasks, WorkerStatusPayload* tasks) {
+#pragma region ======= EXECUTE REQUEST =======
+WorkerExecuteRequestDatagram create_worker_execute_request_datagram(char* data, uint32_t data_len) {
     #define ERR NULL
 
-    WorkerStatusRequestDatagram dg = SAFE_ALLOC(WorkerStatusRequestDatagram, sizeof(WORKER_STATUS_REQUEST_DATAGRAM));
+    WorkerExecuteRequestDatagram dg = SAFE_ALLOC(
+        WorkerExecuteRequestDatagram, 
+        sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM) + data_len + 1
+    );
     dg->header = create_worker_datagram_header();
-    dg->header.mode = WORKER_DATAGRAM_MODE_STATUS_REQUEST;
+    dg->header.mode = WORKER_DATAGRAM_MODE_EXECUTE_REQUEST;
 
-    dg->num_clients = num_clients;
-    dg->clients = SAFE_ALLOC(int*, sizeof(int) * num_clients);
-    memcpy(dg->clients, clients, sizeof(int) * num_clients);
+    dg->header.length = sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM) + data_len;
 
-    dg->num_tasks_queued = num_tasks_queued;
-    dg->num_tasks = num_tasks;
-    dg->tasks = SAFE_ALLOC(WorkerStatusPayload*, sizeof(WorkerStatusPayload) * num_tasks);
-    memcpy(dg->tasks, tasks, sizeof(WorkerStatusPayload) * num_tasks);
+    dg->data_len = data_len;
+    dg->timeout = 0;
+    memcpy(dg->data, data, data_len);
+    dg->data[data_len] = '\0';
 
     return dg;
 
     #undef ERR
 }
 
-WorkerStatusRequestDatagram read_partial_worker_status_request_datagram(int fd, WORKER_DATAGRAM_HEADER header) {
+
+WorkerExecuteRequestDatagram read_partial_worker_execute_request_datagram(int fd, WORKER_DATAGRAM_HEADER header) {
     #define ERR NULL
     
-    WorkerStatusRequestDatagram dg = SAFE_ALLOC(WorkerStatusRequestDatagram, sizeof(WORKER_STATUS_REQUEST_DATAGRAM));
+    WorkerExecuteRequestDatagram dg = SAFE_ALLOC(WorkerExecuteRequestDatagram, sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM));
     dg->header = header;
 
-    // int offset = sizeof(WORKER_DATAGRAM_HEADER);
-
-    // // Read clients
-    // int num_clients = STRUCT_MEMBER_SIZE(WORKER_STATUS_REQUEST_DATAGRAM, num_clients);
-    // SAFE_READ(fd, (((void*)dg) + offset), num_clients);
-    // offset += num_clients;
-
-    // dg->clients = SAFE_ALLOC(int*, sizeof(int) * num_clients);
-    // SAFE_READ(fd, (((void*)dg) + offset), dg->clients);
-    // offset += sizeof(int) * num_clients;
-
-    // // Read tasks
-    // SAFE_READ(fd, (((void*)dg) + offset), sizeof(int));
-    // offset += sizeof(int);
-
-    // int num_tasks = STRUCT_MEMBER_SIZE(WORKER_STATUS_REQUEST_DATAGRAM, num_tasks);
-    // SAFE_READ(fd, (((void*)dg) + offset), num_tasks);
-    // offset += num_tasks;
-
-    // dg->tasks = SAFE_ALLOC(WorkerStatusPayload*, sizeof(WorkerStatusPayload) * num_tasks);
-    // SAFE_READ(fd, (((void*)dg) + offset), dg->tasks);
-
-    // Read clients
-    SAFE_READ(fd, &(dg->num_clients), STRUCT_MEMBER_SIZE(WORKER_STATUS_REQUEST_DATAGRAM, num_clients));
-
-    dg->clients = SAFE_ALLOC(int*, sizeof(int) * dg->num_clients);
-    SAFE_READ(fd, dg->clients, sizeof(int) * dg->num_clients);
-
-    // Read tasks
-    SAFE_READ(fd, &(dg->num_tasks_queued), STRUCT_MEMBER_SIZE(WORKER_STATUS_REQUEST_DATAGRAM, num_tasks_queued));
-    SAFE_READ(fd, &(dg->num_tasks), STRUCT_MEMBER_SIZE(WORKER_STATUS_REQUEST_DATAGRAM, num_tasks));
-
-    dg->tasks = SAFE_ALLOC(WorkerStatusPayload*, sizeof(WorkerStatusPayload) * dg->num_tasks);
-    SAFE_READ(fd, dg->tasks, sizeof(WorkerStatusPayload) * dg->num_tasks);
-
-    return dg;
-    #undef ERR
-}
-
-
+    // Read the task length, padding included, as that is what the operator writes. Reading any less leaves bytes
+    // behind that are then mistaken for the header of the next datagram.
+    SAFE_READ(
+        fd, 
+        (((void*)dg) + sizeof(WORKER_DATAGRAM_HEADER)), 
+        sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM) - sizeof(WORKER_DATAGRAM_HEADER)
+    );
 
-#pragma endregion
+    if (dg->data_len > EXECUTE_REQUEST_DATAGRAM_MAX_PAYLOAD_LEN) {
+        free(dg);
+        return ERR;
+    }
 
+    SAFE_REALLOC(dg, sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM) + dg->data_len + 1);
+    dg->data[dg->data_len] = '\0';
 
-#pragma region ======= EXECUTE REQUEST =======
-WorkerExecuteRequestDatagram create_worker_execute_request_datagram() {
-    #define ERR NULL
-
-    WorkerExecuteRequestDatagram dg = SAFE_ALLOC(WorkerExecuteRequestDatagram, sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM));
-    dg->header = create_worker_datagram_header();
-    dg->header.mode = WORKER_DATAGRAM_MODE_EXECUTE_REQUEST;
+    // Tasks larger than PIPE_BUF may arrive in several pieces.
+    if (read_full(fd, dg->data, dg->data_len) != (ssize_t)dg->data_len) {
+        free(dg);
+        return ERR;
+    }
 
     return dg;
-
     #undef ERR
 }
 
-
-WorkerExecuteRequestDatagram read_partial_worker_execute_request_datagram(int fd, WORKER_DATAGRAM_HEADER header) {
+WorkerExecuteRequestDatagram unpack_worker_execute_request_datagram(const void* buf, size_t size) {
     #define ERR NULL
-    
-    WorkerExecuteRequestDatagram dg = SAFE_ALLOC(WorkerExecuteRequestDatagram, sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM));
-    dg->header = header;
+    if (size < sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM)) return ERR;
 
-    // SAFE_READ(
-    //     fd, 
-    //     (((void*)dg) + sizeof(WORKER_DATAGRAM_HEADER)), 
-    //     sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM) - sizeof(WORKER_DATAGRAM_HEADER)
-    // );
+    WORKER_EXECUTE_REQUEST_DATAGRAM fixed;
+    memcpy(&fixed, buf, sizeof(WORKER_EXECUTE_REQUEST_DATAGRAM));
+    if (fixed.data_len > EXECUTE_REQUEST_DATAGRAM_MAX_PAYLOAD_LEN || WORKER_EXECUTE_REQUEST_DATAGRAM_SIZE(&fixed) != size) {
+        return ERR;
+    }
 
-    SAFE_READ(fd, dg->data, sizeof(dg->data) - 1);
+    WorkerExecuteRequestDatagram dg = SAFE_ALLOC(WorkerExecuteRequestDatagram, size + 1);
+    memcpy(dg, buf, size);
+    dg->data[dg->data_len] = '\0';
 
     return dg;
     #undef ERR
@@ -138,6 +119,7 @@ WorkerShutdownRequestDatagram create_worker_shutdown_request_datagram() {
     WorkerShutdownRequestDatagram dg = SAFE_ALLOC(WorkerShutdownRequestDatagram, sizeof(WORKER_SHUTDOWN_REQUEST_DATAGRAM));
     dg->header = create_worker_datagram_header();
     dg->header.mode = WORKER_DATAGRAM_MODE_SHUTDOWN_REQUEST;
+    dg->header.length = sizeof(WORKER_SHUTDOWN_REQUEST_DATAGRAM);
 
     return dg;
 
@@ -165,6 +147,11 @@ WorkerCompletionResponseDatagram create_worker_completion_response_datagram() {
     WorkerCompletionResponseDatagram dg = SAFE_ALLOC(WorkerCompletionResponseDatagram, sizeof(WORKER_COMPLETION_RESPONSE_DATAGRAM));
     dg->header = create_worker_datagram_header();
     dg->header.mode = WORKER_DATAGRAM_MODE_COMPLETION_RESPONSE;
+    dg->header.length = sizeof(WORKER_COMPLETION_RESPONSE_DATAGRAM);
+    dg->worker_id = 0;
+    dg->cpu_time = 0;
+    dg->timed_out = 0;
+    dg->exit_status = 0;
 
     return dg;
 
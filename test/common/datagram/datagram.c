@@ -16,27 +16,35 @@
 #define EXECUTE_REQUEST_FILE "test_execute_request.dat"
 #define STATUS_RESPONSE_FILE "test_status_response.dat"
 #define EXECUTE_RESPONSE_FILE "test_execute_response.dat"
+#define EXECUTE_BATCH_REQUEST_FILE "test_execute_batch_request.dat"
+#define EXECUTE_BATCH_RESPONSE_FILE "test_execute_batch_response.dat"
 
 #define MOCK_PID 123456
 
-#define CONTROL_DATAGRAM_HEADER_STR_NEE "DatagramHeader{ version: 2, mode: 0, type: 0, pid: " STR(MOCK_PID) " }"
-#define CONTROL_DATAGRAM_HEADER_STR_EE "DatagramHeader{ version: 2, mode: DATAGRAM_MODE_NONE, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) " }"
+#define CONTROL_DATAGRAM_HEADER_STR_NEE "DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: 0, type: 0, pid: " STR(MOCK_PID) ", request_id: 0 }"
+#define CONTROL_DATAGRAM_HEADER_STR_EE "DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: DATAGRAM_MODE_NONE, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) ", request_id: 0 }"
 
-#define CONTROL_STATUS_REQUEST_STR_EE "StatusRequestDatagram{ header: DatagramHeader{ version: 2, mode: DATAGRAM_MODE_STATUS_REQUEST, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) " } }"
-#define CONTROL_STATUS_REQUEST_STR_NEE "StatusRequestDatagram{ header: DatagramHeader{ version: 2, mode: 1, type: 0, pid: " STR(MOCK_PID) " } }"
+#define CONTROL_STATUS_REQUEST_STR_EE "StatusRequestDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: DATAGRAM_MODE_STATUS_REQUEST, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) ", request_id: 0 }, sections: 31, completed_limit: 0 }"
+#define CONTROL_STATUS_REQUEST_STR_NEE "StatusRequestDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: 1, type: 0, pid: " STR(MOCK_PID) ", request_id: 0 }, sections: 31, completed_limit: 0 }"
 
-#define CONTROL_EXECUTE_REQUEST_STR_NEE_NSP "ExecuteRequestDatagram{ header: DatagramHeader{ version: 2, mode: 2, type: 1, pid: " STR(MOCK_PID) " }, time: 69, data: '4C:6F:72:65:6D:20:69:70:73:75:6D:20:64:6F:6C:6F:72:20:73:69:74:20:61:6D:65:74:2C:20:63:6F:6E:73:65:63:74:65:74:75:72:20:61:64:69:70:69:73:63:69:6E:67:20:65:6C:69:74:2E:20:4D:6F:72:62:69:20:6C:6F:62:6F:72:74:69:73:2C:20:65:6E:69:6D:20:65:75:20:66:72:69:6E:67:69:6C:6C:61:20:65:6C:65:6D:65:6E:74:75:6D:2C:20:6C:65:6F:20:65:72:61:74:20:62:69:62:65:6E:64:75:6D:20:6E:75:6C:6C:61:2C:20:61:74:20:65:66:66:69:63:69:74:75:72:20:6C:6F:72:65:6D:20:64:69:61:6D:20:65:67:65:74:20:6E:69:73:69:2E:20:50:72:6F:69:6E:20:65:75:69:73:6D:6F:64:2C:20:75:72:6E:61:20:61:20:63:75:72:73:75:73:20:73:65:6D:70:65:72:2C:20:66:65:6C:69:73:20:65:6C:69:74:20:73:6F:6C:6C:69:63:69:74:75:64:69:6E:20:70:75:72:75:73:2C:20:69:6E:20:6C:6F:62:6F:72:74:69:73:20:64:6F:6C:6F:72:20:6C:65:6F:20:61:20:65:73:74:2E:20:50:72:61:65:73:65:6E:74:20:61:6C:69:71:75:61:6D:20:6C:61:63:75:73:20:6E:65:63:20:6D:61:73:73:61:20:6C:61:6F:72:65:65:74:00' }"
-#define CONTROL_EXECUTE_REQUEST_STR_NEE_SP "ExecuteRequestDatagram{ header: DatagramHeader{ version: 2, mode: 2, type: 1, pid: " STR(MOCK_PID) " }, time: 69, data: 'Lorem ipsum dolor sit amet, consectetur adipiscing elit. Morbi lobortis, enim eu fringilla elementum, leo erat bibendum nulla, at efficitur lorem diam eget nisi. Proin euismod, urna a cursus semper, felis elit sollicitudin purus, in lobortis dolor leo a est. Praesent aliquam lacus nec massa laoreet' }"
-#define CONTROL_EXECUTE_REQUEST_STR_EE_NSP "ExecuteRequestDatagram{ header: DatagramHeader{ version: 2, mode: DATAGRAM_MODE_EXECUTE_REQUEST, type: DATAGRAM_TYPE_UNIQUE, pid: " STR(MOCK_PID) " }, time: 69, data: '4C:6F:72:65:6D:20:69:70:73:75:6D:20:64:6F:6C:6F:72:20:73:69:74:20:61:6D:65:74:2C:20:63:6F:6E:73:65:63:74:65:74:75:72:20:61:64:69:70:69:73:63:69:6E:67:20:65:6C:69:74:2E:20:4D:6F:72:62:69:20:6C:6F:62:6F:72:74:69:73:2C:20:65:6E:69:6D:20:65:75:20:66:72:69:6E:67:69:6C:6C:61:20:65:6C:65:6D:65:6E:74:75:6D:2C:20:6C:65:6F:20:65:72:61:74:20:62:69:62:65:6E:64:75:6D:20:6E:75:6C:6C:61:2C:20:61:74:20:65:66:66:69:63:69:74:75:72:20:6C:6F:72:65:6D:20:64:69:61:6D:20:65:67:65:74:20:6E:69:73:69:2E:20:50:72:6F:69:6E:20:65:75:69:73:6D:6F:64:2C:20:75:72:6E:61:20:61:20:63:75:72:73:75:73:20:73:65:6D:70:65:72:2C:20:66:65:6C:69:73:20:65:6C:69:74:20:73:6F:6C:6C:69:63:69:74:75:64:69:6E:20:70:75:72:75:73:2C:20:69:6E:20:6C:6F:62:6F:72:74:69:73:20:64:6F:6C:6F:72:20:6C:65:6F:20:61:20:65:73:74:2E:20:50:72:61:65:73:65:6E:74:20:61:6C:69:71:75:61:6D:20:6C:61:63:75:73:20:6E:65:63:20:6D:61:73:73:61:20:6C:61:6F:72:65:65:74:00' }"
-#define CONTROL_EXECUTE_REQUEST_STR_EE_SP "ExecuteRequestDatagram{ header: DatagramHeader{ version: 2, mode: DATAGRAM_MODE_EXECUTE_REQUEST, type: DATAGRAM_TYPE_UNIQUE, pid: " STR(MOCK_PID) " }, time: 69, data: 'Lorem ipsum dolor sit amet, consectetur adipiscing elit. Morbi lobortis, enim eu fringilla elementum, leo erat bibendum nulla, at efficitur lorem diam eget nisi. Proin euismod, urna a cursus semper, felis elit sollicitudin purus, in lobortis dolor leo a est. Praesent aliquam lacus nec massa laoreet' }"
+#define CONTROL_EXECUTE_REQUEST_STR_NEE_NSP "ExecuteRequestDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: 2, type: 1, pid: " STR(MOCK_PID) ", request_id: 0 }, time: 69, priority: 2, data_len: 299, data: '4C:6F:72:65:6D:20:69:70:73:75:6D:20:64:6F:6C:6F:72:20:73:69:74:20:61:6D:65:74:2C:20:63:6F:6E:73:65:63:74:65:74:75:72:20:61:64:69:70:69:73:63:69:6E:67:20:65:6C:69:74:2E:20:4D:6F:72:62:69:20:6C:6F:62:6F:72:74:69:73:2C:20:65:6E:69:6D:20:65:75:20:66:72:69:6E:67:69:6C:6C:61:20:65:6C:65:6D:65:6E:74:75:6D:2C:20:6C:65:6F:20:65:72:61:74:20:62:69:62:65:6E:64:75:6D:20:6E:75:6C:6C:61:2C:20:61:74:20:65:66:66:69:63:69:74:75:72:20:6C:6F:72:65:6D:20:64:69:61:6D:20:65:67:65:74:20:6E:69:73:69:2E:20:50:72:6F:69:6E:20:65:75:69:73:6D:6F:64:2C:20:75:72:6E:61:20:61:20:63:75:72:73:75:73:20:73:65:6D:70:65:72:2C:20:66:65:6C:69:73:20:65:6C:69:74:20:73:6F:6C:6C:69:63:69:74:75:64:69:6E:20:70:75:72:75:73:2C:20:69:6E:20:6C:6F:62:6F:72:74:69:73:20:64:6F:6C:6F:72:20:6C:65:6F:20:61:20:65:73:74:2E:20:50:72:61:65:73:65:6E:74:20:61:6C:69:71:75:61:6D:20:6C:61:63:75:73:20:6E:65:63:20:6D:61:73:73:61:20:6C:61:6F:72:65:65:74' }"
+#define CONTROL_EXECUTE_REQUEST_STR_NEE_SP "ExecuteRequestDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: 2, type: 1, pid: " STR(MOCK_PID) ", request_id: 0 }, time: 69, priority: 2, data_len: 299, data: 'Lorem ipsum dolor sit amet, consectetur adipiscing elit. Morbi lobortis, enim eu fringilla elementum, leo erat bibendum nulla, at efficitur lorem diam eget nisi. Proin euismod, urna a cursus semper, felis elit sollicitudin purus, in lobortis dolor leo a est. Praesent aliquam lacus nec massa laoreet' }"
+#define CONTROL_EXECUTE_REQUEST_STR_EE_NSP "ExecuteRequestDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: DATAGRAM_MODE_EXECUTE_REQUEST, type: DATAGRAM_TYPE_UNIQUE, pid: " STR(MOCK_PID) ", request_id: 0 }, time: 69, priority: 2, data_len: 299, data: '4C:6F:72:65:6D:20:69:70:73:75:6D:20:64:6F:6C:6F:72:20:73:69:74:20:61:6D:65:74:2C:20:63:6F:6E:73:65:63:74:65:74:75:72:20:61:64:69:70:69:73:63:69:6E:67:20:65:6C:69:74:2E:20:4D:6F:72:62:69:20:6C:6F:62:6F:72:74:69:73:2C:20:65:6E:69:6D:20:65:75:20:66:72:69:6E:67:69:6C:6C:61:20:65:6C:65:6D:65:6E:74:75:6D:2C:20:6C:65:6F:20:65:72:61:74:20:62:69:62:65:6E:64:75:6D:20:6E:75:6C:6C:61:2C:20:61:74:20:65:66:66:69:63:69:74:75:72:20:6C:6F:72:65:6D:20:64:69:61:6D:20:65:67:65:74:20:6E:69:73:69:2E:20:50:72:6F:69:6E:20:65:75:69:73:6D:6F:64:2C:20:75:72:6E:61:20:61:20:63:75:72:73:75:73:20:73:65:6D:70:65:72:2C:20:66:65:6C:69:73:20:65:6C:69:74:20:73:6F:6C:6C:69:63:69:74:75:64:69:6E:20:70:75:72:75:73:2C:20:69:6E:20:6C:6F:62:6F:72:74:69:73:20:64:6F:6C:6F:72:20:6C:65:6F:20:61:20:65:73:74:2E:20:50:72:61:65:73:65:6E:74:20:61:6C:69:71:75:61:6D:20:6C:61:63:75:73:20:6E:65:63:20:6D:61:73:73:61:20:6C:61:6F:72:65:65:74' }"
+#define CONTROL_EXECUTE_REQUEST_STR_EE_SP "ExecuteRequestDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: DATAGRAM_MODE_EXECUTE_REQUEST, type: DATAGRAM_TYPE_UNIQUE, pid: " STR(MOCK_PID) ", request_id: 0 }, time: 69, priority: 2, data_len: 299, data: 'Lorem ipsum dolor sit amet, consectetur adipiscing elit. Morbi lobortis, enim eu fringilla elementum, leo erat bibendum nulla, at efficitur lorem diam eget nisi. Proin euismod, urna a cursus semper, felis elit sollicitudin purus, in lobortis dolor leo a est. Praesent aliquam lacus nec massa laoreet' }"
 
-#define CONTROL_STATUS_RESPONSE_STR_NEE_NSP "StatusResponseDatagram{ header: DatagramHeader{ version: 2, mode: 3, type: 0, pid: " STR(MOCK_PID) " }, payload_len: 13, data: '48:65:6C:6C:6F:20:77:6F:72:6C:64:21:00' }"
-#define CONTROL_STATUS_RESPONSE_STR_NEE_SP "StatusResponseDatagram{ header: DatagramHeader{ version: 2, mode: 3, type: 0, pid: " STR(MOCK_PID) " }, payload_len: 13, data: 'Hello world!' }"
-#define CONTROL_STATUS_RESPONSE_STR_EE_NSP "StatusResponseDatagram{ header: DatagramHeader{ version: 2, mode: DATAGRAM_MODE_STATUS_RESPONSE, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) " }, payload_len: 13, data: '48:65:6C:6C:6F:20:77:6F:72:6C:64:21:00' }"
-#define CONTROL_STATUS_RESPONSE_STR_EE_SP "StatusResponseDatagram{ header: DatagramHeader{ version: 2, mode: DATAGRAM_MODE_STATUS_RESPONSE, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) " }, payload_len: 13, data: 'Hello world!' }"
+#define CONTROL_STATUS_RESPONSE_STR_NEE_NSP "StatusResponseDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: 3, type: 0, pid: " STR(MOCK_PID) ", request_id: 0 }, payload_len: 13, last: 1, data: '48:65:6C:6C:6F:20:77:6F:72:6C:64:21:00' }"
+#define CONTROL_STATUS_RESPONSE_STR_NEE_SP "StatusResponseDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: 3, type: 0, pid: " STR(MOCK_PID) ", request_id: 0 }, payload_len: 13, last: 1, data: 'Hello world!' }"
+#define CONTROL_STATUS_RESPONSE_STR_EE_NSP "StatusResponseDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: DATAGRAM_MODE_STATUS_RESPONSE, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) ", request_id: 0 }, payload_len: 13, last: 1, data: '48:65:6C:6C:6F:20:77:6F:72:6C:64:21:00' }"
+#define CONTROL_STATUS_RESPONSE_STR_EE_SP "StatusResponseDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: DATAGRAM_MODE_STATUS_RESPONSE, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) ", request_id: 0 }, payload_len: 13, last: 1, data: 'Hello world!' }"
 
-#define CONTROL_EXECUTE_RESPONSE_STR_NEE "ExecuteResponseDatagram{ header: DatagramHeader{ version: 2, mode: 4, type: 0, pid: " STR(MOCK_PID) " }, taskid: 123 }"
-#define CONTROL_EXECUTE_RESPONSE_STR_EE "ExecuteResponseDatagram{ header: DatagramHeader{ version: 2, mode: DATAGRAM_MODE_EXECUTE_RESPONSE, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) " }, taskid: 123 }"
+#define CONTROL_EXECUTE_RESPONSE_STR_NEE "ExecuteResponseDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: 4, type: 0, pid: " STR(MOCK_PID) ", request_id: 0 }, taskid: 0, status: 1, retry_after: 250 }"
+#define CONTROL_EXECUTE_RESPONSE_STR_EE "ExecuteResponseDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: DATAGRAM_MODE_EXECUTE_RESPONSE, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) ", request_id: 0 }, taskid: 0, status: 1, retry_after: 250 }"
+
+#define CONTROL_EXECUTE_BATCH_REQUEST_STR_NEE "ExecuteBatchRequestDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: 7, type: 0, pid: " STR(MOCK_PID) ", request_id: 0 }, num_tasks: 2, payload_len: 52, tasks: [{ time: 69, type: 1, priority: 1, after: [], data: 'Lorem ipsum' }, { time: 420, type: 2, priority: 2, after: [-1, 7], data: 'dolor | sit amet' }] }"
+#define CONTROL_EXECUTE_BATCH_REQUEST_STR_EE "ExecuteBatchRequestDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: DATAGRAM_MODE_EXECUTE_BATCH_REQUEST, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) ", request_id: 0 }, num_tasks: 2, payload_len: 52, tasks: [{ time: 69, type: 1, priority: 1, after: [], data: 'Lorem ipsum' }, { time: 420, type: 2, priority: 2, after: [-1, 7], data: 'dolor | sit amet' }] }"
+
+#define CONTROL_EXECUTE_BATCH_RESPONSE_STR_NEE "ExecuteBatchResponseDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: 8, type: 0, pid: " STR(MOCK_PID) ", request_id: 0 }, first_taskid: 123, num_tasks: 2, status: 0, retry_after: 0 }"
+#define CONTROL_EXECUTE_BATCH_RESPONSE_STR_EE "ExecuteBatchResponseDatagram{ header: DatagramHeader{ version: " STR(DATAGRAM_VERSION) ", mode: DATAGRAM_MODE_EXECUTE_BATCH_RESPONSE, type: DATAGRAM_TYPE_NONE, pid: " STR(MOCK_PID) ", request_id: 0 }, first_taskid: 123, num_tasks: 2, status: 0, retry_after: 0 }"
 #pragma endregion
 
 void test_status_request_datagram(StatusRequestDatagram dg) {
@@ -195,6 +203,63 @@ void test_execute_response_datagram(ExecuteResponseDatagram dg) {
     TEST_ERROR_LABEL
 }
 
+void test_execute_batch_request_datagram(ExecuteBatchRequestDatagram dg) {
+    ERROR_HEADER
+
+    char* execute_str_ee = execute_batch_request_datagram_to_string(dg, 1);
+    char* execute_str_nee = execute_batch_request_datagram_to_string(dg, 0);
+
+    ASSERT(
+        STRING_EQUAL(
+            execute_str_ee, 
+            CONTROL_EXECUTE_BATCH_REQUEST_STR_EE
+        ),
+        "[EBRQ] [TOSTRING_EE] Execute batch datagram read from test data does not match control."
+    )
+
+    ASSERT(
+        STRING_EQUAL(
+            execute_str_nee, 
+            CONTROL_EXECUTE_BATCH_REQUEST_STR_NEE
+        ),
+        "[EBRQ] [TOSTRING_NEE] Execute batch datagram read from test data does not match control."
+    )
+
+    free(execute_str_ee);
+    free(execute_str_nee);
+
+    return;
+    TEST_ERROR_LABEL
+}
+
+void test_execute_batch_response_datagram(ExecuteBatchResponseDatagram dg) {
+    ERROR_HEADER
+
+    char* execute_str_ee = execute_batch_response_datagram_to_string(dg, 1);
+    char* execute_str_nee = execute_batch_response_datagram_to_string(dg, 0);
+
+    ASSERT(
+        STRING_EQUAL(
+            execute_str_ee, 
+            CONTROL_EXECUTE_BATCH_RESPONSE_STR_EE
+        ),
+        "[EBRS] [TOSTRING_EE] Execute batch datagram read from test data does not match control."
+    )
+
+    ASSERT(
+        STRING_EQUAL(
+            execute_str_nee, 
+            CONTROL_EXECUTE_BATCH_RESPONSE_STR_NEE
+        ),
+        "[EBRS] [TOSTRING_NEE] Execute batch datagram read from test data does not match control."
+    )
+
+    free(execute_str_ee);
+    free(execute_str_nee);
+
+    return;
+    TEST_ERROR_LABEL
+}
 
 // void test_template(StatusRequestDatagram dg) {
 //     ERROR_HEADER
@@ -241,25 +306,162 @@ void test_datagram(char* test_data_dir) {
         status_req->header.pid = MOCK_PID;
         test_status_request_datagram(status_req);
 
+        // Filters select a single section, and only the completed section takes a limit.
+        {
+            char* completed[] = { "completed", "10" };
+            char* running[] = { "running", "10" };
+            char* unknown[] = { "everything" };
+
+            ASSERT(
+                set_status_request_filter(status_req, 2, completed) == 0 
+                    && status_req->sections == STATUS_SECTION_COMPLETED && status_req->completed_limit == 10,
+                "[SRQD] [FILTER] Status datagram filter does not match control."
+            )
+            ASSERT(
+                set_status_request_filter(status_req, 2, running) != 0 && set_status_request_filter(status_req, 1, unknown) != 0,
+                "[SRQD] [FILTER] Invalid status datagram filter was accepted."
+            )
+            ASSERT(
+                set_status_request_filter(status_req, 0, NULL) == 0 
+                    && status_req->sections == STATUS_SECTION_ALL && status_req->completed_limit == 0,
+                "[SRQD] [FILTER] Status datagram filter was not reset."
+            )
+        }
+
         // ======= STATUS RESPONSE DATAGRAM =======
         uint8_t status_res_payload[] = "Hello world!";
         StatusResponseDatagram status_res = create_status_response_datagram(status_res_payload, 13);
         status_res->header.pid = MOCK_PID;
         test_status_response_datagram(status_res);
 
+        ASSERT(
+            get_response_datagram_size(status_res, sizeof(STATUS_RESPONSE_DATAGRAM) + 13) 
+                == (ssize_t)sizeof(STATUS_RESPONSE_DATAGRAM) + 13,
+            "[SRSD] [SIZE] Status datagram size does not match its length prefix."
+        )
+        ASSERT(
+            get_response_datagram_size(status_res, sizeof(STATUS_RESPONSE_DATAGRAM) - 1) == 0,
+            "[SRSD] [SIZE] Status datagram size was determined before its length prefix."
+        )
+
+        status_res->payload_len = STATUS_RESPONSE_DATAGRAM_MAX_PAYLOAD_LEN + 1;
+        ASSERT(
+            get_response_datagram_size(status_res, sizeof(STATUS_RESPONSE_DATAGRAM)) == -1,
+            "[SRSD] [SIZE] Status datagram larger than a chunk was accepted."
+        )
+        status_res->payload_len = 13;
+
         // ======= EXECUTE RESPONSE DATAGRAM =======
-        ExecuteRequestDatagram execute_req = create_execute_request_datagram();
+        char* execute_req_data = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Morbi lobortis, enim eu fringilla elementum, leo erat bibendum nulla, at efficitur lorem diam eget nisi. Proin euismod, urna a cursus semper, felis elit sollicitudin purus, in lobortis dolor leo a est. Praesent aliquam lacus nec massa laoreet";
+        ExecuteRequestDatagram execute_req = create_execute_request_datagram(execute_req_data, strlen(execute_req_data));
         execute_req->header.pid = MOCK_PID;
         execute_req->header.type = DATAGRAM_TYPE_UNIQUE;
         execute_req->time = 0x45;
-        memcpy(execute_req->data, "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Morbi lobortis, enim eu fringilla elementum, leo erat bibendum nulla, at efficitur lorem diam eget nisi. Proin euismod, urna a cursus semper, felis elit sollicitudin purus, in lobortis dolor leo a est. Praesent aliquam lacus nec massa laoreet", 300);
+        execute_req->priority = TASK_PRIORITY_HIGH;
         test_execute_request_datagram(execute_req);
 
+        ASSERT(
+            get_request_datagram_size(execute_req, EXECUTE_REQUEST_DATAGRAM_SIZE(execute_req)) 
+                == (ssize_t)EXECUTE_REQUEST_DATAGRAM_SIZE(execute_req),
+            "[ERD] [SIZE] Execute datagram size does not match its length prefix."
+        )
+        ASSERT(
+            get_request_datagram_size(execute_req, sizeof(EXECUTE_REQUEST_DATAGRAM) - 1) == 0,
+            "[ERD] [SIZE] Execute datagram size was determined before its length prefix."
+        )
+        free(execute_req);
+
         // ======= EXECUTE RESPONSE DATAGRAM =======
         ExecuteResponseDatagram execute_res = create_execute_response_datagram();
         execute_res->header.pid = MOCK_PID;
-        execute_res->taskid = 123;
+        execute_res->taskid = 0;
+        execute_res->status = EXECUTE_STATUS_BUSY;
+        execute_res->retry_after = 250;
         test_execute_response_datagram(execute_res);
+
+        // ======= EXECUTE BATCH REQUEST DATAGRAM =======
+        ExecuteBatchRequestDatagram execute_batch_req = create_execute_batch_request_datagram();
+        execute_batch_req->header.pid = MOCK_PID;
+        ASSERT(
+            append_execute_batch_request_datagram(
+                execute_batch_req, 
+                69, 
+                DATAGRAM_TYPE_UNIQUE, 
+                TASK_PRIORITY_NORMAL, 
+                "Lorem ipsum", 
+                NULL, 
+                0
+            ) == 0,
+            "[EBRQ] [APPEND] Unable to append task to execute batch datagram."
+        )
+        ASSERT(
+            append_execute_batch_request_datagram(
+                execute_batch_req, 
+                420, 
+                DATAGRAM_TYPE_PIPELINE, 
+                TASK_PRIORITY_HIGH, 
+                "dolor | sit amet", 
+                (int32_t[]){ -1, 7 }, 
+                2
+            ) == 0,
+            "[EBRQ] [APPEND] Unable to append task to execute batch datagram."
+        )
+        test_execute_batch_request_datagram(execute_batch_req);
+
+        // Entries are counted from the payload itself, and a payload they do not fill exactly is malformed.
+        ASSERT(
+            count_execute_batch_entries(execute_batch_req->payload, execute_batch_req->payload_len) == 2,
+            "[EBRQ] [COUNT] Execute batch entries don't match control."
+        )
+        ASSERT(
+            count_execute_batch_entries(execute_batch_req->payload, execute_batch_req->payload_len - 1) == -1,
+            "[EBRQ] [COUNT] Truncated execute batch payload was not rejected."
+        )
+        ASSERT(count_execute_batch_entries(NULL, 0) == 0, "[EBRQ] [COUNT] Empty execute batch has entries.")
+
+        // Fill the batch until it refuses new tasks, and make sure it never outgrows its maximum size.
+        {
+            int appended = 0;
+            while (
+                append_execute_batch_request_datagram(
+                    execute_batch_req, 
+                    1, 
+                    DATAGRAM_TYPE_UNIQUE, 
+                    TASK_PRIORITY_NORMAL, 
+                    "Lorem ipsum", 
+                    NULL, 
+                    0
+                ) == 0
+            ) {
+                appended++;
+            }
+
+            ASSERT(
+                appended > 0 && EXECUTE_BATCH_REQUEST_DATAGRAM_SIZE(execute_batch_req) <= EXECUTE_BATCH_REQUEST_DATAGRAM_MAX_SIZE,
+                "[EBRQ] [APPEND] Execute batch datagram exceeds its maximum size."
+            )
+
+            int iterated = 0;
+            for (
+                ExecuteBatchEntry entry = next_execute_batch_entry(execute_batch_req, NULL); 
+                entry != NULL; 
+                entry = next_execute_batch_entry(execute_batch_req, entry)
+            ) iterated++;
+
+            ASSERT(
+                iterated == execute_batch_req->num_tasks && iterated == appended + 2,
+                "[EBRQ] [ITERATE] Execute batch datagram entries do not match the number of tasks."
+            )
+        }
+        free(execute_batch_req);
+
+        // ======= EXECUTE BATCH RESPONSE DATAGRAM =======
+        ExecuteBatchResponseDatagram execute_batch_res = create_execute_batch_response_datagram();
+        execute_batch_res->header.pid = MOCK_PID;
+        execute_batch_res->first_taskid = 123;
+        execute_batch_res->num_tasks = 2;
+        test_execute_batch_response_datagram(execute_batch_res);
+        free(execute_batch_res);
     #pragma endregion
 
     #pragma region ============== REQUESTS ==============
@@ -322,6 +524,36 @@ void test_datagram(char* test_data_dir) {
     close(execute_fd);
     #pragma endregion
 
+    #pragma region ======= EXECUTE BATCH DATAGRAM =======
+    char* test_execute_batch_file = join_paths(2, test_data_dir, EXECUTE_BATCH_REQUEST_FILE);
+    int execute_batch_fd = SAFE_OPEN(test_execute_batch_file, O_RDONLY, NULL);
+    if (execute_batch_fd == -1) ERROR("Unable to open execute batch request test data file.")
+
+    // Read execute batch in a single function call
+    {
+        ExecuteBatchRequestDatagram execute_batch_all = read_execute_batch_request_datagram(execute_batch_fd);
+        execute_batch_all->header.pid = MOCK_PID;
+
+        test_execute_batch_request_datagram(execute_batch_all);
+        free(execute_batch_all);
+    }
+
+    lseek(execute_batch_fd, 0, SEEK_SET);
+
+    // Read execute batch in a partial call
+    {
+        DATAGRAM_HEADER header = read_datagram_header(execute_batch_fd);
+        ExecuteBatchRequestDatagram execute_batch_partial = read_partial_execute_batch_request_datagram(execute_batch_fd, header);
+        execute_batch_partial->header.pid = MOCK_PID;
+
+        test_execute_batch_request_datagram(execute_batch_partial);
+        free(execute_batch_partial);
+    }
+
+    close(execute_batch_fd);
+    #pragma endregion
+
+    free(test_execute_batch_file);
     free(test_execute_file);
     free(test_status_file);
     }
@@ -387,8 +619,38 @@ void test_datagram(char* test_data_dir) {
         close(execute_fd);
         #pragma endregion
 
+        #pragma region ======= EXECUTE BATCH DATAGRAM =======
+        char* test_execute_batch_file = join_paths(2, test_data_dir, EXECUTE_BATCH_RESPONSE_FILE);
+        int execute_batch_fd = SAFE_OPEN(test_execute_batch_file, O_RDONLY, NULL);
+        if (execute_batch_fd == -1) ERROR("Unable to open execute batch response test data file.")
+
+        // Read execute batch in a single function call
+        {
+            ExecuteBatchResponseDatagram execute_batch_all = read_execute_batch_response_datagram(execute_batch_fd);
+            execute_batch_all->header.pid = MOCK_PID;
+
+            test_execute_batch_response_datagram(execute_batch_all);
+            free(execute_batch_all);
+        }
+
+        lseek(execute_batch_fd, 0, SEEK_SET);
+
+        // Read execute batch in a partial call
+        {
+            DATAGRAM_HEADER header = read_datagram_header(execute_batch_fd);
+            ExecuteBatchResponseDatagram execute_batch_partial = read_partial_execute_batch_response_datagram(execute_batch_fd, header);
+            execute_batch_partial->header.pid = MOCK_PID;
+
+            test_execute_batch_response_datagram(execute_batch_partial);
+            free(execute_batch_partial);
+        }
+
+        close(execute_batch_fd);
+        #pragma endregion
+
         free(test_status_file);
         free(test_execute_file);
+        free(test_execute_batch_file);
     }
     #pragma endregion
     return;
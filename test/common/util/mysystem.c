@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "common/util/string.h"
+#include "common/util/mysystem.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+/**
+ * @brief Returns whether the arguments of a command are exactly the given ones.
+ */
+static int _args_match(char** args, const char** control, int len) {
+    if (args == NULL) return 0;
+
+    for (int i = 0; i < len; i++) {
+        if (args[i] == NULL || !STRING_EQUAL(args[i], control[i])) return 0;
+    }
+
+    return args[len] == NULL;
+}
+
+void test_parse_command_args() {
+    ERROR_HEADER
+
+    #pragma region ======= PARSE =======
+    {
+        char** args = parse_command_args("  ls   -l  /tmp ");
+        ASSERT(_args_match(args, (const char*[]){ "ls", "-l", "/tmp" }, 3), "[CMD] Arguments don't match control.");
+        destroy_command_args(args);
+
+        // Quotes keep the spaces within them, whether they hold one word or several.
+        args = parse_command_args("echo 'a' \"b  c\" d'e f'g ''");
+        ASSERT(
+            _args_match(args, (const char*[]){ "echo", "a", "b  c", "de fg", "" }, 5),
+            "[CMD] Quoted arguments don't match control."
+        );
+        destroy_command_args(args);
+
+        args = parse_command_args("   ");
+        ASSERT(args != NULL && args[0] == NULL, "[CMD] Empty command has arguments.");
+        destroy_command_args(args);
+    }
+    #pragma endregion ======= PARSE =======
+
+    #pragma region ======= EXIT STATUS =======
+    {
+        ASSERT(mysystem("true") == 0, "[CMD] Successful command failed.");
+        ASSERT(mysystem("sh -c 'exit 3'") == 3, "[CMD] Exit status was not propagated.");
+        ASSERT(mysystem("sh -c 'kill -KILL $$'") == 128 + 9, "[CMD] Killed command status doesn't match control.");
+        ASSERT(
+            mysystem("orchestrator-nonexistent-command") == MYSYSTEM_EXIT_NOT_RUN,
+            "[CMD] Missing command was not reported."
+        );
+    }
+    #pragma endregion ======= EXIT STATUS =======
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_mysystem() {
+    test_parse_command_args();
+}
@@ -8,13 +8,38 @@
  *   - common/datagram/datagram.c                                             *
  *   - common/datagram/execute.c                                              *
  *   - common/datagram/status.c                                               *
+ *   - common/util/mysystem.c                                                 *
+ *   - server/worker_datagrams.c                                              *
+ *   - server/ring.c                                                          *
+ *   - server/priority_queue.c                                                *
+ *   - server/fair_queue.c                                                    *
+ *   - server/backlog.c                                                       *
+ *   - server/dependency.c                                                    *
+ *   - server/admission.c                                                     *
+ *   - server/snapshot.c                                                      *
+ *   - server/claims.c                                                        *
+ *   - server/estimator.c                                                     *
+ *   - server/concurrency.c                                                   *
+ *   - server/topology.c                                                      *
  ******************************************************************************/
 
 #include <stdio.h>
 #include "common/util/string.h"
 #include "common/io/io.h"
 #include "test/common/datagram/datagram.h"
+#include "test/common/util/mysystem.h"
 #include "test/server/worker_datagrams.h"
+#include "test/server/ring.h"
+#include "test/server/priority_queue.h"
+#include "test/server/fair_queue.h"
+#include "test/server/backlog.h"
+#include "test/server/dependency.h"
+#include "test/server/admission.h"
+#include "test/server/snapshot.h"
+#include "test/server/claims.h"
+#include "test/server/estimator.h"
+#include "test/server/concurrency.h"
+#include "test/server/topology.h"
 
 #define TEST_DATA_DIR "test_data"
 
@@ -29,7 +54,19 @@ int main(int argc, char const *argv[]) {
 
     // Test runners
     test_datagram(test_data_dir);
+    test_mysystem();
     test_worker_datagram(test_data_dir);
+    test_ring();
+    test_priority_queue();
+    test_fair_queue();
+    test_backlog();
+    test_dependency_graph();
+    test_admission();
+    test_snapshot();
+    test_claims();
+    test_estimator();
+    test_concurrency();
+    test_topology();
 
     // Cleanup
     free(test_data_dir);
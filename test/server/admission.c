@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "server/admission.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+void test_admission_limits() {
+    ERROR_HEADER
+
+    #pragma region ======= LIMITS =======
+    {
+        Admission admission = create_admission(4, 2);
+        ASSERT(admission != NULL, "[AC] Unable to create admission control.");
+
+        // Each client is bound by its own limit.
+        ASSERT(admission_admit(admission, 100, 1) == 0, "[AC] Task under every limit was refused.");
+        ASSERT(admission_admit(admission, 100, 1) == 0, "[AC] Task up to the client limit was refused.");
+        ASSERT(admission_admit(admission, 100, 1) != 0, "[AC] Task over the client limit was admitted.");
+        ASSERT(admission_admit(admission, 101, 2) == 0, "[AC] Other client was refused.");
+
+        // Every client is bound by the global limit.
+        ASSERT(admission_admit(admission, 102, 1) != 0, "[AC] Task over the global limit was admitted.");
+        ASSERT(get_admission_outstanding(admission) == 4, "[AC] Outstanding tasks don't match control.");
+        ASSERT(admission->rejected == 2, "[AC] Refused requests don't match control.");
+
+        // Finished tasks make room again, for their own client first.
+        admission_release(admission, 100);
+        ASSERT(get_admission_outstanding(admission) == 3, "[AC] Finished task is still outstanding.");
+        ASSERT(admission_admit(admission, 101, 1) != 0, "[AC] Task over the client limit was admitted.");
+        ASSERT(admission_admit(admission, 100, 1) == 0, "[AC] Task under every limit was refused.");
+
+        // Tasks that never reached the operator are taken back.
+        admission_revoke(admission, 100, 1);
+        ASSERT(get_admission_outstanding(admission) == 3, "[AC] Revoked task is still outstanding.");
+
+        destroy_admission(admission);
+    }
+    #pragma endregion ======= LIMITS =======
+
+    #pragma region ======= RETRY AFTER =======
+    {
+        Admission admission = create_admission(0, 2);
+
+        // A request over a limit on its own is only admitted once nothing else is outstanding.
+        ASSERT(admission_admit(admission, 100, 1) == 0, "[AC] Task under every limit was refused.");
+        uint32_t retry_after = admission_admit(admission, 100, 8);
+        ASSERT(retry_after == ADMISSION_RETRY_AFTER * 9 / 2, "[AC] Retry hint doesn't match control.");
+        ASSERT(
+            admission_admit(admission, 100, 10000) == ADMISSION_MAX_RETRY_AFTER,
+            "[AC] Retry hint was not capped."
+        );
+        admission_release(admission, 100);
+        ASSERT(admission_admit(admission, 100, 8) == 0, "[AC] Lone oversized request was refused.");
+
+        destroy_admission(admission);
+    }
+    #pragma endregion ======= RETRY AFTER =======
+
+    #pragma region ======= SHARING =======
+    {
+        Admission admission = create_admission(1, 0);
+        ASSERT(admission_admit(admission, 100, 1) == 0, "[AC] Task under every limit was refused.");
+
+        // The operator releases tasks from its own process.
+        pid_t pid = fork();
+        if (pid == 0) {
+            admission_release(admission, 100);
+            _exit(0);
+        }
+        waitpid(pid, NULL, 0);
+
+        ASSERT(get_admission_outstanding(admission) == 0, "[AC] Task released by another process is outstanding.");
+        ASSERT(admission_admit(admission, 100, 1) == 0, "[AC] Task under every limit was refused.");
+
+        destroy_admission(admission);
+    }
+    #pragma endregion ======= SHARING =======
+
+    // Without an admission control, every request is admitted.
+    ASSERT(admission_admit(NULL, 100, 1000) == 0, "[AC] Request was refused without admission control.");
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_admission() {
+    test_admission_limits();
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "server/backlog.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+#define TEST_BACKLOG_QUANTUM 100
+
+typedef struct test_backlog_task {
+    int tenant;       // The submitter of the task.
+    uint8_t priority; // The priority class of the task.
+    int cost;         // The cost of the task, which also orders the tasks of a submitter.
+} TEST_BACKLOG_TASK, *TestBacklogTask;
+
+static gint _compare_test_tasks(gconstpointer a, gconstpointer b, gpointer user_data) {
+    UNUSED(user_data);
+    return ((TestBacklogTask)a)->cost - ((TestBacklogTask)b)->cost;
+}
+
+static uint32_t _get_test_task_cost(gconstpointer data) {
+    return ((TestBacklogTask)data)->cost;
+}
+
+void test_backlog_classes() {
+    ERROR_HEADER
+
+    #pragma region ======= CLASSES =======
+    {
+        Backlog backlog = create_backlog(0, _get_test_task_cost, _compare_test_tasks, NULL);
+        ASSERT(backlog != NULL, "[BL] Unable to create backlog.");
+        ASSERT(backlog_pop(backlog) == NULL && get_backlog_priority(backlog) == -1, "[BL] Empty backlog has a task.");
+
+        // Cheaper tasks go first within a class, but never ahead of a higher class.
+        TEST_BACKLOG_TASK tasks[] = {
+            { .tenant = 1, .priority = TASK_PRIORITY_NORMAL, .cost = 10 },
+            { .tenant = 1, .priority = TASK_PRIORITY_LOW, .cost = 1 },
+            { .tenant = 2, .priority = TASK_PRIORITY_HIGH, .cost = 50 },
+            { .tenant = 1, .priority = TASK_PRIORITY_NORMAL, .cost = 5 },
+            { .tenant = 2, .priority = TASK_PRIORITY_HIGH, .cost = 40 }
+        };
+        for (int i = 0; i < 5; i++) {
+            ASSERT(backlog_push(backlog, tasks[i].priority, tasks[i].tenant, &tasks[i]) == 0, "[BL] Unable to push task.");
+        }
+        ASSERT(backlog->length == 5, "[BL] Backlog length doesn't match control.");
+        ASSERT(get_backlog_priority(backlog) == TASK_PRIORITY_HIGH, "[BL] Backlog priority doesn't match control.");
+
+        int control[] = { 4, 2, 3, 0, 1 };
+        for (int i = 0; i < 5; i++) {
+            ASSERT(backlog_pop(backlog) == &tasks[control[i]], "[BL] Backlog order doesn't match control.");
+            if (i == 1) {
+                ASSERT(get_backlog_priority(backlog) == TASK_PRIORITY_NORMAL, "[BL] Emptied class is still reported.");
+            }
+        }
+        ASSERT(backlog->length == 0 && backlog_pop(backlog) == NULL, "[BL] Backlog is not empty.");
+
+        // Unknown classes are queued in the highest one.
+        TEST_BACKLOG_TASK unknown = { .tenant = 1, .priority = 200, .cost = 1 };
+        backlog_push(backlog, unknown.priority, unknown.tenant, &unknown);
+        ASSERT(get_backlog_priority(backlog) == TASK_PRIORITY_HIGH, "[BL] Unknown class was not capped.");
+        ASSERT(backlog_pop(backlog) == &unknown, "[BL] Unknown class task was lost.");
+
+        destroy_backlog(backlog);
+    }
+    #pragma endregion ======= CLASSES =======
+
+    #pragma region ======= FAIR SHARE =======
+    {
+        // Submitters still take turns within a class.
+        Backlog backlog = create_backlog(TEST_BACKLOG_QUANTUM, _get_test_task_cost, _compare_test_tasks, NULL);
+        ASSERT(backlog != NULL, "[BL] Unable to create backlog.");
+
+        TEST_BACKLOG_TASK tasks[] = {
+            { .tenant = 1, .priority = TASK_PRIORITY_NORMAL, .cost = 100 },
+            { .tenant = 1, .priority = TASK_PRIORITY_NORMAL, .cost = 100 },
+            { .tenant = 2, .priority = TASK_PRIORITY_NORMAL, .cost = 100 },
+            { .tenant = 3, .priority = TASK_PRIORITY_HIGH, .cost = 100 }
+        };
+        for (int i = 0; i < 4; i++) backlog_push(backlog, tasks[i].priority, tasks[i].tenant, &tasks[i]);
+
+        int control[] = { 3, 0, 2, 1 };
+        for (int i = 0; i < 4; i++) {
+            ASSERT(backlog_pop(backlog) == &tasks[control[i]], "[BL] Fair share order doesn't match control.");
+        }
+
+        destroy_backlog(backlog);
+    }
+    #pragma endregion ======= FAIR SHARE =======
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_backlog() {
+    test_backlog_classes();
+}
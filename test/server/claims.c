@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "server/claims.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+#define TEST_CLAIMS_WORKERS 2
+#define TEST_CLAIMS_CELLS 2
+
+void test_claims_ownership() {
+    ERROR_HEADER
+
+    WorkerClaims claims = create_worker_claims(TEST_CLAIMS_WORKERS, TEST_CLAIMS_CELLS);
+    ASSERT(claims != NULL, "[CLM] Unable to create worker claims.");
+
+    #pragma region ======= OFFER =======
+    {
+        int cell_a = offer_worker_claim(claims, 1, 10);
+        int cell_b = offer_worker_claim(claims, 1, 11);
+        ASSERT(cell_a != -1 && cell_b != -1 && cell_a != cell_b, "[CLM] Offered claims don't match control.");
+        ASSERT(offer_worker_claim(claims, 1, 12) == -1, "[CLM] Offered a claim with no free cell.");
+        ASSERT(find_worker_claim(claims, 0, 10, WORKER_CLAIM_QUEUED) == -1, "[CLM] Claim leaked to another worker.");
+        ASSERT(find_worker_claim(claims, 1, 11, WORKER_CLAIM_QUEUED) == cell_b, "[CLM] Found claim doesn't match control.");
+    }
+    #pragma endregion ======= OFFER =======
+
+    #pragma region ======= TAKE AND STEAL =======
+    {
+        int cell_a = find_worker_claim(claims, 1, 10, WORKER_CLAIM_QUEUED);
+        int cell_b = find_worker_claim(claims, 1, 11, WORKER_CLAIM_QUEUED);
+
+        // Exactly one of the worker and the operator gets each task.
+        ASSERT(take_worker_claim(claims, 1, 10), "[CLM] Unable to take queued claim.");
+        ASSERT(!steal_worker_claim(claims, 1, cell_a, 10), "[CLM] Stole a running task.");
+        ASSERT(!take_worker_claim(claims, 0, 11), "[CLM] Took the claim of another worker.");
+
+        ASSERT(steal_worker_claim(claims, 1, cell_b, 11), "[CLM] Unable to steal queued claim.");
+        ASSERT(!take_worker_claim(claims, 1, 11), "[CLM] Took a stolen claim.");
+        ASSERT(find_worker_claim(claims, 1, 11, WORKER_CLAIM_STOLEN) == cell_b, "[CLM] Stolen claim not found.");
+
+        release_worker_claim(claims, 1, cell_a);
+        release_worker_claim(claims, 1, cell_b);
+        ASSERT(offer_worker_claim(claims, 1, 12) != -1, "[CLM] Released cell was not reused.");
+        release_worker_claim(claims, 1, find_worker_claim(claims, 1, 12, WORKER_CLAIM_QUEUED));
+    }
+    #pragma endregion ======= TAKE AND STEAL =======
+
+    #pragma region ======= SHARED =======
+    {
+        // Claims are shared with forked workers.
+        int cell = offer_worker_claim(claims, 0, 20);
+
+        pid_t pid = fork();
+        if (pid == 0) _exit(take_worker_claim(claims, 0, 20) ? 0 : 1);
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0, "[CLM] Forked worker was unable to take claim.");
+        ASSERT(!steal_worker_claim(claims, 0, cell, 20), "[CLM] Stole a task taken by a forked worker.");
+    }
+    #pragma endregion ======= SHARED =======
+
+    destroy_worker_claims(claims);
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_claims() {
+    test_claims_ownership();
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "server/concurrency.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+void test_concurrency_aimd() {
+    ERROR_HEADER
+
+    ConcurrencyLimit limit = create_concurrency_limit(2, 32);
+    ASSERT(limit != NULL, "[CONC] Unable to create concurrency limit.");
+
+    // Starts at the number of CPUs, within the bounds.
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int start = get_concurrency_limit(limit);
+    ASSERT(
+        start >= 2 && start <= 32 && (num_cpus < 2 || num_cpus > 32 || start == num_cpus), 
+        "[CONC] Limit doesn't start at the number of CPUs."
+    );
+
+    #pragma region ======= ADDITIVE INCREASE =======
+    {
+        limit->limit = 4;
+
+        // Only grows when tasks waited on it.
+        concurrency_update(limit, 0.5, 0.0);
+        ASSERT(get_concurrency_limit(limit) == 4, "[CONC] Limit grew without tasks waiting on it.");
+
+        // Before any task completed, tasks are assumed to use a whole CPU.
+        concurrency_mark_limited(limit);
+        concurrency_update(limit, 0.5, 0.0);
+        ASSERT(get_concurrency_limit(limit) == 5, "[CONC] Limit didn't grow by a single task.");
+
+        // Tasks that use a quarter of a CPU grow it by four tasks.
+        concurrency_observe_task(limit, 250, 1000);
+        concurrency_mark_limited(limit);
+        concurrency_update(limit, 0.5, 0.0);
+        ASSERT(get_concurrency_limit(limit) == 9, "[CONC] Limit didn't grow by a CPU worth of tasks.");
+
+        // Tasks that barely use the CPU grow it by a bounded amount.
+        for (int i = 0; i < 50; i++) concurrency_observe_task(limit, 0, 1000);
+        concurrency_mark_limited(limit);
+        concurrency_update(limit, 0.5, 0.0);
+        ASSERT(
+            get_concurrency_limit(limit) == 9 + CONCURRENCY_MAX_INCREASE, 
+            "[CONC] Limit grew past the largest increase."
+        );
+    }
+    #pragma endregion ======= ADDITIVE INCREASE =======
+
+    #pragma region ======= MULTIPLICATIVE DECREASE =======
+    {
+        // Congested by pressure, however busy the CPUs are.
+        concurrency_mark_limited(limit);
+        concurrency_update(limit, 0.2, 0.5);
+        ASSERT(
+            get_concurrency_limit(limit) == (int)((9 + CONCURRENCY_MAX_INCREASE) * CONCURRENCY_DECREASE), 
+            "[CONC] Limit wasn't cut under pressure."
+        );
+
+        // Without pressure stall information, busy CPUs are congested.
+        limit->limit = 8;
+        concurrency_update(limit, 0.99, -1);
+        ASSERT(get_concurrency_limit(limit) == 4, "[CONC] Limit wasn't cut with busy CPUs.");
+
+        // Never below the lowest bound, nor above the highest.
+        for (int i = 0; i < 10; i++) concurrency_update(limit, 0.99, 1.0);
+        ASSERT(get_concurrency_limit(limit) == 2, "[CONC] Limit was cut past its lowest bound.");
+
+        for (int i = 0; i < 20; i++) {
+            concurrency_mark_limited(limit);
+            concurrency_update(limit, 0.1, 0.0);
+        }
+        ASSERT(get_concurrency_limit(limit) == 32, "[CONC] Limit grew past its highest bound.");
+    }
+    #pragma endregion ======= MULTIPLICATIVE DECREASE =======
+
+    #pragma region ======= ADJUSTMENT =======
+    {
+        // The first sample only sets the baseline, and adjustments wait for the interval.
+        ASSERT(concurrency_adjust(limit, 100000) == CONCURRENCY_INTERVAL, "[CONC] First adjustment is not a baseline.");
+        ASSERT(get_concurrency_limit(limit) == 32, "[CONC] Baseline adjusted the limit.");
+        ASSERT(concurrency_adjust(limit, 100400) == CONCURRENCY_INTERVAL - 400, "[CONC] Adjusted before the interval.");
+    }
+    #pragma endregion ======= ADJUSTMENT =======
+
+    destroy_concurrency_limit(limit);
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_concurrency() {
+    test_concurrency_aimd();
+}
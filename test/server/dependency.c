@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "server/dependency.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+/**
+ * @brief Returns whether an array of tasks holds exactly the given tasks, in order.
+ */
+static int _array_matches(GArray* array, int** control, guint len) {
+    if (array->len != len) return 0;
+
+    for (guint i = 0; i < len; i++) {
+        if (g_array_index(array, int*, i) != control[i]) return 0;
+    }
+
+    return 1;
+}
+
+void test_dependency_graph_release() {
+    ERROR_HEADER
+
+    #pragma region ======= RELEASE =======
+    {
+        DependencyGraph graph = create_dependency_graph();
+        ASSERT(graph != NULL, "[DG] Unable to create dependency graph.");
+
+        GArray* released = g_array_new(FALSE, FALSE, sizeof(gpointer));
+        GArray* cancelled = g_array_new(FALSE, FALSE, sizeof(gpointer));
+
+        // A diamond: 2 and 3 depend on 1, and 4 depends on both of them.
+        int tasks[] = { 1, 2, 3, 4 };
+        ASSERT(dependency_graph_add(graph, 1, NULL, 0, &tasks[0]) == DEPENDENCY_READY, "[DG] Root task was held.");
+        ASSERT(dependency_graph_add(graph, 2, (int[]){ 1 }, 1, &tasks[1]) == DEPENDENCY_HELD, "[DG] Child was not held.");
+        ASSERT(dependency_graph_add(graph, 3, (int[]){ 1 }, 1, &tasks[2]) == DEPENDENCY_HELD, "[DG] Child was not held.");
+        ASSERT(
+            dependency_graph_add(graph, 4, (int[]){ 2, 3 }, 2, &tasks[3]) == DEPENDENCY_HELD,
+            "[DG] Grandchild was not held."
+        );
+        ASSERT(graph->held == 3, "[DG] Held tasks don't match control.");
+
+        dependency_graph_complete(graph, 1, 1, released, cancelled);
+        ASSERT(_array_matches(released, (int*[]){ &tasks[1], &tasks[2] }, 2), "[DG] Children were not released.");
+        g_array_set_size(released, 0);
+
+        // The grandchild waits for both of its parents.
+        dependency_graph_complete(graph, 3, 1, released, cancelled);
+        ASSERT(released->len == 0, "[DG] Grandchild was released before every parent completed.");
+        dependency_graph_complete(graph, 2, 1, released, cancelled);
+        ASSERT(_array_matches(released, (int*[]){ &tasks[3] }, 1), "[DG] Grandchild was not released.");
+        ASSERT(graph->held == 0 && cancelled->len == 0, "[DG] Tasks were left held or cancelled.");
+        g_array_set_size(released, 0);
+
+        // Tasks that completed successfully are no longer waited for.
+        ASSERT(dependency_graph_add(graph, 5, (int[]){ 1, 4 }, 2, NULL) == DEPENDENCY_HELD, "[DG] Task was not held.");
+        dependency_graph_complete(graph, 4, 1, released, cancelled);
+        ASSERT(released->len == 1, "[DG] Task depending on a completed task was not released.");
+
+        g_array_free(released, TRUE);
+        g_array_free(cancelled, TRUE);
+        destroy_dependency_graph(graph, NULL);
+    }
+    #pragma endregion ======= RELEASE =======
+
+    #pragma region ======= CANCEL =======
+    {
+        DependencyGraph graph = create_dependency_graph();
+        GArray* released = g_array_new(FALSE, FALSE, sizeof(gpointer));
+        GArray* cancelled = g_array_new(FALSE, FALSE, sizeof(gpointer));
+
+        // A chain: 2 depends on 1, 3 on 2, and 4 on both 3 and 1. Task 5 depends on nothing.
+        int tasks[] = { 1, 2, 3, 4 };
+        dependency_graph_add(graph, 1, NULL, 0, &tasks[0]);
+        dependency_graph_add(graph, 2, (int[]){ 1 }, 1, &tasks[1]);
+        dependency_graph_add(graph, 3, (int[]){ 2 }, 1, &tasks[2]);
+        dependency_graph_add(graph, 4, (int[]){ 3, 1 }, 2, &tasks[3]);
+        ASSERT(dependency_graph_add(graph, 5, NULL, 0, NULL) == DEPENDENCY_READY, "[DG] Unrelated task was held.");
+
+        // Every task depending on the failed one is cancelled in turn, once.
+        dependency_graph_complete(graph, 1, 0, released, cancelled);
+        ASSERT(
+            _array_matches(cancelled, (int*[]){ &tasks[1], &tasks[2], &tasks[3] }, 3),
+            "[DG] Dependent tasks were not cancelled."
+        );
+        ASSERT(released->len == 0 && graph->held == 0, "[DG] Dependent task of a failed task was released.");
+
+        // Later tasks depending on failed, cancelled or unknown tasks are cancelled right away.
+        ASSERT(dependency_graph_add(graph, 6, (int[]){ 1 }, 1, NULL) == DEPENDENCY_CANCELLED, "[DG] Failed parent.");
+        ASSERT(dependency_graph_add(graph, 7, (int[]){ 3 }, 1, NULL) == DEPENDENCY_CANCELLED, "[DG] Cancelled parent.");
+        ASSERT(dependency_graph_add(graph, 8, (int[]){ 8 }, 1, NULL) == DEPENDENCY_CANCELLED, "[DG] Self dependency.");
+        ASSERT(dependency_graph_add(graph, 9, (int[]){ 0 }, 1, NULL) == DEPENDENCY_CANCELLED, "[DG] Unknown parent.");
+        ASSERT(dependency_graph_add(graph, 10, (int[]){ 7 }, 1, NULL) == DEPENDENCY_CANCELLED, "[DG] Cancelled chain.");
+        ASSERT(dependency_graph_add(graph, 11, (int[]){ 5 }, 1, NULL) == DEPENDENCY_HELD, "[DG] Running parent.");
+
+        g_array_free(released, TRUE);
+        g_array_free(cancelled, TRUE);
+        destroy_dependency_graph(graph, NULL);
+    }
+    #pragma endregion ======= CANCEL =======
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_dependency_graph() {
+    test_dependency_graph_release();
+}
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "common/util/string.h"
+#include "server/estimator.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+#define TEST_ESTIMATOR_PATH "/tmp/orchestrator-test-estimates"
+
+#define CONTROL_KEY_STR "grep -c * / | wc -l --files0-from=/"
+
+void test_estimator_learning() {
+    ERROR_HEADER
+
+    #pragma region ======= KEYS =======
+    {
+        const char* command = "/usr/bin/grep -c foo ./file.txt | wc -l --files0-from=/tmp/x";
+        char* key = get_estimator_key(command, strlen(command));
+        ASSERT(key != NULL && STRING_EQUAL(key, CONTROL_KEY_STR), "[EST] Key doesn't match control.");
+        free(key);
+
+        // Commands of the same shape share a key, and the command does not need to be null-terminated.
+        char* key_a = get_estimator_key("sleep 1", 7);
+        char* key_b = get_estimator_key("sleep 25 trailing", 8);
+        ASSERT(
+            key_a != NULL && key_b != NULL && STRING_EQUAL(key_a, key_b) && STRING_EQUAL(key_a, "sleep #"), 
+            "[EST] Commands of the same shape don't share a key."
+        );
+        free(key_a);
+        free(key_b);
+
+        ASSERT(get_estimator_key("  | ", 4) == NULL, "[EST] Empty command has a key.");
+    }
+    #pragma endregion ======= KEYS =======
+
+    #pragma region ======= PREDICTIONS =======
+    {
+        unlink(TEST_ESTIMATOR_PATH);
+        Estimator estimator = create_estimator(TEST_ESTIMATOR_PATH);
+        ASSERT(estimator != NULL, "[EST] Unable to create estimator.");
+
+        uint32_t estimate = 0;
+        ASSERT(!estimator_predict(estimator, "cat a", 5, &estimate), "[EST] Unseen command is trusted.");
+
+        // Trusted only after enough consistent observations.
+        estimator_observe(estimator, "cat a", 5, 200);
+        estimator_observe(estimator, "cat b", 5, 210);
+        ASSERT(!estimator_predict(estimator, "cat c", 5, &estimate), "[EST] Estimate trusted too early.");
+        estimator_observe(estimator, "cat c", 5, 190);
+        ASSERT(estimator_predict(estimator, "cat d", 5, &estimate), "[EST] Consistent estimate is not trusted.");
+        ASSERT(estimate >= 190 && estimate <= 210, "[EST] Estimate doesn't match control.");
+
+        // Inconsistent observations are not trusted.
+        estimator_observe(estimator, "sleep 1", 7, 1000);
+        estimator_observe(estimator, "sleep 9", 7, 9000);
+        estimator_observe(estimator, "sleep 2", 7, 2000);
+        ASSERT(!estimator_predict(estimator, "sleep 3", 7, &estimate), "[EST] Inconsistent estimate is trusted.");
+
+        // The moving average follows a change in the time the tasks take.
+        for (int i = 0; i < 20; i++) estimator_observe(estimator, "cat a", 5, 1000);
+        ASSERT(estimator_predict(estimator, "cat a", 5, &estimate), "[EST] Settled estimate is not trusted.");
+        ASSERT(estimate >= 950 && estimate <= 1000, "[EST] Estimate doesn't follow the observations.");
+
+        #pragma region ======= PERSISTENCE =======
+        ASSERT(save_estimator(estimator) == 0, "[EST] Unable to save estimator.");
+        destroy_estimator(estimator);
+
+        estimator = create_estimator(TEST_ESTIMATOR_PATH);
+        ASSERT(estimator != NULL, "[EST] Unable to load estimator.");
+
+        uint32_t loaded = 0;
+        ASSERT(estimator_predict(estimator, "cat a", 5, &loaded), "[EST] Loaded estimate is not trusted.");
+        ASSERT(loaded == estimate, "[EST] Loaded estimate doesn't match saved estimate.");
+        ASSERT(!estimator_predict(estimator, "sleep 3", 7, &loaded), "[EST] Loaded inconsistent estimate is trusted.");
+
+        destroy_estimator(estimator);
+        unlink(TEST_ESTIMATOR_PATH);
+        #pragma endregion ======= PERSISTENCE =======
+    }
+    #pragma endregion ======= PREDICTIONS =======
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_estimator() {
+    test_estimator_learning();
+}
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "server/fair_queue.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+#define TEST_FAIR_QUEUE_BULK 100
+#define TEST_FAIR_QUEUE_QUANTUM 100
+
+typedef struct test_fair_queue_element {
+    int tenant; // The tenant the element belongs to.
+    int cost;   // The cost of the element, which also orders the elements of a tenant.
+} TEST_FAIR_QUEUE_ELEMENT, *TestFairQueueElement;
+
+static gint _compare_test_elements(gconstpointer a, gconstpointer b, gpointer user_data) {
+    UNUSED(user_data);
+    return ((TestFairQueueElement)a)->cost - ((TestFairQueueElement)b)->cost;
+}
+
+static uint32_t _get_test_element_cost(gconstpointer data) {
+    return ((TestFairQueueElement)data)->cost;
+}
+
+void test_fair_queue_turns() {
+    ERROR_HEADER
+
+    TestFairQueueElement elements = malloc((TEST_FAIR_QUEUE_BULK + 4) * sizeof(TEST_FAIR_QUEUE_ELEMENT));
+
+    #pragma region ======= SINGLE TENANT =======
+    {
+        // Without a quantum, tenants are ignored, and elements leave by the comparator alone.
+        FairQueue queue = create_fair_queue(0, _get_test_element_cost, _compare_test_elements, NULL);
+        ASSERT(queue != NULL, "[FQ] Unable to create fair queue.");
+        ASSERT(fair_queue_pop(queue) == NULL, "[FQ] Empty fair queue returned an element.");
+
+        for (int i = 0; i < 4; i++) {
+            elements[i] = (TEST_FAIR_QUEUE_ELEMENT){ .tenant = i, .cost = 40 - 10 * i };
+            ASSERT(fair_queue_push(queue, elements[i].tenant, &elements[i]) == 0, "[FQ] Unable to push element.");
+        }
+        ASSERT(queue->length == 4 && g_hash_table_size(queue->tenants) == 1, "[FQ] Elements not queued for one tenant.");
+
+        for (int i = 3; i >= 0; i--) {
+            ASSERT(fair_queue_pop(queue) == &elements[i], "[FQ] Single tenant order doesn't match control.");
+        }
+        ASSERT(queue->length == 0 && fair_queue_pop(queue) == NULL, "[FQ] Fair queue is not empty.");
+
+        destroy_fair_queue(queue);
+    }
+    #pragma endregion ======= SINGLE TENANT =======
+
+    #pragma region ======= TURNS =======
+    {
+        FairQueue queue = create_fair_queue(
+            TEST_FAIR_QUEUE_QUANTUM, 
+            _get_test_element_cost, 
+            _compare_test_elements, 
+            NULL
+        );
+        ASSERT(queue != NULL, "[FQ] Unable to create fair queue.");
+
+        // A bulk tenant queues everything first, then an interactive tenant queues a few cheaper elements.
+        for (int i = 0; i < TEST_FAIR_QUEUE_BULK; i++) {
+            elements[i] = (TEST_FAIR_QUEUE_ELEMENT){ .tenant = 1, .cost = 50 };
+            fair_queue_push(queue, 1, &elements[i]);
+        }
+        for (int i = TEST_FAIR_QUEUE_BULK; i < TEST_FAIR_QUEUE_BULK + 4; i++) {
+            elements[i] = (TEST_FAIR_QUEUE_ELEMENT){ .tenant = 2, .cost = 25 };
+            fair_queue_push(queue, 2, &elements[i]);
+        }
+        ASSERT(g_hash_table_size(queue->tenants) == 2, "[FQ] Tenants don't match control.");
+
+        // Each turn is worth 2 bulk elements or 4 interactive elements.
+        int control[] = { 1, 1, 2, 2, 2, 2, 1, 1, 1, 1 };
+        for (size_t i = 0; i < sizeof(control) / sizeof(control[0]); i++) {
+            TestFairQueueElement popped = fair_queue_pop(queue);
+            ASSERT(popped != NULL && popped->tenant == control[i], "[FQ] Turns don't match control.");
+        }
+
+        // The interactive tenant is forgotten as soon as it has nothing queued.
+        ASSERT(g_hash_table_size(queue->tenants) == 1, "[FQ] Idle tenant was not forgotten.");
+
+        int left = 0;
+        while (fair_queue_pop(queue) != NULL) left++;
+        ASSERT(left == TEST_FAIR_QUEUE_BULK - 6, "[FQ] Fair queue lost elements.");
+        ASSERT(queue->length == 0 && g_hash_table_size(queue->tenants) == 0, "[FQ] Fair queue is not empty.");
+
+        destroy_fair_queue(queue);
+    }
+    #pragma endregion ======= TURNS =======
+
+    #pragma region ======= COSTLY ELEMENTS =======
+    {
+        // Elements that cost more than a quantum are still dispatched, after enough turns.
+        FairQueue queue = create_fair_queue(
+            TEST_FAIR_QUEUE_QUANTUM, 
+            _get_test_element_cost, 
+            _compare_test_elements, 
+            NULL
+        );
+
+        elements[0] = (TEST_FAIR_QUEUE_ELEMENT){ .tenant = 1, .cost = 250 };
+        elements[1] = (TEST_FAIR_QUEUE_ELEMENT){ .tenant = 2, .cost = 100 };
+        elements[2] = (TEST_FAIR_QUEUE_ELEMENT){ .tenant = 2, .cost = 100 };
+        elements[3] = (TEST_FAIR_QUEUE_ELEMENT){ .tenant = 2, .cost = 100 };
+        for (int i = 0; i < 4; i++) fair_queue_push(queue, elements[i].tenant, &elements[i]);
+
+        ASSERT(fair_queue_pop(queue) == &elements[1], "[FQ] Costly element order doesn't match control.");
+        ASSERT(fair_queue_pop(queue) == &elements[2], "[FQ] Costly element order doesn't match control.");
+        ASSERT(fair_queue_pop(queue) == &elements[0], "[FQ] Costly element order doesn't match control.");
+        ASSERT(fair_queue_pop(queue) == &elements[3], "[FQ] Costly element order doesn't match control.");
+
+        destroy_fair_queue(queue);
+    }
+    #pragma endregion ======= COSTLY ELEMENTS =======
+
+    free(elements);
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_fair_queue() {
+    test_fair_queue_turns();
+}
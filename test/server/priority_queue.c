@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "server/priority_queue.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+#define TEST_PRIORITY_QUEUE_SIZE 1000
+
+typedef struct test_priority_queue_element {
+    int priority; // The key the elements are ordered by.
+    int order;    // The order the element was inserted in.
+} TEST_PRIORITY_QUEUE_ELEMENT, *TestPriorityQueueElement;
+
+static gint _compare_test_elements(gconstpointer a, gconstpointer b, gpointer user_data) {
+    UNUSED(user_data);
+    return ((TestPriorityQueueElement)a)->priority - ((TestPriorityQueueElement)b)->priority;
+}
+
+void test_priority_queue_order() {
+    ERROR_HEADER
+
+    PriorityQueue queue = create_priority_queue(_compare_test_elements, NULL);
+    ASSERT(queue != NULL, "[PQ] Unable to create priority queue.");
+
+    TestPriorityQueueElement elements = malloc(TEST_PRIORITY_QUEUE_SIZE * sizeof(TEST_PRIORITY_QUEUE_ELEMENT));
+
+    #pragma region ======= EMPTY =======
+    {
+        ASSERT(
+            priority_queue_peek(queue) == NULL && priority_queue_pop(queue) == NULL, 
+            "[PQ] Empty priority queue returned an element."
+        );
+    }
+    #pragma endregion ======= EMPTY =======
+
+    #pragma region ======= ORDER =======
+    {
+        // Few distinct priorities, so that most elements tie, and enough elements to grow the queue several times.
+        srand(1234);
+        for (int i = 0; i < TEST_PRIORITY_QUEUE_SIZE; i++) {
+            elements[i].priority = rand() % 10;
+            elements[i].order = i;
+            ASSERT(priority_queue_push(queue, &elements[i]) == 0, "[PQ] Unable to push element.");
+        }
+        ASSERT(queue->length == TEST_PRIORITY_QUEUE_SIZE, "[PQ] Priority queue length doesn't match control.");
+
+        TestPriorityQueueElement prev = NULL;
+        for (int i = 0; i < TEST_PRIORITY_QUEUE_SIZE; i++) {
+            TestPriorityQueueElement peeked = priority_queue_peek(queue);
+            TestPriorityQueueElement popped = priority_queue_pop(queue);
+            ASSERT(popped != NULL && peeked == popped, "[PQ] Peeked element doesn't match popped element.");
+
+            if (prev != NULL) {
+                ASSERT(prev->priority <= popped->priority, "[PQ] Elements left out of priority order.");
+                ASSERT(
+                    prev->priority != popped->priority || prev->order < popped->order, 
+                    "[PQ] Tied elements left out of insertion order."
+                );
+            }
+            prev = popped;
+        }
+        ASSERT(queue->length == 0 && priority_queue_pop(queue) == NULL, "[PQ] Priority queue is not empty.");
+    }
+    #pragma endregion ======= ORDER =======
+
+    #pragma region ======= INTERLEAVED =======
+    {
+        // Pops in between pushes still leave the earliest element first.
+        for (int i = 0; i < 3; i++) {
+            elements[i].priority = 5 - i;
+            priority_queue_push(queue, &elements[i]);
+        }
+        ASSERT(((TestPriorityQueueElement)priority_queue_pop(queue))->priority == 3, "[PQ] Interleaved pop doesn't match control.");
+
+        elements[3].priority = 1;
+        priority_queue_push(queue, &elements[3]);
+        ASSERT(((TestPriorityQueueElement)priority_queue_pop(queue))->priority == 1, "[PQ] Interleaved pop doesn't match control.");
+        ASSERT(((TestPriorityQueueElement)priority_queue_pop(queue))->priority == 4, "[PQ] Interleaved pop doesn't match control.");
+        ASSERT(((TestPriorityQueueElement)priority_queue_pop(queue))->priority == 5, "[PQ] Interleaved pop doesn't match control.");
+    }
+    #pragma endregion ======= INTERLEAVED =======
+
+    free(elements);
+    destroy_priority_queue(queue);
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_priority_queue() {
+    test_priority_queue_order();
+}
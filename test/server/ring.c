@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "server/ring.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+/**
+ * @brief Fills a message with a pattern that depends on its sequence number, so that it can be verified on read.
+ */
+static void _fill_ring_message(uint8_t* buf, size_t len, int seq) {
+    for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)(seq * 31 + i);
+}
+
+static int _check_ring_message(uint8_t* buf, size_t len, int seq) {
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != (uint8_t)(seq * 31 + i)) return 0;
+    }
+
+    return 1;
+}
+
+void test_ring_write_read() {
+    ERROR_HEADER
+
+    Ring ring = create_ring();
+    ASSERT(ring != NULL, "[RING] Unable to create ring.");
+
+    uint8_t* in = malloc(RING_MAX_MESSAGE_SIZE);
+    uint8_t* out = malloc(RING_MAX_MESSAGE_SIZE);
+    uint16_t type = RING_MESSAGE_NONE;
+
+    #pragma region ======= EMPTY =======
+    {
+        ASSERT(ring_read(ring, &type, out) == -1, "[RING] Empty ring returned a message.");
+    }
+    #pragma endregion ======= EMPTY =======
+
+    #pragma region ======= GATHER =======
+    {
+        char header[] = "head";
+        int id = 123;
+        struct iovec iov[] = {
+            { .iov_base = header, .iov_len = sizeof(header) },
+            { .iov_base = &id, .iov_len = sizeof(int) }
+        };
+
+        ASSERT(ring_write(ring, RING_MESSAGE_SERVER, iov, 2) == 0, "[RING] Unable to write gathered message.");
+        ASSERT(
+            ring_read(ring, &type, out) == sizeof(header) + sizeof(int), 
+            "[RING] Gathered message length doesn't match control."
+        );
+        ASSERT(type == RING_MESSAGE_SERVER, "[RING] Gathered message type doesn't match control.");
+        ASSERT(
+            memcmp(out, header, sizeof(header)) == 0 && memcmp(out + sizeof(header), &id, sizeof(int)) == 0, 
+            "[RING] Gathered message doesn't match control."
+        );
+    }
+    #pragma endregion ======= GATHER =======
+
+    #pragma region ======= MULTI SLOT / WRAP =======
+    {
+        // Write and read more slots than the ring holds, with messages spanning several slots, so that messages are
+        // split across the end of the ring.
+        int written = 0;
+        int read = 0;
+        size_t slots = 0;
+        while (slots < RING_NUM_SLOTS * 3) {
+            for (int i = 0; i < 4; i++, written++) {
+                size_t len = (written * 173) % (RING_SLOT_SIZE * 5);
+                _fill_ring_message(in, len, written);
+
+                struct iovec iov = { .iov_base = in, .iov_len = len };
+                ASSERT(ring_write(ring, RING_MESSAGE_WORKER, &iov, 1) == 0, "[RING] Unable to write message.");
+                slots += len / RING_SLOT_SIZE + 1;
+            }
+
+            ssize_t len;
+            while ((len = ring_read(ring, &type, out)) != -1) {
+                ASSERT(type == RING_MESSAGE_WORKER, "[RING] Message type doesn't match control.");
+                ASSERT(
+                    len == (read * 173) % (RING_SLOT_SIZE * 5), 
+                    "[RING] Message length doesn't match control."
+                );
+                ASSERT(_check_ring_message(out, len, read), "[RING] Message doesn't match control.");
+                read++;
+            }
+        }
+
+        ASSERT(read == written, "[RING] Not every message written was read.");
+    }
+    #pragma endregion ======= MULTI SLOT / WRAP =======
+
+    #pragma region ======= TOO LARGE =======
+    {
+        struct iovec iov = { .iov_base = in, .iov_len = RING_MAX_MESSAGE_SIZE + 1 };
+        ASSERT(ring_write(ring, RING_MESSAGE_WORKER, &iov, 1) == 1, "[RING] Message too large was accepted.");
+    }
+    #pragma endregion ======= TOO LARGE =======
+
+    free(in);
+    free(out);
+    destroy_ring(ring);
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_ring() {
+    test_ring_write_read();
+}
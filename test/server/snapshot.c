@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "common/util/string.h"
+#include "server/snapshot.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+#define CONTROL_SNAPSHOT_STR \
+    "Scheduled tasks (2):\n" \
+    "2 echo two\n" \
+    "3 echo three\n" \
+    "\n" \
+    "Executing tasks (1):\n" \
+    "1 echo one\n" \
+    "\n" \
+    "Completed tasks (0):\n" \
+    "\n" \
+    "Wait times (fifo, 0 tasks): p50 0ms, p90 0ms, p99 0ms, max 0ms\n" \
+    "\n" \
+    "Workers (0 of 0-0): 0 started, 0 retired\n"
+
+#define CONTROL_SNAPSHOT_FILTERED_STR \
+    "Executing tasks (1):\n" \
+    "4 echo four\n" \
+    "\n" \
+    "Completed tasks (3):\n" \
+    "2 echo two 1ms\n"
+
+#define CONTROL_SNAPSHOT_COMPLETED_STR \
+    "Scheduled tasks (1):\n" \
+    "3 echo three\n" \
+    "\n" \
+    "Executing tasks (1):\n" \
+    "2 echo two\n" \
+    "\n" \
+    "Completed tasks (1):\n" \
+    "1 echo one 42ms\n" \
+    "\n" \
+    "Wait times (fifo, 0 tasks): p50 0ms, p90 0ms, p99 0ms, max 0ms\n" \
+    "\n" \
+    "Workers (0 of 0-0): 0 started, 0 retired\n"
+
+void test_snapshot_updates() {
+    ERROR_HEADER
+
+    Snapshot snapshot = create_snapshot("fifo");
+    ASSERT(snapshot != NULL, "[SNAP] Unable to create snapshot.");
+
+    SnapshotShared copy = malloc(sizeof(SNAPSHOT_SHARED));
+    size_t len = 0;
+
+    #pragma region ======= QUEUE / DISPATCH / COMPLETE =======
+    {
+        int one = snapshot_enqueue(snapshot, 1, "echo one", 8);
+        int two = snapshot_enqueue(snapshot, 2, "echo two", 8);
+        int three = snapshot_enqueue(snapshot, 3, "echo three and then some", 10);
+        ASSERT(one != -1 && two != -1 && three != -1, "[SNAP] Unable to list queued tasks.");
+
+        int running_one = snapshot_dispatch(snapshot, one, 1, "echo one", 8);
+
+        read_snapshot(snapshot, copy);
+        ASSERT(copy->sequence % 2 == 0, "[SNAP] Snapshot was read mid-update.");
+
+        char* str = snapshot_to_string(copy, 0, 0, &len);
+        ASSERT(
+            STRING_EQUAL(str, CONTROL_SNAPSHOT_STR) && len == strlen(str),
+            "[SNAP] [TOSTRING] Snapshot doesn't match control."
+        );
+        free(str);
+
+        snapshot_complete(snapshot, running_one, 1, "echo one", 8, 42);
+        int running_two = snapshot_dispatch(snapshot, two, 2, "echo two", 8);
+
+        read_snapshot(snapshot, copy);
+        str = snapshot_to_string(copy, 0, 0, &len);
+        ASSERT(
+            STRING_EQUAL(str, CONTROL_SNAPSHOT_COMPLETED_STR),
+            "[SNAP] [TOSTRING] Snapshot after completion doesn't match control."
+        );
+        free(str);
+
+        int running_three = snapshot_dispatch(snapshot, three, 3, "echo three", 10);
+        snapshot_complete(snapshot, running_three, 3, "echo three", 10, 1);
+        snapshot_complete(snapshot, running_two, 2, "echo two", 8, 1);
+        int four = snapshot_enqueue(snapshot, 4, "echo four", 9);
+        int running_four = snapshot_dispatch(snapshot, four, 4, "echo four", 9);
+
+        // Only the requested sections, and only the most recent completed tasks, are included.
+        read_snapshot(snapshot, copy);
+        str = snapshot_to_string(copy, STATUS_SECTION_RUNNING | STATUS_SECTION_COMPLETED, 1, &len);
+        ASSERT(
+            STRING_EQUAL(str, CONTROL_SNAPSHOT_FILTERED_STR),
+            "[SNAP] [TOSTRING] Filtered snapshot doesn't match control."
+        );
+        free(str);
+        snapshot_complete(snapshot, running_four, 4, "echo four", 9, 1);
+    }
+    #pragma endregion ======= QUEUE / DISPATCH / COMPLETE =======
+
+    #pragma region ======= OVERFLOW =======
+    {
+        // Tasks past the listed ones are only counted, and listed entries are reused once dispatched.
+        int entries[SNAPSHOT_MAX_QUEUED + 1];
+        for (int i = 0; i <= SNAPSHOT_MAX_QUEUED; i++) {
+            entries[i] = snapshot_enqueue(snapshot, 100 + i, "true", 4);
+        }
+        ASSERT(entries[SNAPSHOT_MAX_QUEUED] == -1, "[SNAP] Task listed past the queued section.");
+
+        read_snapshot(snapshot, copy);
+        ASSERT(copy->num_queued == SNAPSHOT_MAX_QUEUED + 1, "[SNAP] Unlisted task was not counted.");
+
+        snapshot_dispatch(snapshot, entries[0], 100, "true", 4);
+        ASSERT(snapshot_enqueue(snapshot, 1000, "true", 4) == entries[0], "[SNAP] Dispatched entry was not reused.");
+
+        read_snapshot(snapshot, copy);
+        ASSERT(
+            copy->num_queued == SNAPSHOT_MAX_QUEUED + 1 && copy->num_running == 1 && copy->num_completed == 4,
+            "[SNAP] Snapshot counts don't match control."
+        );
+    }
+    #pragma endregion ======= OVERFLOW =======
+
+    #pragma region ======= RUNNING OVERFLOW =======
+    {
+        // Running tasks past the listed ones are only counted too, but are still listed once completed.
+        int running[SNAPSHOT_MAX_RUNNING];
+        for (int i = 0; i < SNAPSHOT_MAX_RUNNING; i++) {
+            running[i] = snapshot_dispatch(snapshot, -1, 200 + i, "true", 4);
+        }
+        ASSERT(running[SNAPSHOT_MAX_RUNNING - 1] == -1, "[SNAP] Task listed past the running section.");
+
+        read_snapshot(snapshot, copy);
+        char* str = snapshot_to_string(copy, STATUS_SECTION_RUNNING, 0, &len);
+        ASSERT(
+            copy->num_running == SNAPSHOT_MAX_RUNNING + 1 && strstr(str, "... and 1 more.\n") != NULL,
+            "[SNAP] Unlisted running task was not counted."
+        );
+        free(str);
+
+        snapshot_complete(snapshot, -1, 200 + SNAPSHOT_MAX_RUNNING - 1, "true", 4, 7);
+        snapshot_complete(snapshot, running[0], 200, "true", 4, 1);
+        ASSERT(snapshot_dispatch(snapshot, -1, 300, "true", 4) == running[0], "[SNAP] Completed entry was not reused.");
+
+        read_snapshot(snapshot, copy);
+        str = snapshot_to_string(copy, STATUS_SECTION_COMPLETED, 2, &len);
+        ASSERT(
+            strstr(str, "263 true 7ms\n200 true 1ms\n") != NULL,
+            "[SNAP] Unlisted running task was not listed once completed."
+        );
+        free(str);
+    }
+    #pragma endregion ======= RUNNING OVERFLOW =======
+
+    #pragma region ======= WAIT TIMES =======
+    {
+        // 90 short waits and 10 long ones, so that p50 and p90 land in the short ones and p99 in the long ones.
+        for (int i = 0; i < 90; i++) snapshot_record_wait(snapshot, 3);
+        for (int i = 0; i < 10; i++) snapshot_record_wait(snapshot, 1000);
+
+        read_snapshot(snapshot, copy);
+        ASSERT(copy->num_waits == 100 && copy->max_wait == 1000, "[SNAP] [WAIT] Wait counts don't match control.");
+        ASSERT(
+            get_snapshot_wait_percentile(copy, 50) == 3 && get_snapshot_wait_percentile(copy, 90) == 3,
+            "[SNAP] [WAIT] Short wait percentiles don't match control."
+        );
+
+        // Long waits are bucketed, so their percentile is only an upper bound, never past the longest wait.
+        uint32_t p99 = get_snapshot_wait_percentile(copy, 99);
+        ASSERT(p99 >= 1000 * 3 / 4 && p99 <= 1000, "[SNAP] [WAIT] Long wait percentile is out of bounds.");
+
+        char* str = snapshot_to_string(copy, STATUS_SECTION_WAIT_TIMES, 0, &len);
+        ASSERT(
+            STRING_BEGIN_EQUAL(str, "Wait times (fifo, 100 tasks): p50 3ms, p90 3ms, p99 ", 52),
+            "[SNAP] [TOSTRING] Wait times don't match control."
+        );
+        free(str);
+    }
+    #pragma endregion ======= WAIT TIMES =======
+
+    #pragma region ======= WORKER POOL =======
+    {
+        // Growing and shrinking the pool is counted from the change in its size.
+        snapshot_set_pool(snapshot, 2, 2, 4);
+        snapshot_set_pool(snapshot, 4, 2, 4);
+        snapshot_set_pool(snapshot, 3, 2, 4);
+
+        read_snapshot(snapshot, copy);
+        char* str = snapshot_to_string(copy, STATUS_SECTION_WORKERS, 0, &len);
+        ASSERT(
+            STRING_EQUAL(str, "Workers (3 of 2-4): 4 started, 1 retired\n"),
+            "[SNAP] [TOSTRING] Worker pool doesn't match control."
+        );
+        free(str);
+    }
+    #pragma endregion ======= WORKER POOL =======
+
+    free(copy);
+    destroy_snapshot(snapshot);
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_snapshot() {
+    test_snapshot_updates();
+}
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test/test.h"
+#include "common/error.h"
+#include "server/topology.h"
+
+#define ERROR_FOOTER TEST_ERROR_LABEL
+
+/**
+ * @brief Two sockets of two cores of two hyperthreads each, numbered like Linux does, so that the hyperthreads of a
+ * core are far apart.
+ */
+static void fill_dual_socket_topology(CpuTopologyEntry cpus) {
+    for (int cpu = 0; cpu < 8; cpu++) {
+        int package = (cpu % 4) / 2;
+        cpus[cpu] = (CPU_TOPOLOGY_ENTRY){ .cpu = cpu, .package = package, .cache = package * 2, .core = cpu % 2 };
+    }
+}
+
+/**
+ * @brief Checks whether a list holds exactly the given CPUs, in order.
+ */
+static int is_cpu_list(CpuList list, int len, const int* cpus) {
+    return list->len == len && memcmp(list->cpus, cpus, len * sizeof(int)) == 0;
+}
+
+void test_topology_placement() {
+    ERROR_HEADER
+
+    CPU_TOPOLOGY_ENTRY cpus[8];
+
+    #pragma region ======= ONE CORE SET PER WORKER =======
+    {
+        fill_dual_socket_topology(cpus);
+        CpuPlacement placement = plan_cpu_placement(cpus, 8, 3);
+        ASSERT(placement != NULL, "[TOPO] Unable to place workers.");
+
+        ASSERT(is_cpu_list(&placement->housekeeping, 2, (int[]){ 0, 4 }), "[TOPO] Housekeeping is not the first core.");
+        ASSERT(is_cpu_list(&placement->workers[0], 2, (int[]){ 1, 5 }), "[TOPO] Worker 0 is not on its own core.");
+        ASSERT(is_cpu_list(&placement->workers[1], 2, (int[]){ 2, 6 }), "[TOPO] Worker 1 is not on its own core.");
+        ASSERT(is_cpu_list(&placement->workers[2], 2, (int[]){ 3, 7 }), "[TOPO] Worker 2 is not on its own core.");
+
+        // Stages of a pipeline are spread over the CPUs of their worker, while there are enough of them.
+        ASSERT(
+            get_pipeline_stage_cpu(&placement->workers[0], 1, 2) == 5 
+            && get_pipeline_stage_cpu(&placement->workers[0], 1, 3) == -1 
+            && get_pipeline_stage_cpu(&placement->workers[0], 0, 1) == -1, 
+            "[TOPO] Pipeline stages don't match control."
+        );
+
+        destroy_cpu_placement(placement);
+    }
+    #pragma endregion ======= ONE CORE SET PER WORKER =======
+
+    #pragma region ======= SHARED CORES =======
+    {
+        // A single worker gets every core but housekeeping, ordered by socket.
+        fill_dual_socket_topology(cpus);
+        CpuPlacement placement = plan_cpu_placement(cpus, 8, 1);
+        ASSERT(placement != NULL, "[TOPO] Unable to place a single worker.");
+        ASSERT(
+            is_cpu_list(&placement->workers[0], 6, (int[]){ 1, 5, 2, 6, 3, 7 }), 
+            "[TOPO] Single worker doesn't get every other core."
+        );
+        destroy_cpu_placement(placement);
+
+        // More workers than cores share them with their neighbours.
+        fill_dual_socket_topology(cpus);
+        placement = plan_cpu_placement(cpus, 8, 6);
+        ASSERT(placement != NULL, "[TOPO] Unable to place more workers than cores.");
+        ASSERT(
+            is_cpu_list(&placement->workers[0], 2, (int[]){ 1, 5 }) 
+            && is_cpu_list(&placement->workers[1], 2, (int[]){ 1, 5 }) 
+            && is_cpu_list(&placement->workers[5], 2, (int[]){ 3, 7 }), 
+            "[TOPO] Shared cores don't match control."
+        );
+        destroy_cpu_placement(placement);
+
+        // A single core is shared by the operator and every worker.
+        CPU_TOPOLOGY_ENTRY core[2] = { { .cpu = 1, .core = 0 }, { .cpu = 0, .core = 0 } };
+        placement = plan_cpu_placement(core, 2, 2);
+        ASSERT(placement != NULL, "[TOPO] Unable to place workers on a single core.");
+        ASSERT(
+            is_cpu_list(&placement->housekeeping, 2, (int[]){ 0, 1 }) 
+            && is_cpu_list(&placement->workers[1], 2, (int[]){ 0, 1 }), 
+            "[TOPO] Single core is not shared."
+        );
+        destroy_cpu_placement(placement);
+    }
+    #pragma endregion ======= SHARED CORES =======
+
+    return;
+    ERROR_FOOTER
+}
+
+void test_topology() {
+    test_topology_placement();
+}
@@ -9,7 +9,6 @@
 #define ERROR_FOOTER TEST_ERROR_LABEL
 
 #define HEADER_FILE "test_worker_datagram_header.dat"
-#define STATUS_FILE "test_worker_status_datagram.dat"
 #define EXECUTE_FILE "test_worker_execute_datagram.dat"
 #define SHUTDOWN_FILE "test_worker_shutdown_datagram.dat"
 
@@ -20,12 +19,11 @@ int _cmp_worker_datagram_header(WORKER_DATAGRAM_HEADER dha, WORKER_DATAGRAM_HEAD
         && (dha.task_id == dhb.task_id);
 }
 
-int _cmp_worker_status_datagram(WorkerStatusRequestDatagram dga, WorkerStatusRequestDatagram dgb) {
-    return _cmp_worker_datagram_header(dga->header, dgb->header);
-}
-
 int _cmp_worker_execute_datagram(WorkerExecuteRequestDatagram dga, WorkerExecuteRequestDatagram dgb) {
-    return _cmp_worker_datagram_header(dga->header, dgb->header);
+    return _cmp_worker_datagram_header(dga->header, dgb->header)
+        && (dga->data_len == dgb->data_len)
+        && (dga->timeout == dgb->timeout)
+        && (memcmp(dga->data, dgb->data, dga->data_len) == 0);
 }
 
 int _cmp_worker_shutdown_datagram(WorkerShutdownRequestDatagram dga, WorkerShutdownRequestDatagram dgb) {
@@ -46,20 +44,6 @@ void test_direct_create_worker_datagram() {
     }
     #pragma endregion ======= WORKER DATAGRAM HEADER =======
 
-    #pragma region ========== WORKER STATUS DATAGRAM =======
-    {
-        // WORKER_STATUS_REQUEST_DATAGRAM dgc = { 0 };
-        // dgc.header = create_worker_datagram_header();
-        // dgc.header.mode = WORKER_DATAGRAM_MODE_STATUS_REQUEST;
-
-        // WorkerStatusRequestDatagram dg = create_worker_status_request_datagram();
-        // ASSERT(
-        //     _cmp_worker_status_datagram(&dgc, dg),
-        //     "[WDH] Worker Status Datagram doesn't match control."
-        // );
-    }
-    #pragma endregion ======= WORKER DATAGRAM HEADER =======
-
     #pragma region ========== WORKER EXECUTE DATAGRAM =======
     {
         WORKER_EXECUTE_REQUEST_DATAGRAM dgc = {
@@ -67,11 +51,12 @@ void test_direct_create_worker_datagram() {
         };
         dgc.header.mode = WORKER_DATAGRAM_MODE_EXECUTE_REQUEST;
 
-        WorkerExecuteRequestDatagram dg = create_worker_execute_request_datagram();
+        WorkerExecuteRequestDatagram dg = create_worker_execute_request_datagram("", 0);
         ASSERT(
             _cmp_worker_execute_datagram(&dgc, dg),
             "[WDH] Worker Execute Datagram doesn't match control."
         );
+        free(dg);
     }
     #pragma endregion ======= WORKER EXECUTE DATAGRAM =======
 
@@ -116,50 +101,50 @@ void test_read_worker_datagram(char* test_data_dir) {
     }
     #pragma endregion ======= WORKER DATAGRAM HEADER =======
 
-    #pragma region ======= WORKER STATUS DATAGRAM =======
-    {
-        char* test_status_file = join_paths(2, test_data_dir, STATUS_FILE);
-        int status_fd = SAFE_OPEN(test_status_file, O_RDONLY, NULL);
-        if (status_fd == -1) ERROR("[READ] Unable to open Worker Status Datagram test data file.")
-
-        WORKER_STATUS_REQUEST_DATAGRAM dgc = {
-            .header = {
-                .mode = 1,
-                .type = 2,
-                .task_id = 123
-            }
-        };
-
-        WORKER_DATAGRAM_HEADER dh = read_worker_datagram_header(status_fd);
-        WorkerStatusRequestDatagram dg = read_partial_worker_status_request_datagram(status_fd, dh);
-        ASSERT(
-            _cmp_worker_status_datagram(&dgc, dg),
-            "[READ] [WDH] Worker Status Datagram doesn't match control."
-        );
-    }
-    #pragma endregion ======= WORKER STATUS DATAGRAM =======
-
     #pragma region ======= WORKER EXECUTE DATAGRAM =======
     {
         char* test_execute_file = join_paths(2, test_data_dir, EXECUTE_FILE);
         int execute_fd = SAFE_OPEN(test_execute_file, O_RDONLY, NULL);
         if (execute_fd == -1) ERROR("[READ] Unable to open Worker Execute Datagram test data file.")
 
-        WORKER_EXECUTE_REQUEST_DATAGRAM dgc = {
-            .header = {
-                .mode = 1,
-                .type = 2,
-                .task_id = 123
-            },
-            .data = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Nam id augue efficitur, varius turpis porttitor, hendrerit arcu. Phasellus elementum, orci quis molestie suscipit, ante velit auctor nisl, id mattis metus lacus semper libero. Sed semper purus at lacus congue, at dictum augue luctus efficitur."
-        };
+        char* control_data = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Nam id augue efficitur, varius turpis porttitor, hendrerit arcu. Phasellus elementum, orci quis molestie suscipit, ante velit auctor nisl, id mattis metus lacus semper libero. Sed semper purus at lacus congue, at dictum augue luctus efficitur.";
+        WorkerExecuteRequestDatagram dgc = create_worker_execute_request_datagram(control_data, strlen(control_data));
+        dgc->header.mode = 1;
+        dgc->header.type = 2;
+        dgc->header.task_id = 123;
+        dgc->timeout = 5000;
 
         WORKER_DATAGRAM_HEADER dh = read_worker_datagram_header(execute_fd);
         WorkerExecuteRequestDatagram dg = read_partial_worker_execute_request_datagram(execute_fd, dh);
         ASSERT(
-            _cmp_worker_execute_datagram(&dgc, dg),
+            dg != NULL && _cmp_worker_execute_datagram(dgc, dg),
             "[READ] [WDH] Worker Execute Datagram doesn't match control."
         );
+        free(dg);
+
+        // Unpack the same datagram from a single read of the whole frame, as the worker does.
+        uint8_t frame[WORKER_EXECUTE_REQUEST_DATAGRAM_SIZE(dgc) + 1];
+        lseek(execute_fd, 0, SEEK_SET);
+        ssize_t frame_len = read(execute_fd, frame, sizeof(frame));
+        ASSERT(
+            frame_len == (ssize_t)WORKER_EXECUTE_REQUEST_DATAGRAM_SIZE(dgc)
+                && get_worker_datagram_size(frame, frame_len) == frame_len
+                && get_worker_datagram_size(frame, sizeof(WORKER_DATAGRAM_HEADER) - 1) == 0,
+            "[FRAME] [WDH] Worker Execute Datagram frame size doesn't match its header."
+        );
+
+        dg = unpack_worker_execute_request_datagram(frame, frame_len);
+        ASSERT(
+            dg != NULL && _cmp_worker_execute_datagram(dgc, dg) && dg->data[dg->data_len] == '\0',
+            "[FRAME] [WDH] Worker Execute Datagram unpacked from frame doesn't match control."
+        );
+        ASSERT(
+            unpack_worker_execute_request_datagram(frame, frame_len - 1) == NULL,
+            "[FRAME] [WDH] Truncated Worker Execute Datagram frame was unpacked."
+        );
+        free(dgc);
+        free(dg);
+        close(execute_fd);
     }
     #pragma endregion ======= WORKER EXECUTE DATAGRAM =======
 